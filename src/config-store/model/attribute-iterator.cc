@@ -91,6 +91,10 @@ AttributeIterator::GetCurrentPath (void) const
   return oss.str ();
 }
 
+void 
+AttributeIterator::DoVisitSkippedAttribute (Ptr<Object> object, std::string name)
+{
+}
 void 
 AttributeIterator::DoStartVisitObject (Ptr<Object> object)
 {
@@ -255,6 +259,9 @@ AttributeIterator::DoIterate (Ptr<Object> object)
           else
             {
               NS_LOG_DEBUG ("could not store " << info.name);
+              m_currentPath.push_back (info.name);
+              DoVisitSkippedAttribute (object, info.name);
+              m_currentPath.pop_back ();
             }
         }
     }
@@ -58,6 +58,14 @@ private:
    * \param name the attribute name
    */
   virtual void DoVisitAttribute (Ptr<Object> object, std::string name) = 0;
+  /**
+   * This method is called for the attributes which cannot be both read
+   * and written, and hence are not visited by DoVisitAttribute.
+   *
+   * \param object the object visited
+   * \param name the attribute name
+   */
+  virtual void DoVisitSkippedAttribute (Ptr<Object> object, std::string name);
   /**
    * This method is called to start the process of visiting the input object
    * \param object the object visited
@@ -0,0 +1,351 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "attribute-iterator.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-profiler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+namespace {
+
+/**
+ * \ingroup configstore
+ * Get the processes created by Checkpoint::Fork.
+ * \returns The process ids of the branches.
+ */
+std::vector<pid_t> &
+GetChildren (void)
+{
+  static std::vector<pid_t> children;
+  return children;
+}
+
+/**
+ * \ingroup configstore
+ * Write the attributes and the random variable streams reachable from
+ * the root namespace.
+ */
+class CheckpointAttributeIterator : public AttributeIterator
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] os The output stream.
+   * \param [in] unsaved The list of unsaved items to fill.
+   */
+  CheckpointAttributeIterator (std::ostream &os, std::vector<std::string> &unsaved)
+    : m_os (os),
+      m_unsaved (unsaved)
+  {}
+private:
+  virtual void DoVisitAttribute (Ptr<Object> object, std::string name)
+  {
+    StringValue str;
+    object->GetAttribute (name, str);
+    m_os << "value " << GetCurrentPath () << " \"" << str.Get () << "\"" << std::endl;
+  }
+  virtual void DoVisitSkippedAttribute (Ptr<Object> object, std::string name)
+  {
+    m_os << "unsaved " << GetCurrentPath () << std::endl;
+    m_unsaved.push_back ("attribute " + GetCurrentPath ());
+  }
+  virtual void DoStartVisitPointerAttribute (Ptr<Object> object, std::string name, Ptr<Object> value)
+  {
+    SaveStream (value);
+  }
+  virtual void DoStartVisitArrayItem (const ObjectPtrContainerValue &vector, uint32_t index, Ptr<Object> item)
+  {
+    SaveStream (item);
+  }
+  /**
+   * Write the state of a random variable stream.
+   * \param [in] object The object, which may be a RandomVariableStream.
+   */
+  void SaveStream (Ptr<Object> object)
+  {
+    Ptr<RandomVariableStream> stream = DynamicCast<RandomVariableStream> (object);
+    if (stream == 0)
+      {
+        return;
+      }
+    double state[6];
+    stream->GetRngState (state);
+    m_os << "rng " << GetCurrentPath ();
+    for (int i = 0; i < 6; ++i)
+      {
+        m_os << " " << static_cast<uint64_t> (state[i]);
+      }
+    m_os << std::endl;
+  }
+  std::ostream &m_os;                     //!< The output stream.
+  std::vector<std::string> &m_unsaved;    //!< The unsaved items.
+};
+
+} // unnamed namespace
+
+Checkpoint::Checkpoint ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Checkpoint::Save (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream os (filename.c_str (), std::ios::out);
+  NS_ABORT_MSG_IF (!os.is_open (), "Could not open " << filename);
+  Save (os);
+}
+
+void
+Checkpoint::Save (std::ostream &os)
+{
+  NS_LOG_FUNCTION (this);
+  m_unsaved.clear ();
+  os << "time " << Simulator::Now ().GetTimeStep () << std::endl;
+  os << "seed " << RngSeedManager::GetSeed ()
+     << " run " << RngSeedManager::GetRun ()
+     << " stream " << RngSeedManager::PeekNextStreamIndex () << std::endl;
+
+  CheckpointAttributeIterator iterator (os, m_unsaved);
+  iterator.Iterate ();
+
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl == 0)
+    {
+      std::string name = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+      os << "unsaved events of " << name << std::endl;
+      m_unsaved.push_back ("events of " + name);
+    }
+  else
+    {
+      std::vector<EventId> events = impl->GetPendingEvents ();
+      for (std::vector<EventId>::const_iterator i = events.begin (); i != events.end (); ++i)
+        {
+          std::ostringstream oss;
+          oss << i->GetTs () << " " << i->GetContext ()
+              << " \"" << EventProfiler::GetTypeName (typeid (*i->PeekEventImpl ())) << "\"";
+          os << "event " << oss.str () << std::endl;
+          m_unsaved.push_back ("event " + oss.str ());
+        }
+    }
+  if (!m_unsaved.empty ())
+    {
+      NS_LOG_WARN (m_unsaved.size () << " items could not be saved");
+    }
+}
+
+const std::vector<std::string> &
+Checkpoint::GetUnsaved (void) const
+{
+  return m_unsaved;
+}
+
+void
+Checkpoint::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ifstream is (filename.c_str (), std::ios::in);
+  NS_ABORT_MSG_IF (!is.is_open (), "Could not open " << filename);
+  Load (is);
+}
+
+void
+Checkpoint::Load (std::istream &is)
+{
+  NS_LOG_FUNCTION (this);
+  m_unrestored.clear ();
+
+  // Setting the attributes of a random variable may allocate it a new
+  // RngStream, so the streams are restored after the attributes, and the
+  // next stream index at the end.
+  bool seeded = false;
+  uint64_t nextStream = 0;
+  std::vector<std::pair<std::string, std::string> > values;
+  std::vector<std::pair<std::string, std::vector<double> > > streams;
+  std::string line;
+  while (std::getline (is, line))
+    {
+      std::istringstream iss (line);
+      std::string type;
+      iss >> type;
+      if (type == "time")
+        {
+          int64_t ts;
+          iss >> ts;
+          if (ts != Simulator::Now ().GetTimeStep ())
+            {
+              m_unrestored.push_back (line);
+            }
+        }
+      else if (type == "seed")
+        {
+          uint32_t seed;
+          uint64_t run;
+          std::string runKey, streamKey;
+          iss >> seed >> runKey >> run >> streamKey >> nextStream;
+          NS_ABORT_MSG_IF (iss.fail (), "Malformed checkpoint line: " << line);
+          RngSeedManager::SetSeed (seed);
+          RngSeedManager::SetRun (run);
+          seeded = true;
+        }
+      else if (type == "value")
+        {
+          std::string path;
+          iss >> path;
+          std::string::size_type first = line.find ('"');
+          std::string::size_type last = line.rfind ('"');
+          NS_ABORT_MSG_IF (first == last, "Malformed checkpoint line: " << line);
+          values.push_back (std::make_pair (path, line.substr (first + 1, last - first - 1)));
+        }
+      else if (type == "rng")
+        {
+          std::string path;
+          std::vector<double> state (6);
+          iss >> path;
+          for (int i = 0; i < 6; ++i)
+            {
+              uint64_t component;
+              iss >> component;
+              state[i] = static_cast<double> (component);
+            }
+          NS_ABORT_MSG_IF (iss.fail (), "Malformed checkpoint line: " << line);
+          streams.push_back (std::make_pair (path, state));
+        }
+      else if (type == "unsaved" || type == "event")
+        {
+          m_unrestored.push_back (line);
+        }
+    }
+
+  for (std::vector<std::pair<std::string, std::string> >::const_iterator i = values.begin ();
+       i != values.end (); ++i)
+    {
+      std::string::size_type slash = i->first.rfind ('/');
+      Config::MatchContainer matches = Config::LookupMatches (i->first.substr (0, slash));
+      bool restored = matches.GetN () > 0;
+      for (Config::MatchContainer::Iterator j = matches.Begin (); j != matches.End (); ++j)
+        {
+          restored &= (*j)->SetAttributeFailSafe (i->first.substr (slash + 1), StringValue (i->second));
+        }
+      if (!restored)
+        {
+          m_unrestored.push_back ("attribute " + i->first);
+        }
+    }
+  for (std::vector<std::pair<std::string, std::vector<double> > >::const_iterator i = streams.begin ();
+       i != streams.end (); ++i)
+    {
+      Config::MatchContainer matches = Config::LookupMatches (i->first);
+      bool restored = matches.GetN () > 0;
+      for (Config::MatchContainer::Iterator j = matches.Begin (); j != matches.End (); ++j)
+        {
+          Ptr<RandomVariableStream> stream = DynamicCast<RandomVariableStream> (*j);
+          if (stream == 0)
+            {
+              restored = false;
+              continue;
+            }
+          stream->SetRngState (&i->second[0]);
+        }
+      if (!restored)
+        {
+          m_unrestored.push_back ("rng " + i->first);
+        }
+    }
+  if (seeded)
+    {
+      RngSeedManager::SetNextStreamIndex (nextStream);
+    }
+  if (!m_unrestored.empty ())
+    {
+      NS_LOG_WARN (m_unrestored.size () << " items could not be restored");
+    }
+}
+
+const std::vector<std::string> &
+Checkpoint::GetUnrestored (void) const
+{
+  return m_unrestored;
+}
+
+uint32_t
+Checkpoint::Fork (uint32_t branches)
+{
+  NS_LOG_FUNCTION (branches);
+  NS_ASSERT (branches > 0);
+  // Do not let the branches write the same buffered output.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+  for (uint32_t i = 1; i < branches; ++i)
+    {
+      pid_t pid = fork ();
+      NS_ABORT_MSG_IF (pid < 0, "Could not fork: " << std::strerror (errno));
+      if (pid == 0)
+        {
+          GetChildren ().clear ();
+          return i;
+        }
+      GetChildren ().push_back (pid);
+    }
+  return 0;
+}
+
+bool
+Checkpoint::Wait (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  bool success = true;
+  std::vector<pid_t> &children = GetChildren ();
+  for (std::vector<pid_t>::const_iterator i = children.begin (); i != children.end (); ++i)
+    {
+      int status;
+      if (waitpid (*i, &status, 0) < 0
+          || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("branch " << *i << " failed");
+          success = false;
+        }
+    }
+  children.clear ();
+  return success;
+}
+
+} // namespace ns3
@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup configstore
+ *
+ * \brief Snapshot the state of a running simulation, and branch
+ * several runs from it.
+ *
+ * Save() writes the state of the simulation which can be expressed as
+ * data, in a raw text format close to the one of ConfigStore:
+ *  - the current simulation time;
+ *  - the seed, run number and next automatic stream index of
+ *    RngSeedManager;
+ *  - the state of the RngStream of every RandomVariableStream
+ *    reachable through the attributes of the objects of the root
+ *    namespace;
+ *  - the value of every attribute reachable from the root namespace,
+ *    as walked by AttributeIterator.
+ *
+ * The items which cannot be saved are reported in the file and by
+ * GetUnsaved(): the attributes which cannot be both read and written,
+ * and the pending events, whose EventImpl hold arbitrary function
+ * pointers and arguments.
+ *
+ * Load() restores a snapshot into a simulation built again by the same
+ * program: it sets the state of RngSeedManager, the attribute values and
+ * the state of the random variable streams found at the saved paths.  It
+ * cannot recreate objects or the event list, and cannot move the
+ * simulation clock, so the saved time and events are only reported by
+ * GetUnrestored(), with the items which could not be found.  The random
+ * variables then draw the same sequences as after the snapshot, but the
+ * program has to schedule its events again.
+ *
+ * To resume a simulation from a snapshot, Fork() duplicates the whole
+ * process at the current simulation time, including the event list:
+ * each branch then continues with its own downstream parameters, in
+ * parallel with the other branches.  This lets a parameter sweep run
+ * a long warm-up phase only once:
+ *
+ * \code
+ *   Simulator::Stop (warmUp);
+ *   Simulator::Run ();
+ *   uint32_t branch = Checkpoint::Fork (rates.size ());
+ *   Config::Set ("/NodeList/0/ApplicationList/0/$ns3::OnOffApplication/DataRate",
+ *                DataRateValue (rates[branch]));
+ *   Simulator::Stop (duration);
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ *   Checkpoint::Wait ();
+ * \endcode
+ *
+ * Fork() relies on the POSIX fork() function: the simulator must run
+ * in a single thread, and the files opened before the fork, such as
+ * trace files, are shared by all the branches.
+ */
+class Checkpoint
+{
+public:
+  Checkpoint ();
+
+  /**
+   * Write the state of the simulation.
+   *
+   * \param [in] filename The name of the snapshot file.
+   */
+  void Save (std::string filename);
+  /**
+   * Write the state of the simulation.
+   *
+   * \param [in] os The output stream.
+   */
+  void Save (std::ostream &os);
+  /**
+   * Get the items which could not be saved by the last call to Save().
+   *
+   * \returns The descriptions of the attributes and events which
+   *          were not saved.
+   */
+  const std::vector<std::string> &GetUnsaved (void) const;
+
+  /**
+   * Restore the state of the simulation written by Save().
+   *
+   * \param [in] filename The name of the snapshot file.
+   */
+  void Load (std::string filename);
+  /**
+   * Restore the state of the simulation written by Save().
+   *
+   * \param [in] is The input stream.
+   */
+  void Load (std::istream &is);
+  /**
+   * Get the items which could not be restored by the last call to Load().
+   *
+   * \returns The descriptions of the time, events, attributes and
+   *          random variable streams which were not restored.
+   */
+  const std::vector<std::string> &GetUnrestored (void) const;
+
+  /**
+   * Duplicate the process, to run several branches of the simulation
+   * from the current state.
+   *
+   * The calling process is branch 0, and \p branches - 1 child
+   * processes are created.
+   *
+   * \param [in] branches The number of branches, including the
+   *             calling process.
+   * \returns The index of the branch run by the process.
+   */
+  static uint32_t Fork (uint32_t branches);
+  /**
+   * Wait for the end of the branches created by this process.
+   *
+   * \returns \c true if every branch exited successfully.
+   */
+  static bool Wait (void);
+
+private:
+  /** The items not saved by the last call to Save(). */
+  std::vector<std::string> m_unsaved;
+  /** The items not restored by the last call to Load(). */
+  std::vector<std::string> m_unrestored;
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,253 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/checkpoint.h"
+#include "ns3/config.h"
+#include "ns3/object.h"
+#include "ns3/pointer.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include <sstream>
+#include <unistd.h>
+
+using namespace ns3;
+
+class CheckpointTestObject : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+  CheckpointTestObject ();
+  uint32_t GetCount (void) const;
+  uint32_t m_value;
+  uint32_t m_count;
+  Ptr<RandomVariableStream> m_random;
+};
+
+TypeId
+CheckpointTestObject::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CheckpointTestObject")
+    .SetParent<Object> ()
+    .AddAttribute ("Value", "A value.",
+                   UintegerValue (7),
+                   MakeUintegerAccessor (&CheckpointTestObject::m_value),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Count", "A read-only value.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&CheckpointTestObject::GetCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Random", "A random variable.",
+                   StringValue ("ns3::UniformRandomVariable"),
+                   MakePointerAccessor (&CheckpointTestObject::m_random),
+                   MakePointerChecker<RandomVariableStream> ())
+  ;
+  return tid;
+}
+
+CheckpointTestObject::CheckpointTestObject ()
+  : m_count (0)
+{
+}
+
+uint32_t
+CheckpointTestObject::GetCount (void) const
+{
+  return m_count;
+}
+
+class CheckpointSaveTestCase : public TestCase
+{
+public:
+  CheckpointSaveTestCase ();
+  virtual void DoRun (void);
+  void Count (Ptr<CheckpointTestObject> object);
+};
+
+CheckpointSaveTestCase::CheckpointSaveTestCase ()
+  : TestCase ("Check the content of a checkpoint")
+{
+}
+
+void
+CheckpointSaveTestCase::Count (Ptr<CheckpointTestObject> object)
+{
+  object->m_count++;
+}
+
+void
+CheckpointSaveTestCase::DoRun (void)
+{
+  Ptr<CheckpointTestObject> object = CreateObject<CheckpointTestObject> ();
+  Config::RegisterRootNamespaceObject (object);
+  Simulator::Schedule (Seconds (5), &CheckpointSaveTestCase::Count, this, object);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  std::ostringstream oss;
+  Checkpoint checkpoint;
+  checkpoint.Save (oss);
+  std::string saved = oss.str ();
+  NS_TEST_EXPECT_MSG_NE (saved.find ("time 1000000000\n"), std::string::npos, "Missing time");
+  NS_TEST_EXPECT_MSG_NE (saved.find ("seed "), std::string::npos, "Missing seed");
+  NS_TEST_EXPECT_MSG_NE (saved.find ("value /$ns3::CheckpointTestObject/Value \"7\"\n"),
+                         std::string::npos, "Missing attribute");
+  NS_TEST_EXPECT_MSG_NE (saved.find ("rng /$ns3::CheckpointTestObject/Random/$ns3::UniformRandomVariable "),
+                         std::string::npos, "Missing random variable stream");
+  NS_TEST_EXPECT_MSG_NE (saved.find ("unsaved /$ns3::CheckpointTestObject/Count\n"),
+                         std::string::npos, "Missing read-only attribute");
+  NS_TEST_EXPECT_MSG_NE (saved.find ("event 5000000000 "), std::string::npos, "Missing event");
+
+  const std::vector<std::string> &unsaved = checkpoint.GetUnsaved ();
+  NS_TEST_EXPECT_MSG_EQ (unsaved.size (), 2, "Wrong number of unsaved items");
+
+  Simulator::Destroy ();
+  Config::UnregisterRootNamespaceObject (object);
+}
+
+class CheckpointLoadTestCase : public TestCase
+{
+public:
+  CheckpointLoadTestCase ();
+  virtual void DoRun (void);
+};
+
+CheckpointLoadTestCase::CheckpointLoadTestCase ()
+  : TestCase ("Check that a checkpoint restores the attributes and the random variables")
+{
+}
+
+void
+CheckpointLoadTestCase::DoRun (void)
+{
+  Ptr<CheckpointTestObject> object = CreateObject<CheckpointTestObject> ();
+  Config::RegisterRootNamespaceObject (object);
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      object->m_random->GetValue ();
+    }
+
+  uint64_t nextStream = RngSeedManager::PeekNextStreamIndex ();
+  std::ostringstream oss;
+  Checkpoint checkpoint;
+  checkpoint.Save (oss);
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::PeekNextStreamIndex (), nextStream, "Save consumed a stream index");
+
+  std::vector<double> expected;
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      expected.push_back (object->m_random->GetValue ());
+    }
+  object->m_value = 3;
+  CreateObject<UniformRandomVariable> ();
+
+  std::istringstream iss (oss.str ());
+  checkpoint.Load (iss);
+  NS_TEST_EXPECT_MSG_EQ (object->m_value, 7, "Attribute not restored");
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (object->m_random->GetValue (), expected[i], "Random variable " << i << " not restored");
+    }
+  NS_TEST_EXPECT_MSG_EQ (RngSeedManager::PeekNextStreamIndex (), nextStream, "Next stream index not restored");
+  // Only the read-only attribute cannot be restored.
+  const std::vector<std::string> &unrestored = checkpoint.GetUnrestored ();
+  NS_TEST_EXPECT_MSG_EQ (unrestored.size (), 1, "Wrong number of unrestored items");
+
+  Simulator::Destroy ();
+  Config::UnregisterRootNamespaceObject (object);
+}
+
+class CheckpointForkTestCase : public TestCase
+{
+public:
+  CheckpointForkTestCase ();
+  virtual void DoRun (void);
+  void Count (void);
+  uint32_t m_count;
+};
+
+CheckpointForkTestCase::CheckpointForkTestCase ()
+  : TestCase ("Check that the branches of a simulation resume from the same state")
+{
+}
+
+void
+CheckpointForkTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+CheckpointForkTestCase::DoRun (void)
+{
+  m_count = 0;
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Simulator::Schedule (Seconds (i), &CheckpointForkTestCase::Count, this);
+    }
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (42);
+  random->GetValue ();
+  Simulator::Stop (Seconds (4.5));
+  Simulator::Run ();
+
+  double state[6];
+  random->GetRngState (state);
+  uint32_t branch = Checkpoint::Fork (3);
+  // Each branch runs for a different duration, and draws a different
+  // number of values before checking the sequence from the checkpoint.
+  Simulator::Stop (Seconds (branch + 1));
+  Simulator::Run ();
+  std::vector<double> drawn;
+  for (uint32_t i = 0; i < 5 + branch; ++i)
+    {
+      drawn.push_back (random->GetValue ());
+    }
+  Ptr<UniformRandomVariable> reference = CreateObject<UniformRandomVariable> ();
+  reference->SetStream (42);
+  reference->SetRngState (state);
+  bool success = m_count == 6 + branch
+    && Simulator::Now () == Seconds (4.5 + branch + 1);
+  for (uint32_t i = 0; i < drawn.size (); ++i)
+    {
+      success = success && drawn[i] == reference->GetValue ();
+    }
+  Simulator::Destroy ();
+  if (branch != 0)
+    {
+      _exit (success ? 0 : 1);
+    }
+  NS_TEST_EXPECT_MSG_EQ (success, true, "First branch did not resume from the checkpoint");
+  NS_TEST_EXPECT_MSG_EQ (Checkpoint::Wait (), true, "Other branches did not resume from the checkpoint");
+}
+
+class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ()
+    : TestSuite ("checkpoint", UNIT)
+  {
+    AddTestCase (new CheckpointSaveTestCase, TestCase::QUICK);
+    AddTestCase (new CheckpointLoadTestCase, TestCase::QUICK);
+    AddTestCase (new CheckpointForkTestCase, TestCase::QUICK);
+  }
+};
+
+static CheckpointTestSuite g_checkpointTestSuite;
@@ -25,6 +25,7 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "replication-runner.h"
 
 #include <sstream>
 
@@ -606,6 +607,16 @@ public:
   /** \copydoc Config::GetRootNamespaceObject() */
   Ptr<Object> GetRootNamespaceObject (std::size_t i) const;
 
+  /**
+   * Get the instance used by the calling thread.
+   *
+   * Each replication run by a ReplicationRunner has its own root
+   * namespace.
+   *
+   * \returns The instance.
+   */
+  static ConfigImpl *Get (void);
+
 private:
   /**
    * Break a Config path into the leading path and the last leaf token.
@@ -718,6 +729,17 @@ ConfigImpl::LookupMatches (std::string path)
   return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
 }
 
+ConfigImpl *
+ConfigImpl::Get (void)
+{
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      static thread_local ConfigImpl config;
+      return &config;
+    }
+  return Singleton<ConfigImpl>::Get ();
+}
+
 void 
 ConfigImpl::RegisterRootNamespaceObject (Ptr<Object> obj)
 {
@@ -22,13 +22,21 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "uinteger.h"
+#include "string.h"
+#include "boolean.h"
 #include "assert.h"
 #include "log.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <vector>
 
 
 /**
@@ -46,6 +54,49 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+namespace {
+
+/**
+ * \ingroup simulator
+ * Order the batched events by context, keeping the uid order of the
+ * events of the same context.
+ */
+struct BatchOrder
+{
+  /**
+   * Constructor.
+   * \param [in] batch The batched events.
+   */
+  BatchOrder (const std::vector<Scheduler::Event> &batch)
+    : m_batch (batch)
+  {}
+  /**
+   * \param [in] a The index of the first event.
+   * \param [in] b The index of the second event.
+   * \returns \c true if the first event should be executed first.
+   */
+  bool operator () (uint32_t a, uint32_t b) const
+  {
+    return m_batch[a].key.m_context < m_batch[b].key.m_context;
+  }
+  const std::vector<Scheduler::Event> &m_batch;  //!< The batched events.
+};
+
+/**
+ * \ingroup simulator
+ * Order events by uid.
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \p a has a smaller uid than \p b.
+ */
+bool
+UidLess (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key.m_uid < b.key.m_uid;
+}
+
+} // unnamed namespace
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,6 +104,35 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("CancelledEventsThreshold",
+                   "The number of cancelled events left in the event queue "
+                   "above which they are purged, when they make up at least "
+                   "half of the queue.  Zero disables the purge.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_cancelledEventsThreshold),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileSamplingInterval",
+                   "Measure the wall-clock time spent in one event out of "
+                   "this number of events.  Zero disables profiling.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profileSamplingInterval),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileOutput",
+                   "If not empty, the prefix of the files into which the event "
+                   "profile is written when the simulator is destroyed: the "
+                   "report sorted by time goes to <prefix>.txt, and the folded "
+                   "stacks for flame graphs to <prefix>.folded.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileOutput),
+                   MakeStringChecker ())
+    .AddAttribute ("BatchByContext",
+                   "Execute the events which expire at the same time grouped "
+                   "by context, to improve the memory locality.  Only enable "
+                   "this if the events of different nodes expiring at the "
+                   "same time do not depend on each other.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_batchByContext),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -71,14 +151,18 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
+  m_cancelledEvents = 0;
   m_eventCount = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profiler = 0;
+  m_batchNext = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -93,6 +177,23 @@ DefaultSimulatorImpl::DoDispose (void)
       next.impl->Unref ();
     }
   m_events = 0;
+  for (std::vector<Scheduler::Event>::const_iterator i = m_batch.begin (); i != m_batch.end (); ++i)
+    {
+      if (i->impl != 0)
+        {
+          i->impl->Unref ();
+        }
+    }
+  m_batch.clear ();
+  m_batchOrder.clear ();
+  m_batchNext = 0;
+  if (m_profiler != 0 && !m_profileOutput.empty ())
+    {
+      std::ofstream report ((m_profileOutput + ".txt").c_str ());
+      m_profiler->Print (report);
+      std::ofstream folded ((m_profileOutput + ".folded").c_str ());
+      m_profiler->PrintFoldedStacks (folded);
+    }
   SimulatorImpl::DoDispose ();
 }
 void
@@ -135,10 +236,88 @@ DefaultSimulatorImpl::GetSystemId (void) const
   return 0;
 }
 
+bool
+DefaultSimulatorImpl::IsQueueEmpty (void) const
+{
+  return m_events->IsEmpty () && m_batchNext == m_batchOrder.size ();
+}
+
+void
+DefaultSimulatorImpl::FillBatch (void)
+{
+  m_batch.clear ();
+  m_batchOrder.clear ();
+  m_batchNext = 0;
+  uint64_t ts = m_events->PeekNext ().key.m_ts;
+  while (!m_events->IsEmpty () && m_events->PeekNext ().key.m_ts == ts)
+    {
+      m_batch.push_back (m_events->RemoveNext ());
+      m_batchOrder.push_back (m_batchOrder.size ());
+    }
+  // The events without context split the batch in groups which are
+  // ordered by context, and executed in order.
+  std::vector<uint32_t>::iterator start = m_batchOrder.begin ();
+  while (start != m_batchOrder.end ())
+    {
+      std::vector<uint32_t>::iterator end = start;
+      while (end != m_batchOrder.end () && m_batch[*end].key.m_context != Simulator::NO_CONTEXT)
+        {
+          ++end;
+        }
+      std::stable_sort (start, end, BatchOrder (m_batch));
+      start = (end == m_batchOrder.end ()) ? end : end + 1;
+    }
+  NS_LOG_LOGIC ("batch " << m_batch.size () << " events at " << ts);
+}
+
+Scheduler::Event *
+DefaultSimulatorImpl::FindInBatch (const EventId &id)
+{
+  return const_cast<Scheduler::Event *> (static_cast<const DefaultSimulatorImpl *> (this)->FindInBatch (id));
+}
+
+const Scheduler::Event *
+DefaultSimulatorImpl::FindInBatch (const EventId &id) const
+{
+  if (m_batch.empty () || id.GetTs () != m_batch.front ().key.m_ts)
+    {
+      return 0;
+    }
+  Scheduler::Event ev;
+  ev.key.m_uid = id.GetUid ();
+  std::vector<Scheduler::Event>::const_iterator i =
+    std::lower_bound (m_batch.begin (), m_batch.end (), ev, UidLess);
+  if (i == m_batch.end () || i->key.m_uid != id.GetUid ())
+    {
+      return 0;
+    }
+  return &*i;
+}
+
 void
 DefaultSimulatorImpl::ProcessOneEvent (void)
 {
-  Scheduler::Event next = m_events->RemoveNext ();
+  Scheduler::Event next;
+  if (m_batchByContext || m_batchNext < m_batchOrder.size ())
+    {
+      if (m_batchNext == m_batchOrder.size ())
+        {
+          FillBatch ();
+        }
+      Scheduler::Event &batched = m_batch[m_batchOrder[m_batchNext]];
+      m_batchNext++;
+      if (batched.impl == 0)
+        {
+          // removed
+          return;
+        }
+      next = batched;
+      batched.impl = 0;
+    }
+  else
+    {
+      next = m_events->RemoveNext ();
+    }
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
@@ -148,7 +327,22 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (next.impl->IsCancelled () && m_cancelledEvents > 0)
+    {
+      m_cancelledEvents--;
+    }
+  if (m_profiler != 0 && !next.impl->IsCancelled () && m_profiler->Sample ())
+    {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+      next.impl->Invoke ();
+      std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now () - start;
+      m_profiler->Record (next.impl, next.key.m_context,
+                          std::chrono::duration_cast<std::chrono::nanoseconds> (elapsed).count ());
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -157,7 +351,7 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 bool 
 DefaultSimulatorImpl::IsFinished (void) const
 {
-  return m_events->IsEmpty () || m_stop;
+  return IsQueueEmpty () || m_stop;
 }
 
 void
@@ -190,6 +384,47 @@ DefaultSimulatorImpl::ProcessEventsWithContext (void)
     }
 }
 
+void
+DefaultSimulatorImpl::PurgeCancelledEvents (void)
+{
+  if (m_cancelledEventsThreshold == 0
+      || m_cancelledEvents <= m_cancelledEventsThreshold
+      || 2 * (int64_t)m_cancelledEvents < m_unscheduledEvents)
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("purge " << m_cancelledEvents << " cancelled events out of " << m_unscheduledEvents);
+  std::vector<Scheduler::Event> events;
+  events.reserve (m_unscheduledEvents - m_cancelledEvents);
+  while (!m_events->IsEmpty ())
+    {
+      Scheduler::Event next = m_events->RemoveNext ();
+      if (next.impl->IsCancelled ())
+        {
+          next.impl->Unref ();
+          m_unscheduledEvents--;
+        }
+      else
+        {
+          events.push_back (next);
+        }
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      m_events->Insert (*i);
+    }
+  for (std::vector<Scheduler::Event>::iterator i = m_batch.begin (); i != m_batch.end (); ++i)
+    {
+      if (i->impl != 0 && i->impl->IsCancelled ())
+        {
+          i->impl->Unref ();
+          i->impl = 0;
+          m_unscheduledEvents--;
+        }
+    }
+  m_cancelledEvents = 0;
+}
+
 void
 DefaultSimulatorImpl::Run (void)
 {
@@ -198,15 +433,19 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_profileSamplingInterval > 0 && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler (m_profileSamplingInterval);
+    }
 
-  while (!m_events->IsEmpty () && !m_stop) 
+  while (!IsQueueEmpty () && !m_stop) 
     {
       ProcessOneEvent ();
     }
 
   // If the simulator stopped naturally by lack of events, make a
   // consistency test to check that we didn't lose any events along the way.
-  NS_ASSERT (!m_events->IsEmpty () || m_unscheduledEvents == 0);
+  NS_ASSERT (!IsQueueEmpty () || m_unscheduledEvents == 0);
 }
 
 void 
@@ -350,7 +589,15 @@ DefaultSimulatorImpl::Remove (const EventId &id)
   event.key.m_ts = id.GetTs ();
   event.key.m_context = id.GetContext ();
   event.key.m_uid = id.GetUid ();
-  m_events->Remove (event);
+  Scheduler::Event *batched = FindInBatch (id);
+  if (batched != 0)
+    {
+      batched->impl = 0;
+    }
+  else
+    {
+      m_events->Remove (event);
+    }
   event.impl->Cancel ();
   // whenever we remove an event from the event list, we have to unref it.
   event.impl->Unref ();
@@ -364,9 +611,38 @@ DefaultSimulatorImpl::Cancel (const EventId &id)
   if (!IsExpired (id))
     {
       id.PeekEventImpl ()->Cancel ();
+      if (id.GetUid () != 2)
+        {
+          m_cancelledEvents++;
+          PurgeCancelledEvents ();
+        }
     }
 }
 
+EventId
+DefaultSimulatorImpl::Reschedule (const EventId &id, const Time &delay)
+{
+  NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::Reschedule Thread-unsafe invocation!");
+  NS_ASSERT_MSG (delay.IsPositive (), "DefaultSimulatorImpl::Reschedule(): Negative delay");
+  if (id.GetUid () == 2 || IsExpired (id) || FindInBatch (id) != 0)
+    {
+      return EventId ();
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  m_events->Remove (event);
+  // The event keeps the reference held by the event list.
+  event.key.m_ts = (uint64_t) (delay + TimeStep (m_currentTs)).GetTimeStep ();
+  event.key.m_context = GetContext ();
+  event.key.m_uid = m_uid;
+  m_uid++;
+  m_events->Insert (event);
+  return EventId (event.impl, event.key.m_ts, event.key.m_context, event.key.m_uid);
+}
+
 bool
 DefaultSimulatorImpl::IsExpired (const EventId &id) const
 {
@@ -389,16 +665,27 @@ DefaultSimulatorImpl::IsExpired (const EventId &id) const
     }
   if (id.PeekEventImpl () == 0 ||
       id.GetTs () < m_currentTs ||
-      (id.GetTs () == m_currentTs &&
-       id.GetUid () <= m_currentUid) ||
-      id.PeekEventImpl ()->IsCancelled ()) 
+      id.PeekEventImpl ()->IsCancelled ())
     {
       return true;
     }
-  else
+  if (id.GetTs () > m_currentTs)
     {
       return false;
     }
+  if (!m_batch.empty () && m_batch.front ().key.m_ts == m_currentTs)
+    {
+      // The events of the batch are not executed in uid order: the
+      // events before the batch have expired, the events after it,
+      // scheduled during the batch, are pending.
+      const Scheduler::Event *batched = FindInBatch (id);
+      if (batched != 0)
+        {
+          return batched->impl == 0;
+        }
+      return id.GetUid () < m_batch.front ().key.m_uid;
+    }
+  return id.GetUid () <= m_currentUid;
 }
 
 Time 
@@ -419,4 +706,39 @@ DefaultSimulatorImpl::GetEventCount (void) const
   return m_eventCount;
 }
 
+EventProfiler *
+DefaultSimulatorImpl::GetProfiler (void) const
+{
+  return m_profiler;
+}
+
+std::vector<EventId>
+DefaultSimulatorImpl::GetPendingEvents (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<EventId> pending;
+  for (uint32_t i = m_batchNext; i < m_batchOrder.size (); ++i)
+    {
+      const Scheduler::Event &ev = m_batch[m_batchOrder[i]];
+      if (ev.impl != 0 && !ev.impl->IsCancelled ())
+        {
+          pending.push_back (EventId (ev.impl, ev.key.m_ts, ev.key.m_context, ev.key.m_uid));
+        }
+    }
+  std::vector<Scheduler::Event> events;
+  while (!m_events->IsEmpty ())
+    {
+      events.push_back (m_events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      if (!i->impl->IsCancelled ())
+        {
+          pending.push_back (EventId (i->impl, i->key.m_ts, i->key.m_context, i->key.m_uid));
+        }
+      m_events->Insert (*i);
+    }
+  return pending;
+}
+
 } // namespace ns3
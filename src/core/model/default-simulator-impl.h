@@ -30,6 +30,8 @@
 #include "ptr.h"
 
 #include <list>
+#include <string>
+#include <vector>
 
 /**
  * \file
@@ -39,10 +41,34 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the BatchByContext attribute is set, all the events which
+ * expire at the same time are taken out of the scheduler together, and
+ * executed grouped by context, that is by node, so that the state of
+ * each node is touched once per time step.  The following guards keep
+ * the execution order identical to the default order, by time stamp
+ * and uid, wherever the events may depend on each other:
+ *  - the events of the same context keep their relative order;
+ *  - events without context (Simulator::NO_CONTEXT), such as the
+ *    events scheduled by the main program, are never reordered with
+ *    the other events: they split the batch in groups which are
+ *    executed in order;
+ *  - the events scheduled during a batch for the same time, which
+ *    would run after all the events of the batch, are executed in
+ *    another batch, after the current one;
+ *  - cancelling, removing or checking the expiration of a batched
+ *    event behaves as in the default order.
+ *
+ * The events of different nodes which expire at the same time may
+ * still be executed in a different order, so this mode must only be
+ * enabled if the models do not depend on that order, for instance
+ * through the state of a channel shared by the nodes.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -69,6 +95,7 @@ public:
   virtual EventId ScheduleDestroy (EventImpl *event);
   virtual void Remove (const EventId &id);
   virtual void Cancel (const EventId &id);
+  virtual EventId Reschedule (const EventId &id, const Time &delay);
   virtual bool IsExpired (const EventId &id) const;
   virtual void Run (void);
   virtual Time Now (void) const;
@@ -79,6 +106,25 @@ public:
   virtual uint32_t GetContext (void) const;
   virtual uint64_t GetEventCount (void) const;
 
+  /**
+   * Get the event profiler.
+   *
+   * The profiler is created by Run(), when the ProfileSamplingInterval
+   * attribute is not zero.
+   *
+   * \returns The event profiler, or 0 if profiling is disabled.
+   */
+  EventProfiler *GetProfiler (void) const;
+  /**
+   * Get the events which have not expired yet, in execution order.
+   *
+   * The event list is rebuilt, so this is a slow operation, meant for
+   * diagnostics and checkpoints.  Cancelled events are not included.
+   *
+   * \returns The pending events.
+   */
+  std::vector<EventId> GetPendingEvents (void);
+
 private:
   virtual void DoDispose (void);
 
@@ -86,6 +132,32 @@ private:
   void ProcessOneEvent (void);
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
+  /**
+   * Remove the cancelled events from the event queue, if they are
+   * numerous enough.
+   *
+   * The cancelled events are removed once there are more of them than
+   * the CancelledEventsThreshold attribute, and they make up at least
+   * half of the event queue, so that the cost of rebuilding the queue
+   * is amortized over the cancellations.
+   */
+  void PurgeCancelledEvents (void);
+  /** \returns \c true if there is no event left to process. */
+  bool IsQueueEmpty (void) const;
+  /**
+   * Take all the events which expire at the time of the next event
+   * out of the scheduler, and order them by context.
+   */
+  void FillBatch (void);
+  /**
+   * Find an event in the current batch.
+   *
+   * \param [in] id The event.
+   * \returns The event, or 0 if the event is not in the current batch.
+   */
+  Scheduler::Event *FindInBatch (const EventId &id);
+  /** \copydoc FindInBatch(const EventId&) */
+  const Scheduler::Event *FindInBatch (const EventId &id) const;
  
   /** Wrap an event with its execution context. */
   struct EventWithContext {
@@ -132,9 +204,35 @@ private:
    *  not counting the Destroy events; this is used for validation
    */
   int m_unscheduledEvents;
+  /**
+   * Number of cancelled events which are still in the event queue,
+   * not counting the Destroy events.
+   */
+  uint32_t m_cancelledEvents;
+  /** Purge the cancelled events above this number, if not zero. */
+  uint32_t m_cancelledEventsThreshold;
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Profile one event out of this number, if not zero. */
+  uint32_t m_profileSamplingInterval;
+  /** Prefix of the files into which the profile is written. */
+  std::string m_profileOutput;
+  /** The event profiler, if enabled. */
+  EventProfiler *m_profiler;
+
+  /** Whether events expiring at the same time are grouped by context. */
+  bool m_batchByContext;
+  /**
+   * The events of the current batch, by uid.  The impl of the events
+   * which have been executed or removed is reset to 0.
+   */
+  std::vector<Scheduler::Event> m_batch;
+  /** The indexes in m_batch of the events, in execution order. */
+  std::vector<uint32_t> m_batchOrder;
+  /** The position in m_batchOrder of the next event to execute. */
+  uint32_t m_batchNext;
 };
 
 } // namespace ns3
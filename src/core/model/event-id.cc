@@ -56,6 +56,18 @@ EventId::Cancel (void)
   Simulator::Cancel (*this);
 }
 bool
+EventId::Reschedule (const Time &delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  EventId id = Simulator::Reschedule (*this, delay);
+  if (id.m_eventImpl == 0)
+    {
+      return false;
+    }
+  *this = id;
+  return true;
+}
+bool
 EventId::IsExpired (void) const
 {
   NS_LOG_FUNCTION (this);
@@ -33,6 +33,7 @@
 namespace ns3 {
 
 class EventImpl;
+class Time;
 
 /**
  * \ingroup events
@@ -68,6 +69,20 @@ public:
    * method.
    */
   void Cancel (void);
+  /**
+   * Move this event to a new time, relative to the current time,
+   * with ns3::Simulator::Reschedule.
+   *
+   * On success, this EventId is updated to refer to the moved event.
+   * Otherwise, either because the event has already expired or because
+   * the simulator implementation does not support moving events,
+   * this EventId is left untouched and the caller should schedule
+   * a new event.
+   *
+   * \param [in] delay The delay after which the event should expire.
+   * \returns \c true if the event has been moved, \c false otherwise.
+   */
+  bool Reschedule (const Time &delay);
   /**
    * This method is syntactic sugar for the ns3::Simulator::IsExpired
    * method.
@@ -20,6 +20,7 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <new>
 
 /**
  * \file
@@ -31,6 +32,104 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** \ingroup events Granularity of the event size classes, in bytes. */
+const std::size_t EVENT_SIZE_CLASS_WIDTH = 16;
+/** \ingroup events Number of event size classes. */
+const std::size_t EVENT_SIZE_CLASSES = 16;
+/** \ingroup events Maximum number of blocks kept in each free list. */
+const uint32_t EVENT_FREE_LIST_MAX_SIZE = 4096;
+
+/**
+ * \ingroup events
+ * The free lists of released event blocks of one thread.
+ *
+ * Events created by one thread and deleted by another one, as happens
+ * with the multithreaded simulator, are simply recycled by the
+ * deleting thread: the free lists are bounded, so the memory cannot
+ * accumulate in one of them.
+ */
+struct EventFreeList
+{
+  /** A released block, linked to the next one of its size class. */
+  struct Block
+  {
+    Block *m_next;  //!< The next released block.
+  };
+  /** Release all the blocks when the thread exits. */
+  ~EventFreeList ();
+
+  Block *m_head[EVENT_SIZE_CLASSES];   //!< The released blocks of each size class.
+  uint32_t m_size[EVENT_SIZE_CLASSES]; //!< The number of blocks of each size class.
+};
+
+/** \ingroup events The free lists of the current thread. */
+thread_local EventFreeList g_eventFreeList;
+/**
+ * \ingroup events
+ * Set once the free lists of the current thread have been destroyed,
+ * so that events deleted later by static destructors bypass them.
+ */
+thread_local bool g_eventFreeListDestroyed = false;
+
+EventFreeList::~EventFreeList ()
+{
+  for (std::size_t i = 0; i < EVENT_SIZE_CLASSES; ++i)
+    {
+      while (m_head[i] != 0)
+        {
+          Block *block = m_head[i];
+          m_head[i] = block->m_next;
+          ::operator delete (block);
+        }
+      m_size[i] = 0;
+    }
+  g_eventFreeListDestroyed = true;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_SIZE_CLASS_WIDTH;
+  if (sizeClass >= EVENT_SIZE_CLASSES || g_eventFreeListDestroyed)
+    {
+      return ::operator new (size);
+    }
+  EventFreeList &freeList = g_eventFreeList;
+  EventFreeList::Block *block = freeList.m_head[sizeClass];
+  if (block == 0)
+    {
+      return ::operator new ((sizeClass + 1) * EVENT_SIZE_CLASS_WIDTH);
+    }
+  freeList.m_head[sizeClass] = block->m_next;
+  freeList.m_size[sizeClass]--;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_SIZE_CLASS_WIDTH;
+  if (sizeClass >= EVENT_SIZE_CLASSES || g_eventFreeListDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventFreeList &freeList = g_eventFreeList;
+  if (freeList.m_size[sizeClass] >= EVENT_FREE_LIST_MAX_SIZE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventFreeList::Block *block = static_cast<EventFreeList::Block *> (p);
+  block->m_next = freeList.m_head[sizeClass];
+  freeList.m_head[sizeClass] = block;
+  freeList.m_size[sizeClass]++;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -46,7 +145,7 @@ void
 EventImpl::Invoke (void)
 {
   NS_LOG_FUNCTION (this);
-  if (!m_cancel)
+  if (!m_cancel.load (std::memory_order_relaxed))
     {
       Notify ();
     }
@@ -56,14 +155,14 @@ void
 EventImpl::Cancel (void)
 {
   NS_LOG_FUNCTION (this);
-  m_cancel = true;
+  m_cancel.store (true, std::memory_order_relaxed);
 }
 
 bool
 EventImpl::IsCancelled (void)
 {
   NS_LOG_FUNCTION (this);
-  return m_cancel;
+  return m_cancel.load (std::memory_order_relaxed);
 }
 
 } // namespace ns3
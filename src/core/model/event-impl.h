@@ -21,6 +21,8 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include <atomic>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +42,14 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Since one event is created for each call to Simulator::Schedule,
+ * the memory of the events is recycled: the blocks released by
+ * deleted events are kept in per-thread free lists, one for each
+ * size class, from which the following events of the same size are
+ * allocated.  The arguments bound by MakeEvent() are stored in the
+ * event object itself, so scheduling an event does not call the
+ * global allocator once the free lists are primed.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +76,23 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the memory of an event from the free list of the
+   * calling thread.
+   *
+   * \param [in] size The size of the event object.
+   * \returns The allocated memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Release the memory of an event to the free list of the
+   * calling thread.
+   *
+   * \param [in] p The memory to release.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -76,7 +103,13 @@ protected:
   virtual void Notify (void) = 0;
 
 private:
-  bool m_cancel;  /**< Has this event been cancelled. */
+  /**
+   * Has this event been cancelled.
+   *
+   * With the multithreaded simulator an event may be cancelled, or
+   * checked, by a thread other than the one which runs it.
+   */
+  std::atomic<bool> m_cancel;
 };
 
 } // namespace ns3
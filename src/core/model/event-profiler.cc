@@ -0,0 +1,298 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "simulator.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \ingroup simulator
+ * Order profile entries by decreasing time.
+ *
+ * \tparam K \deduced The type of the entry name.
+ * \tparam C \deduced The type of the entry cost.
+ * \param [in] a The first entry.
+ * \param [in] b The second entry.
+ * \returns \c true if \p a took more time than \p b.
+ */
+template <typename K, typename C>
+bool
+MoreTime (const std::pair<K, C> &a, const std::pair<K, C> &b)
+{
+  return a.second.ns > b.second.ns;
+}
+
+/**
+ * \ingroup simulator
+ * Find the end of a template or function argument.
+ *
+ * \param [in] name The string holding the arguments.
+ * \param [in] start The position of the start of the argument.
+ * \returns The position of the comma or of the bracket ending
+ *          the argument, or std::string::npos.
+ */
+std::string::size_type
+FindArgumentEnd (const std::string &name, std::string::size_type start)
+{
+  int depth = 0;
+  for (std::string::size_type i = start; i < name.size (); ++i)
+    {
+      char c = name[i];
+      if (c == '<' || c == '(')
+        {
+          depth++;
+        }
+      else if ((c == '>' || c == ')') && depth > 0)
+        {
+          depth--;
+        }
+      else if ((c == ',' || c == '>' || c == ')') && depth == 0)
+        {
+          return i;
+        }
+    }
+  return std::string::npos;
+}
+
+} // unnamed namespace
+
+EventProfiler::EventProfiler (uint32_t samplingInterval)
+  : m_samplingInterval (samplingInterval),
+    m_countdown (0),
+    m_state (0x9e3779b9)
+{
+  NS_LOG_FUNCTION (this << samplingInterval);
+  NS_ASSERT (samplingInterval > 0);
+  m_countdown = NextGap ();
+}
+
+uint32_t
+EventProfiler::NextGap (void)
+{
+  if (m_samplingInterval == 1)
+    {
+      return 1;
+    }
+  // xorshift32
+  m_state ^= m_state << 13;
+  m_state ^= m_state >> 17;
+  m_state ^= m_state << 5;
+  return 1 + m_state % (2 * m_samplingInterval - 1);
+}
+
+void
+EventProfiler::Record (const EventImpl *event, uint32_t context, int64_t ns)
+{
+  Cost &cost = m_costs[Key (&typeid (*event), context)];
+  cost.count++;
+  cost.ns += ns;
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_costs.clear ();
+}
+
+uint64_t
+EventProfiler::GetSampledEvents (void) const
+{
+  uint64_t count = 0;
+  for (Costs::const_iterator i = m_costs.begin (); i != m_costs.end (); ++i)
+    {
+      count += i->second.count;
+    }
+  return count;
+}
+
+uint32_t
+EventProfiler::GetSamplingInterval (void) const
+{
+  return m_samplingInterval;
+}
+
+int64_t
+EventProfiler::GetTime (const std::string &type) const
+{
+  NS_LOG_FUNCTION (this << type);
+  int64_t ns = 0;
+  for (Costs::const_iterator i = m_costs.begin (); i != m_costs.end (); ++i)
+    {
+      if (GetTypeName (*i->first.first).find (type) != std::string::npos)
+        {
+          ns += i->second.ns;
+        }
+    }
+  return ns;
+}
+
+std::string
+EventProfiler::GetTypeName (const std::type_info &type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // The events built by MakeEvent are local classes of the MakeEvent
+  // functions: name them by the first parameter of the function, the
+  // type of the function or method they invoke.
+  std::string::size_type start = name.find ("MakeEvent");
+  if (start != std::string::npos)
+    {
+      start += std::string ("MakeEvent").size ();
+      if (start < name.size () && name[start] == '<')
+        {
+          start = FindArgumentEnd (name, start + 1);
+          while (start != std::string::npos && name[start] == ',')
+            {
+              start = FindArgumentEnd (name, start + 1);
+            }
+          if (start != std::string::npos)
+            {
+              start++;
+            }
+        }
+      if (start < name.size () && name[start] == '(')
+        {
+          std::string::size_type end = FindArgumentEnd (name, start + 1);
+          if (end != std::string::npos)
+            {
+              name = name.substr (start + 1, end - start - 1);
+            }
+        }
+    }
+  // ';' separates the frames of the folded stacks.
+  std::replace (name.begin (), name.end (), ';', ',');
+  return name;
+}
+
+std::string
+EventProfiler::GetContextName (uint32_t context)
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return "no context";
+    }
+  std::ostringstream oss;
+  oss << "context " << context;
+  return oss.str ();
+}
+
+void
+EventProfiler::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  std::map<std::string, Cost> byType;
+  std::map<uint32_t, Cost> byContext;
+  Cost total = { 0, 0 };
+  for (Costs::const_iterator i = m_costs.begin (); i != m_costs.end (); ++i)
+    {
+      Cost &type = byType[GetTypeName (*i->first.first)];
+      Cost &context = byContext[i->first.second];
+      type.count += i->second.count;
+      type.ns += i->second.ns;
+      context.count += i->second.count;
+      context.ns += i->second.ns;
+      total.count += i->second.count;
+      total.ns += i->second.ns;
+    }
+  std::vector<std::pair<std::string, Cost> > types (byType.begin (), byType.end ());
+  std::sort (types.begin (), types.end (), MoreTime<std::string, Cost>);
+  std::vector<std::pair<uint32_t, Cost> > contexts (byContext.begin (), byContext.end ());
+  std::sort (contexts.begin (), contexts.end (), MoreTime<uint32_t, Cost>);
+
+  std::ios_base::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed << std::setprecision (3);
+  os << "Event profile: " << total.count << " events sampled, about one every "
+     << m_samplingInterval << " events, " << total.ns * 1e-6 << " ms" << std::endl;
+  os << std::endl << "By event type:" << std::endl;
+  os << std::setw (14) << "time (ms)" << std::setw (9) << "share"
+     << std::setw (12) << "events" << std::setw (12) << "mean (us)"
+     << "  type" << std::endl;
+  for (std::vector<std::pair<std::string, Cost> >::const_iterator i = types.begin ();
+       i != types.end (); ++i)
+    {
+      os << std::setw (14) << i->second.ns * 1e-6
+         << std::setw (8) << (total.ns > 0 ? 100.0 * i->second.ns / total.ns : 0.0) << "%"
+         << std::setw (12) << i->second.count
+         << std::setw (12) << i->second.ns * 1e-3 / i->second.count
+         << "  " << i->first << std::endl;
+    }
+  os << std::endl << "By context:" << std::endl;
+  os << std::setw (14) << "time (ms)" << std::setw (9) << "share"
+     << std::setw (12) << "events" << std::setw (12) << "mean (us)"
+     << "  context" << std::endl;
+  for (std::vector<std::pair<uint32_t, Cost> >::const_iterator i = contexts.begin ();
+       i != contexts.end (); ++i)
+    {
+      os << std::setw (14) << i->second.ns * 1e-6
+         << std::setw (8) << (total.ns > 0 ? 100.0 * i->second.ns / total.ns : 0.0) << "%"
+         << std::setw (12) << i->second.count
+         << std::setw (12) << i->second.ns * 1e-3 / i->second.count
+         << "  " << GetContextName (i->first) << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::PrintFoldedStacks (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  std::map<std::string, int64_t> stacks;
+  for (Costs::const_iterator i = m_costs.begin (); i != m_costs.end (); ++i)
+    {
+      stacks[GetTypeName (*i->first.first) + ";" + GetContextName (i->first.second)] += i->second.ns;
+    }
+  for (std::map<std::string, int64_t>::const_iterator i = stacks.begin (); i != stacks.end (); ++i)
+    {
+      os << i->first << " " << i->second << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ * \brief Attribute the wall-clock time spent in events to their types
+ * and contexts.
+ *
+ * The simulator implementation calls Sample() before executing each
+ * event; if it returns \c true, it measures the wall-clock time spent
+ * executing the event, and passes it to Record().  Only one event out
+ * of the sampling interval is measured, on average, to bound the
+ * overhead of the clock readings.  The gaps between measured events
+ * are drawn from a private pseudo-random generator, so that periodic
+ * sequences of events are not aliased; the random variable streams of
+ * the simulation are not touched.
+ *
+ * Events are keyed by the dynamic type of their EventImpl, that is
+ * by the function or method bound by MakeEvent(), and by their
+ * context, usually the id of the node executing them.  The type names
+ * are only demangled when the profile is printed.
+ *
+ * The profile can be printed as a report sorted by decreasing time,
+ * or in the folded stack format read by the FlameGraph scripts
+ * (https://github.com/brendangregg/FlameGraph), where each line is
+ * <tt>event type;context time</tt>, the time being in nanoseconds.
+ *
+ * \see DefaultSimulatorImpl, attributes ProfileSamplingInterval and
+ * ProfileOutput.
+ */
+class EventProfiler
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] samplingInterval Measure one event out of this number.
+   */
+  EventProfiler (uint32_t samplingInterval);
+
+  /**
+   * Check if the next event should be measured.
+   *
+   * \returns \c true once every sampling interval, on average.
+   */
+  inline bool Sample (void)
+  {
+    if (--m_countdown > 0)
+      {
+        return false;
+      }
+    m_countdown = NextGap ();
+    return true;
+  }
+  /**
+   * Record the time spent in one event.
+   *
+   * \param [in] event The event.
+   * \param [in] context The context of the event.
+   * \param [in] ns The wall-clock time spent in the event, in nanoseconds.
+   */
+  void Record (const EventImpl *event, uint32_t context, int64_t ns);
+  /**
+   * Forget all the recorded events.
+   */
+  void Clear (void);
+
+  /**
+   * \returns The number of measured events.
+   */
+  uint64_t GetSampledEvents (void) const;
+  /**
+   * \returns The sampling interval.
+   */
+  uint32_t GetSamplingInterval (void) const;
+  /**
+   * Get the time spent in the events of a type.
+   *
+   * \param [in] type A substring of the demangled name of the event type.
+   * \returns The time spent in the sampled events whose type name
+   *          includes \p type, in nanoseconds.
+   */
+  int64_t GetTime (const std::string &type) const;
+  /**
+   * Print the time spent by event type, then by context, sorted by
+   * decreasing time.
+   *
+   * \param [in] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+  /**
+   * Print the profile in the folded stack format.
+   *
+   * \param [in] os The output stream.
+   */
+  void PrintFoldedStacks (std::ostream &os) const;
+
+  /**
+   * Get a readable name for the type of an event.
+   *
+   * For the events built by MakeEvent(), this is the type of the
+   * function or method they invoke.
+   *
+   * \param [in] type The dynamic type of the event.
+   * \returns The name of the event type.
+   */
+  static std::string GetTypeName (const std::type_info &type);
+
+private:
+  /** Accumulated cost of a set of events. */
+  struct Cost
+  {
+    uint64_t count;  //!< The number of sampled events.
+    int64_t ns;      //!< The time spent in the sampled events.
+  };
+  /**
+   * Profile key: the dynamic type of the event and its context.
+   *
+   * The type_info objects are unique for a type within a program, so
+   * their addresses can be compared.
+   */
+  typedef std::pair<const std::type_info *, uint32_t> Key;
+  /** Container of the costs. */
+  typedef std::map<Key, Cost> Costs;
+  /**
+   * Get the name of a context.
+   *
+   * \param [in] context The context.
+   * \returns The name of the context.
+   */
+  static std::string GetContextName (uint32_t context);
+  /**
+   * Draw the number of events until the next measured one.
+   *
+   * \returns A number uniformly distributed between 1 and twice the
+   *          sampling interval minus one.
+   */
+  uint32_t NextGap (void);
+
+  uint32_t m_samplingInterval;  //!< Measure one event out of this number.
+  uint32_t m_countdown;         //!< Events until the next measured one.
+  uint32_t m_state;             //!< State of the gap generator.
+  Costs m_costs;                //!< The recorded costs.
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
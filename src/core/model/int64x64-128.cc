@@ -35,87 +35,10 @@ namespace ns3 {
 // of causing recursions leading to stack overflow
 NS_LOG_COMPONENT_DEFINE ("int64x64-128");
 
-/**
- * \ingroup highprec
- * Compute the sign of the result of multiplying or dividing
- * Q64.64 fixed precision operands.
- *
- * \param [in]  sa The signed value of the first operand.
- * \param [in]  sb The signed value of the second operand.
- * \param [out] ua The unsigned magnitude of the first operand.
- * \param [out] ub The unsigned magnitude of the second operand.
- * \returns \c true if the result will be negative.
- */
-static inline  
-bool
-output_sign (const int128_t sa,
-             const int128_t sb,
-             uint128_t & ua,
-             uint128_t & ub)
-{
-  bool negA = sa < 0;
-  bool negB = sb < 0;
-  ua = negA ? -sa : sa;
-  ub = negB ? -sb : sb;
-  return (negA && !negB) || (!negA && negB);
-}
-
-void
-int64x64_t::Mul (const int64x64_t & o)
-{
-  uint128_t a, b;
-  bool negative = output_sign (_v, o._v, a, b);
-  uint128_t result = Umul (a, b);
-  _v = negative ? -result : result;
-}
-
-uint128_t
-int64x64_t::Umul (const uint128_t a, const uint128_t b)
-{
-  uint128_t aL = a & HP_MASK_LO;
-  uint128_t bL = b & HP_MASK_LO;
-  uint128_t aH = (a >> 64) & HP_MASK_LO;
-  uint128_t bH = (b >> 64) & HP_MASK_LO;
-
-  uint128_t result;
-  uint128_t hiPart, loPart, midPart;
-  uint128_t res1, res2;
-
-  // Multiplying (a.h 2^64 + a.l) x (b.h 2^64 + b.l) =
-  //			2^128 a.h b.h + 2^64*(a.h b.l+b.h a.l) + a.l b.l
-  // get the low part a.l b.l
-  // multiply the fractional part
-  loPart = aL * bL;
-  // compute the middle part 2^64*(a.h b.l+b.h a.l)
-  midPart = aL * bH + aH * bL;
-  // compute the high part 2^128 a.h b.h
-  hiPart = aH * bH;
-  // if the high part is not zero, put a warning
-  NS_ABORT_MSG_IF ((hiPart & HP_MASK_HI) != 0,
-                   "High precision 128 bits multiplication error: multiplication overflow.");
-  
-  // Adding 64-bit terms to get 128-bit results, with carries
-  res1 = loPart >> 64;
-  res2 = midPart & HP_MASK_LO;
-  result = res1 + res2;
-
-  res1 = midPart >> 64;
-  res2 = hiPart & HP_MASK_LO;
-  res1 += res2;
-  res1 <<= 64;
-
-  result += res1;
-
-  return result;
-}
-
 void
-int64x64_t::Div (const int64x64_t & o)
+int64x64_t::MulOverflow (void)
 {
-  uint128_t a, b;
-  bool negative = output_sign (_v, o._v, a, b);
-  int128_t result = Udiv (a, b);
-  _v = negative ? -result : result;
+  NS_ABORT_MSG ("High precision 128 bits multiplication error: multiplication overflow.");
 }
 
 uint128_t
@@ -128,6 +51,13 @@ int64x64_t::Udiv (const uint128_t a, const uint128_t b)
   rem = rem % den;
   uint128_t result = quo;
 
+  if (rem <= HP_MASK_LO)
+    {
+      // The shifted remainder fits: finish with a single native division.
+      // (This is always the case for divisors smaller than 2^64.)
+      return (result << 64) + (rem << 64) / den;
+    }
+
   // Now, manage the remainder
   const uint64_t DIGITS = 64;  // Number of fraction digits (bits) we need
   const uint128_t ZERO = 0;
@@ -187,32 +117,6 @@ int64x64_t::Udiv (const uint128_t a, const uint128_t b)
   return result;
 }
 
-void 
-int64x64_t::MulByInvert (const int64x64_t & o)
-{
-  bool negResult = _v < 0;
-  uint128_t a = negResult ? -_v : _v;
-  uint128_t result = UmulByInvert (a, o._v);
-
-  _v = negResult ? -result : result;
-}
-
-uint128_t
-int64x64_t::UmulByInvert (const uint128_t a, const uint128_t b)
-{
-  uint128_t result, ah, bh, al, bl;
-  uint128_t hi, mid;
-  ah = a >> 64;
-  bh = b >> 64;
-  al = a & HP_MASK_LO;
-  bl = b & HP_MASK_LO;
-  hi = ah * bh;
-  mid = ah * bl + al * bh;
-  mid >>= 64;
-  result = hi + mid;
-  return result;
-}
-
 int64x64_t 
 int64x64_t::Invert (const uint64_t v)
 {
@@ -50,6 +50,13 @@ class int64x64_t
   static const uint64_t    HP_MASK_LO = 0xffffffffffffffffULL;
   /// Mask for sign + integer part.
   static const uint64_t    HP_MASK_HI = ~HP_MASK_LO;
+  /**
+   * The Q64.64 representation of 1.
+   *
+   * The signed integer constructors multiply by this value rather than
+   * shift, since shifting a negative value is not a constant expression.
+   */
+  static constexpr int128_t HP_ONE = ((int128_t)1) << 64;
   /**
    * Floating point value of HP_MASK_LO + 1.
    * We really want:
@@ -83,7 +90,7 @@ public:
   static const enum impl_type implementation = int128_impl;
 
   /// Default constructor.
-  inline int64x64_t ()
+  inline constexpr int64x64_t ()
     : _v (0)  {}
   /**
    * \name Construct from a floating point value.
@@ -132,36 +139,18 @@ public:
    * \param [in] v Integer value to represent.
    */
   /**@{*/
-  inline int64x64_t (const int v)
-    : _v (v)
-  {
-    _v <<= 64;
-  }
-  inline int64x64_t (const long int v)
-    : _v (v) 
-  {
-    _v <<= 64;
-  }
-  inline int64x64_t (const long long int v)
-    : _v (v) 
-  {
-    _v <<= 64;
-  }
-  inline int64x64_t (const unsigned int v)
-    : _v (v)
-  {
-    _v <<= 64;
-  }
-  inline int64x64_t (const unsigned long int v)
-    : _v (v) 
-  {
-    _v <<= 64;
-  }
-  inline int64x64_t (const unsigned long long int v)
-    : _v (v) 
-  {
-    _v <<= 64;
-  }
+  inline constexpr int64x64_t (const int v)
+    : _v ((int128_t)v * HP_ONE)  {}
+  inline constexpr int64x64_t (const long int v)
+    : _v ((int128_t)v * HP_ONE)  {}
+  inline constexpr int64x64_t (const long long int v)
+    : _v ((int128_t)v * HP_ONE)  {}
+  inline constexpr int64x64_t (const unsigned int v)
+    : _v ((uint128_t)v << 64)  {}
+  inline constexpr int64x64_t (const unsigned long int v)
+    : _v ((uint128_t)v << 64)  {}
+  inline constexpr int64x64_t (const unsigned long long int v)
+    : _v ((uint128_t)v << 64)  {}
   /**@}*/
   
   /**
@@ -170,18 +159,15 @@ public:
    * \param [in] hi Integer portion.
    * \param [in] lo Fractional portion, already scaled to HP_MAX_64.
    */
-  explicit inline int64x64_t (const int64_t hi, const uint64_t lo)
-  {
-    _v = (int128_t)hi << 64;
-    _v |= lo;
-  }
+  explicit inline constexpr int64x64_t (const int64_t hi, const uint64_t lo)
+    : _v ((int128_t)hi * HP_ONE + lo)  {}
 
   /**
    * Copy constructor.
    *
    * \param [in] o Value to copy.
    */
-  inline int64x64_t (const int64x64_t & o)
+  inline constexpr int64x64_t (const int64x64_t & o)
     : _v (o._v) {}
   /**
    * Assignment.
@@ -240,7 +226,7 @@ public:
    *
    * \see Invert()
    */
-  void MulByInvert (const int64x64_t & o);
+  inline void MulByInvert (const int64x64_t & o);
 
   /**
    * Compute the inverse of an integer value.
@@ -277,13 +263,40 @@ private:
    *
    * \param [in] o The other factor.
    */   
-  void Mul (const int64x64_t & o);
+  inline void Mul (const int64x64_t & o);
   /**
    * Implement `/=`.
    *
    * \param [in] o The divisor.
    */
-  void Div (const int64x64_t & o);
+  inline void Div (const int64x64_t & o);
+  /**
+   * Compute the sign of the result of multiplying or dividing
+   * Q64.64 fixed precision operands, without branches.
+   *
+   * \param [in]  sa The signed value of the first operand.
+   * \param [in]  sb The signed value of the second operand.
+   * \param [out] ua The unsigned magnitude of the first operand.
+   * \param [out] ub The unsigned magnitude of the second operand.
+   * \returns A mask with all bits set if the result will be negative,
+   *          zero otherwise.
+   */
+  static inline uint128_t OutputSign (const int128_t sa, const int128_t sb,
+                                      uint128_t & ua, uint128_t & ub);
+  /**
+   * Apply a sign mask computed by OutputSign() to an unsigned magnitude.
+   *
+   * \param [in] v The magnitude.
+   * \param [in] mask The sign mask.
+   * \returns The signed value.
+   */
+  static inline int128_t ApplySign (const uint128_t v, const uint128_t mask);
+  /**
+   * Abort on a multiplication overflow.
+   *
+   * This is kept out of line so that the inline multiplication stays small.
+   */
+  static void MulOverflow (void);
   /**
    * Unsigned multiplication of Q64.64 values.
    *
@@ -308,10 +321,14 @@ private:
    * high and low 64 bits.  To achieve this, we carry out the multiplication
    * explicitly with 64-bit operands and 128-bit intermediate results.
    */
-  static uint128_t Umul         (const uint128_t a, const uint128_t b);
+  static inline uint128_t Umul (const uint128_t a, const uint128_t b);
   /**
    * Unsigned division of Q64.64 values.
    *
+   * Div() handles divisors without a fractional part, such as the
+   * ratio of two Time values, with a single native division; this
+   * handles the other divisors.
+   *
    * \param [in] a Numerator.
    * \param [in] b Denominator.
    * \return The Q64.64 representation of `a / b`.
@@ -326,14 +343,14 @@ private:
    *
    * \see Invert()
    */
-  static uint128_t UmulByInvert (const uint128_t a, const uint128_t b);
+  static inline uint128_t UmulByInvert (const uint128_t a, const uint128_t b);
 
   /**
    * Construct from an integral type.
    *
    * \param [in] v Integer value to represent.
    */
-  inline int64x64_t (const int128_t v)
+  inline constexpr int64x64_t (const int128_t v)
     : _v (v) {}
 
   int128_t _v;  //!< The Q64.64 value.
@@ -341,6 +358,91 @@ private:
 };  // class int64x64_t
 
 
+inline uint128_t
+int64x64_t::OutputSign (const int128_t sa, const int128_t sb,
+                        uint128_t & ua, uint128_t & ub)
+{
+  // All ones if negative, zero otherwise.
+  const uint128_t maskA = -(uint128_t)(sa < 0);
+  const uint128_t maskB = -(uint128_t)(sb < 0);
+  ua = ((uint128_t)sa ^ maskA) - maskA;
+  ub = ((uint128_t)sb ^ maskB) - maskB;
+  return maskA ^ maskB;
+}
+
+inline int128_t
+int64x64_t::ApplySign (const uint128_t v, const uint128_t mask)
+{
+  return (v ^ mask) - mask;
+}
+
+inline void
+int64x64_t::Mul (const int64x64_t & o)
+{
+  uint128_t a, b;
+  const uint128_t sign = OutputSign (_v, o._v, a, b);
+  _v = ApplySign (Umul (a, b), sign);
+}
+
+inline uint128_t
+int64x64_t::Umul (const uint128_t a, const uint128_t b)
+{
+  const uint128_t aL = a & HP_MASK_LO;
+  const uint128_t bL = b & HP_MASK_LO;
+  const uint128_t aH = a >> 64;
+  const uint128_t bH = b >> 64;
+
+  // Multiplying (a.h 2^64 + a.l) x (b.h 2^64 + b.l) =
+  //			2^128 a.h b.h + 2^64*(a.h b.l+b.h a.l) + a.l b.l
+  // We keep the middle 128 bits: the high 64 bits of a.l b.l,
+  // the middle part, and the low 64 bits of a.h b.h.
+  const uint128_t hiPart = aH * bH;
+  if (hiPart & HP_MASK_HI)
+    {
+      MulOverflow ();
+    }
+  return ((aL * bL) >> 64) + aL * bH + aH * bL + (hiPart << 64);
+}
+
+inline void
+int64x64_t::Div (const int64x64_t & o)
+{
+  uint128_t a, b;
+  const uint128_t sign = OutputSign (_v, o._v, a, b);
+  uint128_t result;
+  if ((b & HP_MASK_LO) == 0)
+    {
+      // (a 2^64) / (b.h 2^64) = a / b.h
+      result = a / (b >> 64);
+    }
+  else
+    {
+      result = Udiv (a, b);
+    }
+  _v = ApplySign (result, sign);
+}
+
+inline void
+int64x64_t::MulByInvert (const int64x64_t & o)
+{
+  const uint128_t sign = -(uint128_t)(_v < 0);
+  const uint128_t a = ApplySign (_v, sign);
+  _v = ApplySign (UmulByInvert (a, o._v), sign);
+}
+
+inline uint128_t
+int64x64_t::UmulByInvert (const uint128_t a, const uint128_t b)
+{
+  const uint128_t ah = a >> 64;
+  const uint128_t bh = b >> 64;
+  const uint128_t al = a & HP_MASK_LO;
+  const uint128_t bl = b & HP_MASK_LO;
+  const uint128_t hi = ah * bh;
+  const uint128_t mid = (ah * bl + al * bh) >> 64;
+  return hi + mid;
+}
+
+
 /**
  * \ingroup highprec
  * Equality operator.
@@ -120,7 +120,16 @@ int64x64_t::Div (const int64x64_t & o)
 {
   cairo_uint128_t a, b;
   bool sign = output_sign (_v, o._v, a, b);
-  cairo_uint128_t result = Udiv (a, b);
+  cairo_uint128_t result;
+  if (b.lo == 0)
+    {
+      // (a 2^64) / (b.h 2^64) = a / b.h
+      result = _cairo_uint128_divrem (a, _cairo_uint64_to_uint128 (b.hi)).quo;
+    }
+  else
+    {
+      result = Udiv (a, b);
+    }
   _v = sign ? _cairo_uint128_negate (result) : result;
 }
 
@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Buckets holding more events than this are spread over a new rung
+ * rather than moved to Bottom.
+ */
+const uint32_t LADDER_THRESHOLD = 50;
+/** \ingroup scheduler Maximum number of rungs of the ladder. */
+const uint32_t LADDER_MAX_RUNGS = 8;
+/** \ingroup scheduler Maximum number of buckets in a rung. */
+const uint64_t LADDER_MAX_BUCKETS = 65536;
+
+/**
+ * \ingroup scheduler
+ * Comparison functor turning the std heap algorithms into a min-heap.
+ */
+struct EventGreater
+{
+  /**
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \returns \c true if \p a expires after \p b.
+   */
+  bool operator () (const Scheduler::Event &a, const Scheduler::Event &b) const
+  {
+    return b < a;
+  }
+};
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (LADDER_MAX_RUNGS),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.m_start + rung.m_current * rung.m_width;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::AddRung (uint64_t start, uint64_t end, uint32_t nEvents)
+{
+  NS_LOG_FUNCTION (this << start << end << nEvents);
+  NS_ASSERT (m_nRungs < LADDER_MAX_RUNGS);
+  NS_ASSERT (end > start && nEvents > 0);
+  uint64_t span = end - start;
+  uint64_t width = std::max<uint64_t> (1, (span + nEvents - 1) / nEvents);
+  if ((span + width - 1) / width > LADDER_MAX_BUCKETS)
+    {
+      width = (span + LADDER_MAX_BUCKETS - 1) / LADDER_MAX_BUCKETS;
+    }
+  Rung &rung = m_rungs[m_nRungs];
+  m_nRungs++;
+  rung.m_nBuckets = static_cast<uint32_t> ((span + width - 1) / width);
+  rung.m_start = start;
+  rung.m_width = width;
+  rung.m_current = 0;
+  if (rung.m_buckets.size () < rung.m_nBuckets)
+    {
+      rung.m_buckets.resize (rung.m_nBuckets);
+    }
+  return rung;
+}
+
+void
+LadderScheduler::InsertInRung (Rung &rung, const Scheduler::Event &ev)
+{
+  uint64_t bucket = (ev.key.m_ts - rung.m_start) / rung.m_width;
+  NS_ASSERT (bucket >= rung.m_current && bucket < rung.m_nBuckets);
+  rung.m_buckets[bucket].push_back (ev);
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_nRungs == 0 && !m_top.empty ());
+  Rung &rung = AddRung (m_topMin, m_topMax + 1, m_top.size ());
+  for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+    {
+      InsertInRung (rung, *i);
+    }
+  m_top.clear ();
+  m_topStart = rung.m_start + rung.m_nBuckets * rung.m_width;
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          if (m_top.empty ())
+            {
+              return;
+            }
+          TransferTop ();
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.m_current < rung.m_nBuckets
+             && rung.m_buckets[rung.m_current].empty ())
+        {
+          rung.m_current++;
+        }
+      if (rung.m_current == rung.m_nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      uint64_t start = GetCurrentStart (rung);
+      Bucket &bucket = rung.m_buckets[rung.m_current];
+      rung.m_current++;
+      if (bucket.size () > LADDER_THRESHOLD
+          && rung.m_width > 1
+          && m_nRungs < LADDER_MAX_RUNGS)
+        {
+          Rung &child = AddRung (start, start + rung.m_width, bucket.size ());
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              InsertInRung (child, *i);
+            }
+          bucket.clear ();
+        }
+      else
+        {
+          m_bottom.swap (bucket);
+          std::make_heap (m_bottom.begin (), m_bottom.end (), EventGreater ());
+        }
+    }
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (m_qSize == 0)
+    {
+      // Every bucket is empty: start again from scratch.
+      m_nRungs = 0;
+      m_topStart = 0;
+    }
+  m_qSize++;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; ++i)
+    {
+      if (ts >= GetCurrentStart (m_rungs[i]))
+        {
+          InsertInRung (m_rungs[i], ev);
+          return;
+        }
+    }
+  m_bottom.push_back (ev);
+  std::push_heap (m_bottom.begin (), m_bottom.end (), EventGreater ());
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // Filling Bottom does not change the content of the queue.
+  const_cast<LadderScheduler *> (this)->FillBottom ();
+  return m_bottom.front ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  FillBottom ();
+  std::pop_heap (m_bottom.begin (), m_bottom.end (), EventGreater ());
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  NS_LOG_DEBUG ("remove " << ev.impl << " at " << ev.key.m_ts);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = &m_bottom;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      for (uint32_t i = 0; i < m_nRungs; ++i)
+        {
+          Rung &rung = m_rungs[i];
+          if (ts >= GetCurrentStart (rung))
+            {
+              bucket = &rung.m_buckets[(ts - rung.m_start) / rung.m_width];
+              break;
+            }
+        }
+    }
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          *i = bucket->back ();
+          bucket->pop_back ();
+          if (bucket == &m_bottom)
+            {
+              std::make_heap (m_bottom.begin (), m_bottom.end (), EventGreater ());
+            }
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
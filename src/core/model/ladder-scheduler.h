@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by W. T. Tang, R. S. M. Goh and
+ * I. L.-J. Thng (ACM TOMACS, 2005).
+ *
+ * Events are kept in three tiers:
+ *  - Top, an unsorted array receiving all the events later than
+ *    any event in the lower tiers, so that inserting far-future
+ *    events is O(1);
+ *  - the Ladder, a stack of rungs of unsorted buckets.  The first rung
+ *    is created from the whole Top with a bucket width adapted to the
+ *    spread of the events it contains; each time a bucket holding too
+ *    many events reaches the front of the queue, it is spread over a
+ *    new, finer, rung instead of being sorted;
+ *  - Bottom, a small binary heap holding the content of the earliest
+ *    bucket, from which the events are removed.
+ *
+ * Unlike CalendarScheduler, this scheduler never resizes its whole
+ * content at once: each event is moved at most a bounded number of
+ * times from Top to Bottom, which gives an amortized O(1) cost for
+ * Insert and RemoveNext.  Remove is O(1) on average for events in the
+ * Ladder or in Bottom, but linear in the size of Top for far-future
+ * events.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Ladder bucket type: an unsorted array of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    /** The buckets; only the first m_nBuckets are in use. */
+    std::vector<Bucket> m_buckets;
+    /** Number of buckets in use. */
+    uint32_t m_nBuckets;
+    /** Time stamp at the start of the first bucket. */
+    uint64_t m_start;
+    /** Duration of a bucket, in dimensionless time units. */
+    uint64_t m_width;
+    /** Index of the first bucket which has not been dequeued yet. */
+    uint32_t m_current;
+  };
+
+  /**
+   * Get the time stamp at the start of the current bucket of a rung.
+   *
+   * Events earlier than this time stamp belong to a lower rung,
+   * or to Bottom.
+   *
+   * \param [in] rung The rung.
+   * \returns The time stamp at the start of the current bucket.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /**
+   * Start a new rung at the end of the ladder.
+   *
+   * \param [in] start The time stamp at the start of the rung.
+   * \param [in] end The time stamp at the end of the rung, exclusive.
+   * \param [in] nEvents The number of events to spread on the rung.
+   * \returns The new rung.
+   */
+  Rung &AddRung (uint64_t start, uint64_t end, uint32_t nEvents);
+  /**
+   * Insert an event in the bucket of a rung matching its time stamp.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ev The event to insert.
+   */
+  static void InsertInRung (Rung &rung, const Scheduler::Event &ev);
+  /** Move the content of Top to a new first rung. */
+  void TransferTop (void);
+  /** Move the earliest bucket of the ladder to Bottom, if Bottom is empty. */
+  void FillBottom (void);
+
+  /** The Top tier. */
+  Bucket m_top;
+  /** Smallest time stamp in Top. */
+  uint64_t m_topMin;
+  /** Largest time stamp in Top. */
+  uint64_t m_topMax;
+  /** Events with a time stamp at least equal to this one go to Top. */
+  uint64_t m_topStart;
+  /** The rungs, including the unused ones kept for reuse. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** The Bottom tier, a min-heap. */
+  Bucket m_bottom;
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -22,6 +22,7 @@
 #include "assert.h"
 #include "abort.h"
 #include "names.h"
+#include "replication-runner.h"
 #include "singleton.h"
 
 /**
@@ -249,6 +250,15 @@ public:
    */
   Ptr<Object> Find (Ptr<Object> context, std::string name);
 
+  /**
+   * Get the instance used by the calling thread.
+   *
+   * Each replication run by a ReplicationRunner has its own names.
+   *
+   * \returns The instance.
+   */
+  static NamesPriv *Get (void);
+
 private:
   friend class Names;
 
@@ -275,6 +285,17 @@ private:
   std::map<Ptr<Object>, NameNode *> m_objectMap;
 };
 
+NamesPriv *
+NamesPriv::Get (void)
+{
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      static thread_local NamesPriv names;
+      return &names;
+    }
+  return Singleton<NamesPriv>::Get ();
+}
+
 NamesPriv::NamesPriv ()
 {
   NS_LOG_FUNCTION (this);
@@ -460,6 +460,11 @@ public:
   inline static Time From (const int64x64_t & value, enum Unit unit)
   {
     struct Information *info = PeekInformation (unit);
+    if (info->fromMul && value.GetLow () == 0)
+      {
+        // Integer value in a coarser unit: no rounding needed.
+        return Time (CheckedMultiply (value.GetHigh (), info->factor));
+      }
     // DO NOT REMOVE this temporary variable. It's here
     // to work around a compiler bug in gcc 3.4
     int64x64_t retval = value;
@@ -509,15 +514,13 @@ public:
   inline int64x64_t To (enum Unit unit) const
   {
     struct Information *info = PeekInformation (unit);
-    int64x64_t retval = int64x64_t (m_data);
     if (info->toMul)
       {
-        retval *= info->timeTo;
-      }
-    else
-      {
-        retval.MulByInvert (info->timeTo);
+        // Finer unit: the value is an exact integer.
+        return int64x64_t (CheckedMultiply (m_data, info->factor));
       }
+    int64x64_t retval = int64x64_t (m_data);
+    retval.MulByInvert (info->timeTo);
     return retval;
   }
   /**@}*/
@@ -590,6 +593,30 @@ private:
     return & (PeekResolution ()->info[timeUnit]);
   }
 
+  /**
+   *  Multiply two integers, aborting on an overflow as the int64x64_t
+   *  multiplication does.
+   *
+   *  \param [in] a The first factor
+   *  \param [in] b The second factor
+   *  \return The product
+   */
+  static inline int64_t CheckedMultiply (int64_t a, int64_t b)
+  {
+    int64_t product;
+    if (__builtin_mul_overflow (a, b, &product))
+      {
+        MulOverflow ();
+      }
+    return product;
+  }
+  /**
+   *  Abort on a multiplication overflow.
+   *
+   *  This is kept out of line so that the inline multiplication stays small.
+   */
+  static void MulOverflow (void);
+
   /**
    *  Set the default resolution
    *
@@ -882,6 +909,11 @@ operator * (const int64_t & lhs, const Time & rhs)
 inline Time
 operator * (const Time & lhs, const int64x64_t & rhs)
 {
+  if (rhs.GetLow () == 0)
+    {
+      // Integer scaling: the product is exact in 64 bits.
+      return Time (Time::CheckedMultiply (lhs.m_data, rhs.GetHigh ()));
+    }
   int64x64_t res = lhs.m_data;
   res *= rhs;
   return Time (res);
@@ -936,6 +968,19 @@ operator / (const Time & lhs, const int64_t & rhs)
 inline Time
 operator / (const Time & lhs, const int64x64_t & rhs)
 {
+  if (rhs.GetLow () == 0 && rhs.GetHigh () > 0)
+    {
+      // Integer scaling: round towards negative infinity, like the
+      // conversion of an int64x64_t quotient to Time.  A positive
+      // divisor cannot overflow.
+      const int64_t div = rhs.GetHigh ();
+      int64_t quo = lhs.m_data / div;
+      if ((lhs.m_data % div != 0) && (lhs.m_data < 0))
+        {
+          --quo;
+        }
+      return Time (quo);
+    }
   int64x64_t res = lhs.m_data;
   res /= rhs;
   return Time (res);
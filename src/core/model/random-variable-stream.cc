@@ -131,6 +131,22 @@ RandomVariableStream::GetStream(void) const
   return m_stream;
 }
 
+void
+RandomVariableStream::GetRngState (double state[6]) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_rng != 0);
+  m_rng->GetState (state);
+}
+
+void
+RandomVariableStream::SetRngState (const double state[6])
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_rng != 0);
+  m_rng->SetState (state);
+}
+
 RngStream *
 RandomVariableStream::Peek(void) const
 {
@@ -149,6 +149,18 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the current state of the underlying RngStream.
+   * \param [out] state The six components of the state vector.
+   */
+  void GetRngState (double state[6]) const;
+  /**
+   * \brief Set the current state of the underlying RngStream.
+   * \param [in] state The six components of the state vector, as
+   *             returned by GetRngState().
+   */
+  void SetRngState (const double state[6]);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "replication-runner.h"
+#include "rng-seed-manager.h"
+#include "simulator.h"
+#include "names.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ReplicationRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReplicationRunner");
+
+namespace {
+
+/** \ingroup simulator The last replication key allocated. */
+std::atomic<uint64_t> g_lastReplicationKey (0);
+/** \ingroup simulator The key of the replication run by this thread. */
+thread_local uint64_t g_replicationKey = 0;
+/** \ingroup simulator The index of the replication run by this thread. */
+thread_local uint32_t g_replication = 0;
+/** \ingroup simulator The runner of the replication run by this thread. */
+thread_local ReplicationRunner *g_runner = 0;
+
+} // unnamed namespace
+
+ReplicationRunner::ReplicationRunner ()
+  : m_threadCount (0),
+    m_hasFirstRun (false),
+    m_firstRun (0),
+    m_replications (0),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ReplicationRunner::SetThreadCount (uint32_t threads)
+{
+  NS_LOG_FUNCTION (this << threads);
+  m_threadCount = threads;
+}
+
+void
+ReplicationRunner::SetFirstRun (uint64_t run)
+{
+  NS_LOG_FUNCTION (this << run);
+  m_hasFirstRun = true;
+  m_firstRun = run;
+}
+
+void
+ReplicationRunner::Run (uint32_t replications, Replication replication)
+{
+  NS_LOG_FUNCTION (this << replications);
+  NS_ASSERT_MSG (!IsReplicationThread (), "Nested replications are not supported");
+  if (!m_hasFirstRun)
+    {
+      m_firstRun = RngSeedManager::GetRun ();
+    }
+  m_replication = replication;
+  m_replications = replications;
+  m_next = 0;
+  m_results.clear ();
+
+  uint32_t threadCount = m_threadCount;
+  if (threadCount == 0)
+    {
+      threadCount = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  threadCount = std::min (threadCount, replications);
+  // SystemThread is only available when ns-3 is built with threading
+  // support, while the simulator needs this class in every build.
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < threadCount; ++i)
+    {
+      threads.push_back (std::thread (&ReplicationRunner::RunReplications, this));
+    }
+  RunReplications ();
+  for (std::vector<std::thread>::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      i->join ();
+    }
+  m_replication = Replication ();
+}
+
+void
+ReplicationRunner::RunReplications (void)
+{
+  g_runner = this;
+  while (true)
+    {
+      uint32_t replication;
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        if (m_next == m_replications)
+          {
+            break;
+          }
+        replication = m_next;
+        m_next++;
+      }
+      NS_LOG_LOGIC ("start replication " << replication);
+      g_replicationKey = ++g_lastReplicationKey;
+      g_replication = replication;
+      RngSeedManager::SetRun (m_firstRun + replication);
+      m_replication (replication);
+      Simulator::Destroy ();
+      Names::Clear ();
+      g_replicationKey = 0;
+    }
+  g_runner = 0;
+}
+
+void
+ReplicationRunner::Record (std::string name, double value)
+{
+  NS_ASSERT_MSG (IsReplicationThread (), "ReplicationRunner::Record called outside a replication");
+  g_runner->DoRecord (g_replication, name, value);
+}
+
+void
+ReplicationRunner::DoRecord (uint32_t replication, std::string name, double value)
+{
+  NS_LOG_FUNCTION (this << replication << name << value);
+  std::lock_guard<std::mutex> lock (m_mutex);
+  m_results[name][replication] = value;
+}
+
+bool
+ReplicationRunner::IsReplicationThread (void)
+{
+  return g_replicationKey != 0;
+}
+
+uint64_t
+ReplicationRunner::GetReplicationKey (void)
+{
+  return g_replicationKey;
+}
+
+uint32_t
+ReplicationRunner::GetReplication (void)
+{
+  NS_ASSERT (IsReplicationThread ());
+  return g_replication;
+}
+
+std::vector<std::string>
+ReplicationRunner::GetNames (void) const
+{
+  std::vector<std::string> names;
+  for (std::map<std::string, std::map<uint32_t, double> >::const_iterator i = m_results.begin ();
+       i != m_results.end (); ++i)
+    {
+      names.push_back (i->first);
+    }
+  return names;
+}
+
+std::vector<double>
+ReplicationRunner::GetValues (std::string name) const
+{
+  std::vector<double> values;
+  std::map<std::string, std::map<uint32_t, double> >::const_iterator result = m_results.find (name);
+  if (result != m_results.end ())
+    {
+      for (std::map<uint32_t, double>::const_iterator i = result->second.begin ();
+           i != result->second.end (); ++i)
+        {
+          values.push_back (i->second);
+        }
+    }
+  return values;
+}
+
+double
+ReplicationRunner::GetMean (std::string name) const
+{
+  std::vector<double> values = GetValues (name);
+  if (values.empty ())
+    {
+      return 0;
+    }
+  double sum = 0;
+  for (std::vector<double>::const_iterator i = values.begin (); i != values.end (); ++i)
+    {
+      sum += *i;
+    }
+  return sum / values.size ();
+}
+
+double
+ReplicationRunner::GetStandardDeviation (std::string name) const
+{
+  std::vector<double> values = GetValues (name);
+  if (values.size () < 2)
+    {
+      return 0;
+    }
+  double mean = GetMean (name);
+  double sum = 0;
+  for (std::vector<double>::const_iterator i = values.begin (); i != values.end (); ++i)
+    {
+      sum += (*i - mean) * (*i - mean);
+    }
+  return std::sqrt (sum / (values.size () - 1));
+}
+
+void
+ReplicationRunner::Print (std::ostream &os) const
+{
+  for (std::map<std::string, std::map<uint32_t, double> >::const_iterator i = m_results.begin ();
+       i != m_results.end (); ++i)
+    {
+      os << i->first << ": " << i->second.size () << " values, mean " << GetMean (i->first)
+         << ", standard deviation " << GetStandardDeviation (i->first) << std::endl;
+    }
+}
+
+} // namespace ns3
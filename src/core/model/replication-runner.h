@@ -0,0 +1,202 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef REPLICATION_RUNNER_H
+#define REPLICATION_RUNNER_H
+
+#include "callback.h"
+#include <stdint.h>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ReplicationRunner declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief Run independent replications of a simulation on parallel
+ * threads of the same process.
+ *
+ * Each replication is a call to a user function, which builds the
+ * topology of the simulation, runs it and records its results with
+ * Record().  The replications are distributed over the threads, and
+ * each of them sees its own copy of the per-simulation state of ns-3:
+ *  - the simulator implementation, used by all the Simulator methods;
+ *  - the NodeList, the ChannelList and the Names;
+ *  - the objects of the Config root namespace, so that Config::Set
+ *    and Config::Connect only reach the objects of the replication;
+ *  - the SimulationSingleton instances, such as the IPv4 and IPv6
+ *    address generators;
+ *  - the RngSeedManager run number, which is the first run number
+ *    plus the index of the replication, and the automatic stream
+ *    index;
+ *  - the packet uid counter.
+ *
+ * The replications hence produce the same results as separate runs of
+ * the same program with the matching RngRun values, whatever the
+ * number of threads.  The rest of the state of ns-3 is shared by all
+ * the replications: the TypeId registry, the attribute default values
+ * and the global values must not be changed while the replications run,
+ * and the models must not use other static variables.  The read-only
+ * objects shared by reference counted pointers, such as spectrum models,
+ * are only safe when ns-3 is configured with --enable-mtp, which makes
+ * the reference counts atomic.
+ *
+ * \code
+ *   void RunOne (uint32_t replication)
+ *   {
+ *     // build the topology, then:
+ *     Simulator::Stop (Seconds (100));
+ *     Simulator::Run ();
+ *     ReplicationRunner::Record ("throughput", sink->GetTotalRx () * 8 / 100.0);
+ *   }
+ *
+ *   ReplicationRunner runner;
+ *   runner.Run (32, MakeCallback (&RunOne));
+ *   std::cout << runner.GetMean ("throughput") << std::endl;
+ * \endcode
+ */
+class ReplicationRunner
+{
+public:
+  /** The function running one replication, given its index. */
+  typedef Callback<void, uint32_t> Replication;
+
+  ReplicationRunner ();
+
+  /**
+   * Set the number of threads running the replications, including the
+   * calling thread.
+   *
+   * \param [in] threads The number of threads, or zero, the default,
+   *             to use one thread per hardware thread.
+   */
+  void SetThreadCount (uint32_t threads);
+  /**
+   * Set the run number of the first replication.
+   *
+   * \param [in] run The run number of replication 0; by default, the
+   *             value of RngSeedManager::GetRun() when Run() is called.
+   */
+  void SetFirstRun (uint64_t run);
+  /**
+   * Run replications, and wait for their end.
+   *
+   * Simulator::Destroy() and Names::Clear() are called at the end of
+   * each replication.
+   *
+   * \param [in] replications The number of replications.
+   * \param [in] replication The function running one replication.
+   */
+  void Run (uint32_t replications, Replication replication);
+
+  /**
+   * Record a result of the replication run by the calling thread.
+   *
+   * \param [in] name The name of the result.
+   * \param [in] value The value of the result, which replaces any value
+   *             recorded with the same name by the same replication.
+   */
+  static void Record (std::string name, double value);
+  /**
+   * \returns \c true if the calling thread is running a replication.
+   */
+  static bool IsReplicationThread (void);
+  /**
+   * Get a key identifying the replication run by the calling thread.
+   *
+   * The keys are unique within the process, so that the models can
+   * reset their per-replication state when the key changes.
+   *
+   * \returns The key of the replication, or 0 outside replications.
+   */
+  static uint64_t GetReplicationKey (void);
+  /**
+   * \returns The index of the replication run by the calling thread.
+   */
+  static uint32_t GetReplication (void);
+
+  /**
+   * \returns The names of the recorded results.
+   */
+  std::vector<std::string> GetNames (void) const;
+  /**
+   * Get the values of a result.
+   *
+   * \param [in] name The name of the result.
+   * \returns The values recorded by the replications, by increasing
+   *          replication index.
+   */
+  std::vector<double> GetValues (std::string name) const;
+  /**
+   * \param [in] name The name of the result.
+   * \returns The mean of the values of the result.
+   */
+  double GetMean (std::string name) const;
+  /**
+   * \param [in] name The name of the result.
+   * \returns The sample standard deviation of the values of the result.
+   */
+  double GetStandardDeviation (std::string name) const;
+  /**
+   * Print the number of values, the mean and the standard deviation of
+   * each result.
+   *
+   * \param [in] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /** Run replications until there are none left. */
+  void RunReplications (void);
+  /**
+   * Record a result.
+   *
+   * \param [in] replication The index of the replication.
+   * \param [in] name The name of the result.
+   * \param [in] value The value of the result.
+   */
+  void DoRecord (uint32_t replication, std::string name, double value);
+
+  /** The number of threads. */
+  uint32_t m_threadCount;
+  /** Whether the run number of the first replication was set. */
+  bool m_hasFirstRun;
+  /** The run number of the first replication. */
+  uint64_t m_firstRun;
+  /** The function running one replication. */
+  Replication m_replication;
+  /** The number of replications. */
+  uint32_t m_replications;
+  /** The index of the next replication to run. */
+  uint32_t m_next;
+  /** The results, by name and replication. */
+  std::map<std::string, std::map<uint32_t, double> > m_results;
+  /** Protect m_next and m_results. */
+  std::mutex m_mutex;
+};
+
+} // namespace ns3
+
+#endif /* REPLICATION_RUNNER_H */
@@ -23,6 +23,7 @@
 #include "uinteger.h"
 #include "config.h"
 #include "log.h"
+#include "replication-runner.h"
 
 /**
  * \file
@@ -40,6 +41,36 @@ NS_LOG_COMPONENT_DEFINE ("RngSeedManager");
  * for automatic assignment.
  */
 static uint64_t g_nextStreamIndex = 0;
+/**
+ * \relates RngSeedManager
+ * The random number generator state of the replication run by a
+ * ReplicationRunner thread.
+ */
+struct ReplicationRngState
+{
+  uint64_t key;              //!< The key of the replication.
+  uint64_t run;              //!< The run number.
+  uint64_t nextStreamIndex;  //!< The next stream number.
+};
+/**
+ * \relates RngSeedManager
+ * Get the random number generator state of the replication run by
+ * the calling thread.
+ * \returns The state, reset at the start of each replication.
+ */
+static ReplicationRngState *
+GetReplicationRngState (void)
+{
+  static thread_local ReplicationRngState state = { 0, 0, 0 };
+  uint64_t key = ReplicationRunner::GetReplicationKey ();
+  if (state.key != key)
+    {
+      state.key = key;
+      state.run = 1;
+      state.nextStreamIndex = 0;
+    }
+  return &state;
+}
 /**
  * \relates RngSeedManager
  * The random number generator seed number global value.  This is used to
@@ -85,12 +116,21 @@ RngSeedManager::SetSeed (uint32_t seed)
 void RngSeedManager::SetRun (uint64_t run)
 {
   NS_LOG_FUNCTION (run);
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      GetReplicationRngState ()->run = run;
+      return;
+    }
   Config::SetGlobal ("RngRun", UintegerValue (run));
 }
 
 uint64_t RngSeedManager::GetRun ()
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      return GetReplicationRngState ()->run;
+    }
   UintegerValue value;
   g_rngRun.GetValue (value);
   uint64_t run = value.Get();
@@ -100,9 +140,34 @@ uint64_t RngSeedManager::GetRun ()
 uint64_t RngSeedManager::GetNextStreamIndex (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      return GetReplicationRngState ()->nextStreamIndex++;
+    }
   uint64_t next = g_nextStreamIndex;
   g_nextStreamIndex++;
   return next;
 }
 
+uint64_t RngSeedManager::PeekNextStreamIndex (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      return GetReplicationRngState ()->nextStreamIndex;
+    }
+  return g_nextStreamIndex;
+}
+
+void RngSeedManager::SetNextStreamIndex (uint64_t index)
+{
+  NS_LOG_FUNCTION (index);
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      GetReplicationRngState ()->nextStreamIndex = index;
+      return;
+    }
+  g_nextStreamIndex = index;
+}
+
 } // namespace ns3
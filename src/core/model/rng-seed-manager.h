@@ -105,6 +105,19 @@ public:
    */
   static uint64_t GetNextStreamIndex(void);
 
+  /**
+   * Get the next automatically assigned stream index, without
+   * assigning it.
+   * \returns The next stream index.
+   */
+  static uint64_t PeekNextStreamIndex (void);
+
+  /**
+   * Set the next automatically assigned stream index.
+   * \param [in] index The next stream index.
+   */
+  static void SetNextStreamIndex (uint64_t index);
+
 };
 
 /** Alias for compatibility. */
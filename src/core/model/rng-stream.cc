@@ -374,6 +374,24 @@ RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
   AdvanceNthBy (substream, 76, m_currentState);
 }
 
+void
+RngStream::GetState (double state[6]) const
+{
+  for (int i = 0; i < 6; ++i)
+    {
+      state[i] = m_currentState[i];
+    }
+}
+
+void
+RngStream::SetState (const double state[6])
+{
+  for (int i = 0; i < 6; ++i)
+    {
+      m_currentState[i] = state[i];
+    }
+}
+
 RngStream::RngStream(const RngStream& r)
 {
   for (int i = 0; i < 6; ++i)
@@ -70,6 +70,19 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Get the current state of the generator.
+   *
+   * \param [out] state The six components of the state vector.
+   */
+  void GetState (double state[6]) const;
+  /**
+   * Set the current state of the generator.
+   *
+   * \param [in] state The six components of the state vector, as
+   *             returned by GetState().
+   */
+  void SetState (const double state[6]);
 
 private:
   /**
@@ -28,6 +28,9 @@
 #include "unused.h"
 #include <stdint.h>
 #include <limits>
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 /**
  * \file
@@ -115,11 +118,19 @@ public:
    */
   inline void Unref (void) const
   {
+#ifdef NS3_MTP
+    if (m_count.fetch_sub (1, std::memory_order_release) == 1)
+      {
+        std::atomic_thread_fence (std::memory_order_acquire);
+        DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
+      }
+#else
     m_count--;
     if (m_count == 0)
       {
         DELETER::Delete (static_cast<T*> (const_cast<SimpleRefCount *> (this)));
       }
+#endif
   }
 
   /**
@@ -139,9 +150,15 @@ private:
    *
    * \internal
    * Note we make this mutable so that the const methods can still
-   * change it.
+   * change it.  When ns-3 is configured with --enable-mtp, the count
+   * is atomic so that objects can be shared by the threads of
+   * ns3::MultithreadedSimulatorImpl.
    */
+#ifdef NS3_MTP
+  mutable std::atomic<uint32_t> m_count;
+#else
   mutable uint32_t m_count;
+#endif
 };
 
 } // namespace ns3
@@ -99,6 +99,7 @@ private:
  ********************************************************************/
 
 #include "simulator.h"
+#include "replication-runner.h"
 
 namespace ns3 {
 
@@ -115,12 +116,15 @@ T **
 SimulationSingleton<T>::GetObject (void)
 {
   static T *pobject = 0;
-  if (pobject == 0)
+  // Each replication run by a ReplicationRunner has its own instance.
+  static thread_local T *replicationObject = 0;
+  T **ppobject = ReplicationRunner::IsReplicationThread () ? &replicationObject : &pobject;
+  if (*ppobject == 0)
     {
-      pobject = new T ();
+      *ppobject = new T ();
       Simulator::ScheduleDestroy (&SimulationSingleton<T>::DeleteObject);
     }
-  return &pobject;
+  return ppobject;
 }
 
 template <typename T>
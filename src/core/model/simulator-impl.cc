@@ -42,4 +42,11 @@ SimulatorImpl::GetTypeId (void)
   return tid;
 }
 
+EventId
+SimulatorImpl::Reschedule (const EventId &id, const Time &delay)
+{
+  NS_LOG_FUNCTION (this << &id << delay);
+  return EventId ();
+}
+
 } // namespace ns3
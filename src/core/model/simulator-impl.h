@@ -75,6 +75,13 @@ public:
   virtual void Remove (const EventId &id) = 0;
   /** \copydoc Simulator::Cancel */
   virtual void Cancel (const EventId &id) = 0;
+  /**
+   * \copydoc Simulator::Reschedule
+   *
+   * The default implementation does not support moving events, and
+   * always returns an invalid EventId.
+   */
+  virtual EventId Reschedule (const EventId &id, const Time &delay);
   /** \copydoc Simulator::IsExpired */
   virtual bool IsExpired (const EventId &id) const = 0;
   /** \copydoc Simulator::Run */
@@ -31,6 +31,7 @@
 #include "global-value.h"
 #include "assert.h"
 #include "log.h"
+#include "replication-runner.h"
 
 #include <cmath>
 #include <fstream>
@@ -84,7 +85,9 @@ static GlobalValue g_schedTypeImpl = GlobalValue ("SchedulerType",
 static SimulatorImpl **PeekImpl (void)
 {
   static SimulatorImpl *impl = 0;
-  return &impl;
+  // Each replication run by a ReplicationRunner has its own simulator.
+  static thread_local SimulatorImpl *replicationImpl = 0;
+  return ReplicationRunner::IsReplicationThread () ? &replicationImpl : &impl;
 }
 
 /**
@@ -124,8 +127,11 @@ static SimulatorImpl * GetImpl (void)
 // Simulator::Now which would call Simulator::GetImpl, and, thus, get us 
 // in an infinite recursion until the stack explodes.
 //
-      LogSetTimePrinter (&DefaultTimePrinter);
-      LogSetNodePrinter (&DefaultNodePrinter);
+      if (!ReplicationRunner::IsReplicationThread ())
+        {
+          LogSetTimePrinter (&DefaultTimePrinter);
+          LogSetNodePrinter (&DefaultNodePrinter);
+        }
     }
   return *pimpl;
 }
@@ -145,8 +151,11 @@ Simulator::Destroy (void)
    * legal), Simulator::GetImpl will trigger again an infinite recursion until
    * the stack explodes.
    */
-  LogSetTimePrinter (0);
-  LogSetNodePrinter (0);
+  if (!ReplicationRunner::IsReplicationThread ())
+    {
+      LogSetTimePrinter (0);
+      LogSetNodePrinter (0);
+    }
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
@@ -296,6 +305,16 @@ Simulator::Cancel (const EventId &id)
   return GetImpl ()->Cancel (id);
 }
 
+EventId
+Simulator::Reschedule (const EventId &id, const Time &delay)
+{
+  if (*PeekImpl () == 0)
+    {
+      return EventId ();
+    }
+  return GetImpl ()->Reschedule (id, delay);
+}
+
 bool 
 Simulator::IsExpired (const EventId &id)
 {
@@ -1240,6 +1240,31 @@ public:
    */
   static void Cancel (const EventId &id);
 
+  /**
+   * Move a pending event to a new time, relative to the current time.
+   *
+   * This method has the same visible effect as cancelling the event,
+   * then scheduling again the same function with the same arguments
+   * in the current context, but it reuses the event instead of
+   * leaving a cancelled event in the event list and allocating a new
+   * one.  It is meant for timers which are restarted much more often
+   * than they expire.
+   *
+   * The event keeps its EventImpl, so all the copies of \p id refer
+   * to the moved event, but only the returned EventId holds its new
+   * time stamp: the other copies must not be used anymore.
+   *
+   * If the event has expired, or if the simulator implementation
+   * does not support moving events, nothing is done and an invalid
+   * EventId is returned: the caller must then cancel the event and
+   * schedule a new one.  This is what EventId::Reschedule does.
+   *
+   * @param [in] id The event to move.
+   * @param [in] delay The delay after which the event should expire.
+   * @returns The EventId of the moved event, or an invalid EventId.
+   */
+  static EventId Reschedule (const EventId &id, const Time &delay);
+
   /**
    * Check if an event has already run or been cancelled.
    *
@@ -165,6 +165,13 @@ Time::Time (const std::string& s)
     }
 }
 
+// static
+void
+Time::MulOverflow (void)
+{
+  NS_ABORT_MSG ("Time multiplication error: multiplication overflow.");
+}
+
 // static
 struct Time::Resolution
 Time::SetDefaultNsResolution (void)
@@ -173,6 +173,27 @@ Timer::Schedule (Time delay)
   m_event = m_impl->Schedule (delay);
 }
 
+void
+Timer::Reschedule (void)
+{
+  NS_LOG_FUNCTION (this);
+  Reschedule (m_delay);
+}
+
+void
+Timer::Reschedule (Time delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  NS_ASSERT (m_impl != 0);
+  if (!IsSuspended () && m_event.Reschedule (delay))
+    {
+      return;
+    }
+  m_event.Cancel ();
+  m_event = m_impl->Schedule (delay);
+  m_flags &= ~TIMER_SUSPENDED;
+}
+
 void
 Timer::Suspend (void)
 {
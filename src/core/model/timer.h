@@ -248,6 +248,25 @@ public:
    * Timer::SetDelay), function, and arguments.
    */
   void Schedule (Time delay);
+  /**
+   * Restart the timer using the currently-configured delay.
+   *
+   * \see Reschedule(Time)
+   */
+  void Reschedule (void);
+  /**
+   * \param [in] delay the delay to use
+   *
+   * Restart the timer using the specified delay (ignore the delay set by
+   * Timer::SetDelay).
+   *
+   * If the timer is running, its event is moved in the simulator
+   * event list with Simulator::Reschedule, and keeps the arguments
+   * it was scheduled with: restarting a timer does not allocate a
+   * new event nor leave a cancelled one behind.  Otherwise, this
+   * method is equivalent to Schedule(Time).
+   */
+  void Reschedule (Time delay);
 
   /**
    * Cancel the timer and save the amount of time left until it was
@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -93,6 +93,16 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check whether any Callback is connected.
+   *
+   * Invoking a TracedCallback without Callbacks does nothing, but
+   * the caller still computes the arguments: a trace source whose
+   * arguments are expensive to build can check this first.
+   *
+   * \returns \c true if no Callback is connected.
+   */
+  bool IsEmpty (void) const;
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -234,9 +244,27 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  typedef std::vector<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
+  /**
+   * Remove the Callbacks disconnected while the chain was invoked,
+   * once the outermost invocation returns.
+   */
+  void EndInvoke (void) const;
+  /**
+   * The chain of Callbacks.
+   *
+   * A Callback disconnected while the chain is invoked is replaced
+   * by a null Callback and erased by EndInvoke, so that the sinks
+   * following it keep their place in the chain.
+   */
+  mutable CallbackList m_callbackList;
+  /**
+   * The Callbacks disconnected during an invocation, kept alive
+   * until it returns since one of them may be running.
+   */
+  mutable CallbackList m_disconnected;
+  /** The depth of nested invocations of the chain. */
+  mutable uint32_t m_invoking;
 };
 
 } // namespace ns3
@@ -253,7 +281,9 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_callbackList (),
+    m_disconnected (),
+    m_invoking (0)
 {
 }
 template<typename T1, typename T2,
@@ -291,9 +321,18 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const Callbac
   for (typename CallbackList::iterator i = m_callbackList.begin ();
        i != m_callbackList.end (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if (!(*i).IsNull () && (*i).IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          if (m_invoking > 0)
+            {
+              m_disconnected.push_back (*i);
+              *i = Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> ();
+              i++;
+            }
+          else
+            {
+              i = m_callbackList.erase (i);
+            }
         }
       else
         {
@@ -314,6 +353,39 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Disconnect (const CallbackBase & callba
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
   DisconnectWithoutContext (realCb);
 }
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+bool
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::IsEmpty (void) const
+{
+  return m_callbackList.size () == m_disconnected.size ();
+}
+template<typename T1, typename T2, 
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void 
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::EndInvoke (void) const
+{
+  if (--m_invoking == 0 && !m_disconnected.empty ())
+    {
+      for (typename CallbackList::iterator i = m_callbackList.begin ();
+           i != m_callbackList.end (); /* empty */)
+        {
+          if ((*i).IsNull ())
+            {
+              i = m_callbackList.erase (i);
+            }
+          else
+            {
+              i++;
+            }
+        }
+      m_disconnected.clear ();
+    }
+}
 template<typename T1, typename T2, 
          typename T3, typename T4,
          typename T5, typename T6,
@@ -321,11 +393,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)();
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i]();
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -334,11 +412,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -347,11 +431,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -360,11 +450,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2, a3);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -373,11 +469,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2, a3, a4);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -386,11 +488,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -399,11 +507,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -412,11 +526,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7);
+        }
     }
+  EndInvoke ();
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -425,11 +545,17 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index the vector, since a Callback may connect another one,
+  // and skip the Callbacks disconnected during this invocation.
+  ++m_invoking;
+  for (std::size_t i = 0; i < m_callbackList.size (); ++i)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      if (!m_callbackList[i].IsNull ())
+        {
+          m_callbackList[i](a1, a2, a3, a4, a5, a6, a7, a8);
+        }
     }
+  EndInvoke ();
 }
 
 } // namespace ns3
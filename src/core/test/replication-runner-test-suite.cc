@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/replication-runner.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include "ns3/names.h"
+#include "ns3/object.h"
+
+using namespace ns3;
+
+class ReplicationRunnerTestCase : public TestCase
+{
+public:
+  ReplicationRunnerTestCase ();
+  virtual void DoRun (void);
+  void RunOne (uint32_t replication);
+  static void Count (uint32_t *count);
+};
+
+ReplicationRunnerTestCase::ReplicationRunnerTestCase ()
+  : TestCase ("Check that replications run in parallel are independent and reproducible")
+{
+}
+
+void
+ReplicationRunnerTestCase::Count (uint32_t *count)
+{
+  (*count)++;
+}
+
+void
+ReplicationRunnerTestCase::RunOne (uint32_t replication)
+{
+  // Names and random streams would collide if they were shared.
+  bool named = true;
+  Ptr<Object> object = CreateObject<Object> ();
+  Names::Add ("object", object);
+  named = Names::Find<Object> ("object") == object;
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      Simulator::Schedule (Seconds (random->GetValue (0, 10)), &ReplicationRunnerTestCase::Count, &count);
+    }
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  ReplicationRunner::Record ("count", count);
+  ReplicationRunner::Record ("time", Simulator::Now ().GetSeconds ());
+  ReplicationRunner::Record ("run", RngSeedManager::GetRun ());
+  ReplicationRunner::Record ("named", named);
+}
+
+void
+ReplicationRunnerTestCase::DoRun (void)
+{
+  // The simulation of the main thread is not touched by the replications.
+  EventId pending = Simulator::Schedule (Seconds (1), &ReplicationRunnerTestCase::Count, (uint32_t *)0);
+
+  ReplicationRunner sequential;
+  sequential.SetThreadCount (1);
+  sequential.SetFirstRun (10);
+  sequential.Run (8, MakeCallback (&ReplicationRunnerTestCase::RunOne, this));
+
+  ReplicationRunner parallel;
+  parallel.SetThreadCount (4);
+  parallel.SetFirstRun (10);
+  parallel.Run (8, MakeCallback (&ReplicationRunnerTestCase::RunOne, this));
+
+  NS_TEST_EXPECT_MSG_EQ (parallel.GetNames ().size (), 4, "Wrong number of results");
+  std::vector<double> counts = parallel.GetValues ("count");
+  NS_TEST_ASSERT_MSG_EQ (counts.size (), 8, "Wrong number of replications");
+  NS_TEST_EXPECT_MSG_EQ ((counts == sequential.GetValues ("count")), true,
+                         "Parallel replications are not reproducible");
+  bool different = false;
+  for (uint32_t i = 0; i < counts.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (parallel.GetValues ("run")[i], 10 + i, "Wrong run number");
+      NS_TEST_EXPECT_MSG_EQ (parallel.GetValues ("time")[i], 5, "Wrong simulation time");
+      NS_TEST_EXPECT_MSG_EQ (parallel.GetValues ("named")[i], 1, "Names are shared");
+      NS_TEST_EXPECT_MSG_GT (counts[i], 0, "No event run");
+      different = different || counts[i] != counts[0];
+    }
+  NS_TEST_EXPECT_MSG_EQ (different, true, "Replications use the same random streams");
+  NS_TEST_EXPECT_MSG_EQ_TOL (parallel.GetMean ("time"), 5, 1e-9, "Wrong mean");
+  NS_TEST_EXPECT_MSG_EQ_TOL (parallel.GetStandardDeviation ("time"), 0, 1e-9, "Wrong standard deviation");
+
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (0), "Main simulation time changed");
+  NS_TEST_EXPECT_MSG_EQ (pending.IsRunning (), true, "Main simulation event lost");
+  Simulator::Cancel (pending);
+  Simulator::Destroy ();
+}
+
+class ReplicationRunnerTestSuite : public TestSuite
+{
+public:
+  ReplicationRunnerTestSuite ()
+    : TestSuite ("replication-runner", UNIT)
+  {
+    AddTestCase (new ReplicationRunnerTestCase, TestCase::QUICK);
+  }
+};
+
+static ReplicationRunnerTestSuite g_replicationRunnerTestSuite;
@@ -19,10 +19,19 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-impl.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/event-profiler.h"
+#include <sstream>
+#include <vector>
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 
 using namespace ns3;
 
@@ -461,6 +470,235 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventRecyclingTestCase : public TestCase
+{
+public:
+  SimulatorEventRecyclingTestCase ();
+  virtual void DoRun (void);
+  void Count (int value);
+  int m_sum;
+};
+
+SimulatorEventRecyclingTestCase::SimulatorEventRecyclingTestCase ()
+  : TestCase ("Check that the memory of deleted events is recycled")
+{
+}
+
+void
+SimulatorEventRecyclingTestCase::Count (int value)
+{
+  m_sum += value;
+}
+
+void
+SimulatorEventRecyclingTestCase::DoRun (void)
+{
+  m_sum = 0;
+  EventId first = Simulator::Schedule (Seconds (1), &SimulatorEventRecyclingTestCase::Count, this, 1);
+  EventImpl *impl = first.PeekEventImpl ();
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 1, "Event did not run");
+  first = EventId ();
+
+  // The second event has the same size as the first one: it must reuse its memory.
+  EventId second = Simulator::Schedule (Seconds (1), &SimulatorEventRecyclingTestCase::Count, this, 10);
+  NS_TEST_EXPECT_MSG_EQ (second.PeekEventImpl (), impl, "Event memory was not recycled");
+  NS_TEST_EXPECT_MSG_EQ (second.IsExpired (), false, "Recycled event is expired");
+  Simulator::Cancel (second);
+  EventId third = Simulator::Schedule (Seconds (1), &SimulatorEventRecyclingTestCase::Count, this, 100);
+  NS_TEST_EXPECT_MSG_NE (third.PeekEventImpl (), impl, "Cancelled event memory was reused");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_sum, 101, "Wrong events were run");
+  Simulator::Destroy ();
+}
+
+class SimulatorCancelledEventsTestCase : public TestCase
+{
+public:
+  SimulatorCancelledEventsTestCase ();
+  virtual void DoRun (void);
+  void Count (void);
+  int m_count;
+};
+
+SimulatorCancelledEventsTestCase::SimulatorCancelledEventsTestCase ()
+  : TestCase ("Check that cancelled events are purged and rescheduled events moved")
+{
+}
+
+void
+SimulatorCancelledEventsTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+SimulatorCancelledEventsTestCase::DoRun (void)
+{
+  m_count = 0;
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CancelledEventsThreshold", UintegerValue (100));
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      ids.push_back (Simulator::Schedule (MilliSeconds (i + 1), &SimulatorCancelledEventsTestCase::Count, this));
+    }
+  // Restart the first 100 events: they must be moved, and not leave
+  // cancelled events behind.
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      EventId id = ids[i];
+      NS_TEST_EXPECT_MSG_EQ (ids[i].Reschedule (Seconds (2)), true, "Running event was not moved");
+      NS_TEST_EXPECT_MSG_EQ (ids[i].IsRunning (), true, "Moved event is not running");
+      NS_TEST_EXPECT_MSG_EQ (ids[i].GetTs (), (uint64_t)Seconds (2).GetTimeStep (), "Wrong time stamp");
+      NS_TEST_EXPECT_MSG_NE (ids[i].GetUid (), id.GetUid (), "Moved event kept its uid");
+    }
+  // Cancel 800 events: the cancelled events are purged once they
+  // make up half of the event list.
+  for (uint32_t i = 100; i < 900; ++i)
+    {
+      ids[i].Cancel ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (ids[100].Reschedule (Seconds (3)), false, "Cancelled event was moved");
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_count, 200, "Wrong number of events run");
+  NS_TEST_EXPECT_MSG_EQ (ids[0].Reschedule (Seconds (3)), false, "Expired event was moved");
+  NS_TEST_EXPECT_MSG_LT (Simulator::GetEventCount (), 1000, "Cancelled events were not purged");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::CancelledEventsThreshold", UintegerValue (1024));
+}
+
+class SimulatorProfilerTestCase : public TestCase
+{
+public:
+  SimulatorProfilerTestCase ();
+  virtual void DoRun (void);
+  void Slow (uint32_t loops);
+  void Fast (void);
+  volatile uint32_t m_sum;
+};
+
+SimulatorProfilerTestCase::SimulatorProfilerTestCase ()
+  : TestCase ("Check that the event profiler attributes time to event types")
+{
+}
+
+void
+SimulatorProfilerTestCase::Slow (uint32_t loops)
+{
+  for (uint32_t i = 0; i < loops; ++i)
+    {
+      m_sum += i;
+    }
+}
+
+void
+SimulatorProfilerTestCase::Fast (void)
+{
+}
+
+void
+SimulatorProfilerTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileSamplingInterval", UintegerValue (2));
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Simulator::ScheduleWithContext (i % 2, MilliSeconds (i), &SimulatorProfilerTestCase::Slow, this, 100000);
+      Simulator::ScheduleWithContext (i % 2, MilliSeconds (i), &SimulatorProfilerTestCase::Fast, this);
+    }
+  Simulator::Run ();
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Wrong simulator implementation");
+  EventProfiler *profiler = impl->GetProfiler ();
+  NS_TEST_ASSERT_MSG_NE (profiler, 0, "Profiler not enabled");
+  NS_TEST_EXPECT_MSG_GT (profiler->GetSampledEvents (), 50, "Too few sampled events");
+  NS_TEST_EXPECT_MSG_LT (profiler->GetSampledEvents (), 150, "Too many sampled events");
+  NS_TEST_EXPECT_MSG_GT (profiler->GetTime ("(SimulatorProfilerTestCase::*)(unsigned int)"),
+                         profiler->GetTime ("(SimulatorProfilerTestCase::*)()"),
+                         "Time not attributed to the slow events");
+  std::ostringstream folded;
+  profiler->PrintFoldedStacks (folded);
+  NS_TEST_EXPECT_MSG_NE (folded.str ().find ("void (SimulatorProfilerTestCase::*)(unsigned int);context 1 "),
+                         std::string::npos, "Missing folded stack");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::ProfileSamplingInterval", UintegerValue (0));
+}
+
+class SimulatorBatchTestCase : public TestCase
+{
+public:
+  SimulatorBatchTestCase ();
+  virtual void DoRun (void);
+  void Setup (int id);
+  void Record (int id);
+  void First (void);
+  std::vector<int> m_order;
+  EventId m_pending;
+  EventId m_removed;
+};
+
+SimulatorBatchTestCase::SimulatorBatchTestCase ()
+  : TestCase ("Check the order of the events batched by context")
+{
+}
+
+void
+SimulatorBatchTestCase::Setup (int id)
+{
+  // Schedule the event from its context, to get its id.
+  Time delay = Seconds (1) - Simulator::Now ();
+  if (id == 10)
+    {
+      Simulator::Schedule (delay, &SimulatorBatchTestCase::First, this);
+      return;
+    }
+  EventId event = Simulator::Schedule (delay, &SimulatorBatchTestCase::Record, this, id);
+  if (id == 20)
+    {
+      m_pending = event;
+    }
+  else if (id == 21)
+    {
+      m_removed = event;
+    }
+}
+
+void
+SimulatorBatchTestCase::Record (int id)
+{
+  m_order.push_back (id);
+}
+
+void
+SimulatorBatchTestCase::First (void)
+{
+  m_order.push_back (10);
+  // m_pending was scheduled first, for another context: it still has to run.
+  NS_TEST_EXPECT_MSG_EQ (m_pending.IsExpired (), false, "Pending batched event is expired");
+  Simulator::Remove (m_removed);
+  NS_TEST_EXPECT_MSG_EQ (m_removed.IsExpired (), true, "Removed batched event is not expired");
+  Simulator::ScheduleWithContext (1, Seconds (0), &SimulatorBatchTestCase::Record, this, 99);
+}
+
+void
+SimulatorBatchTestCase::DoRun (void)
+{
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::BatchByContext", BooleanValue (true));
+  // The events at 1s are scheduled in this order.
+  int ids[] = { 20, 10, 21, 11, 0, 22, 12 };
+  for (uint32_t i = 0; i < sizeof (ids) / sizeof (ids[0]); ++i)
+    {
+      uint32_t context = ids[i] == 0 ? Simulator::NO_CONTEXT : ids[i] / 10;
+      Simulator::ScheduleWithContext (context, NanoSeconds (i), &SimulatorBatchTestCase::Setup, this, ids[i]);
+    }
+  Simulator::ScheduleWithContext (1, Seconds (2), &SimulatorBatchTestCase::Record, this, 13);
+  Simulator::Run ();
+  int expected[] = { 10, 11, 20, 0, 12, 22, 99, 13 };
+  std::vector<int> order (expected, expected + sizeof (expected) / sizeof (expected[0]));
+  NS_TEST_EXPECT_MSG_EQ ((m_order == order), true, "Wrong batched event order");
+  Simulator::Destroy ();
+  Config::SetDefault ("ns3::DefaultSimulatorImpl::BatchByContext", BooleanValue (false));
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +715,11 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventRecyclingTestCase, TestCase::QUICK);
+    AddTestCase (new SimulatorCancelledEventsTestCase, TestCase::QUICK);
+    AddTestCase (new SimulatorProfilerTestCase, TestCase::QUICK);
+    AddTestCase (new SimulatorBatchTestCase, TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -25,8 +25,11 @@
 #include <string>
 #include <sstream>
 
+#include <cmath>
+
 #include "ns3/nstime.h"
 #include "ns3/int64x64.h"
+#include "ns3/system-wall-clock-ms.h"
 #include "ns3/test.h"
 
 using namespace ns3;
@@ -230,6 +233,145 @@ TimeInputOutputTestCase::DoRun (void)
   std::cout << std::endl;
 }
     
+class TimeScalingTestCase : public TestCase
+{
+public:
+  TimeScalingTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeScalingTestCase::TimeScalingTestCase ()
+  : TestCase ("Integer scaling of Time matches the int64x64_t arithmetic")
+{
+}
+
+void
+TimeScalingTestCase::DoRun (void)
+{
+  const int64_t values[] = { 0, 7, -7, 8, -8, 1000003, -1000003 };
+  const int64_t factors[] = { 1, -1, 2, -2, 3, -3, 1000 };
+  for (uint32_t i = 0; i < sizeof (values) / sizeof (values[0]); ++i)
+    {
+      for (uint32_t j = 0; j < sizeof (factors) / sizeof (factors[0]); ++j)
+        {
+          Time t = NanoSeconds (values[i]);
+          int64x64_t v = int64x64_t (t.GetTimeStep ());
+          int64x64_t f = int64x64_t (factors[j]);
+          NS_TEST_EXPECT_MSG_EQ (t * f, Time (v * f),
+                                 "Wrong product " << t << " * " << f);
+          NS_TEST_EXPECT_MSG_EQ (t / f, Time (v / f),
+                                 "Wrong quotient " << t << " / " << f);
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (NanoSeconds (-7) / int64x64_t (2), NanoSeconds (-4),
+                         "Quotient not rounded towards negative infinity");
+  NS_TEST_EXPECT_MSG_EQ (NanoSeconds (3) * int64x64_t (1.5), NanoSeconds (4),
+                         "Wrong fractional product");
+  NS_TEST_EXPECT_MSG_EQ (NanoSeconds (7) / NanoSeconds (2), int64x64_t (3.5),
+                         "Wrong ratio");
+  NS_TEST_EXPECT_MSG_EQ (Time::From (int64x64_t (3), Time::US), MicroSeconds (3),
+                         "Wrong integer conversion from a coarser unit");
+  NS_TEST_EXPECT_MSG_EQ (Time::From (int64x64_t (2.5), Time::US), NanoSeconds (2500),
+                         "Wrong fractional conversion from a coarser unit");
+  NS_TEST_EXPECT_MSG_EQ (NanoSeconds (5).To (Time::PS), int64x64_t (5000),
+                         "Wrong conversion to a finer unit");
+}
+
+
+/**
+ * Time the duration computations of a wifi PHY, such as
+ * WifiPhy::CalculateTxDuration, which scale a symbol duration by
+ * an integer number of symbols, and convert durations to and from
+ * seconds.
+ */
+class TimeArithmeticBenchmarkTestCase : public TestCase
+{
+public:
+  TimeArithmeticBenchmarkTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Compute the transmission duration of a frame.
+   * \param [in] size The size of the frame, in bytes.
+   * \param [in] rate The data rate, in bit/s.
+   * \param [in] generic Use int64x64_t arithmetic for every operation,
+   *             instead of the Time operators.
+   * \returns The duration.
+   */
+  static Time TxDuration (uint32_t size, double rate, bool generic);
+  /**
+   * Time a number of duration computations.
+   * \param [in] generic Use the int64x64_t arithmetic.
+   * \param [out] checksum The sum of the durations.
+   * \returns The elapsed time, in milliseconds.
+   */
+  static int64_t Measure (bool generic, Time &checksum);
+};
+
+TimeArithmeticBenchmarkTestCase::TimeArithmeticBenchmarkTestCase ()
+  : TestCase ("Benchmark of PHY duration computations")
+{
+}
+
+Time
+TimeArithmeticBenchmarkTestCase::TxDuration (uint32_t size, double rate, bool generic)
+{
+  const Time symbol = NanoSeconds (3200 + 800 * (size % 3));
+  const Time preamble = MicroSeconds (20);
+  const Time slot = MicroSeconds (9);
+  const double numSymbols = std::ceil ((16 + size * 8.0 + 6) / (rate * symbol.GetSeconds ()));
+  Time payload;
+  if (generic)
+    {
+      int64x64_t value = int64x64_t (symbol.GetTimeStep ());
+      value *= int64x64_t (numSymbols);
+      payload = Time (value);
+    }
+  else
+    {
+      payload = symbol * int64x64_t (numSymbols);
+    }
+  Time duration = preamble + payload;
+  // Round up to a number of slots.
+  int64x64_t slots = duration / slot;
+  if (generic)
+    {
+      int64x64_t value = int64x64_t (slot.GetTimeStep ());
+      value *= int64x64_t (slots.GetHigh () + 1);
+      return Time (value);
+    }
+  return slot * (slots.GetHigh () + 1);
+}
+
+int64_t
+TimeArithmeticBenchmarkTestCase::Measure (bool generic, Time &checksum)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  checksum = Seconds (0);
+  for (uint32_t i = 0; i < 200000; ++i)
+    {
+      checksum += TxDuration (100 + i % 1400, 6e6 * (1 + i % 9), generic);
+    }
+  return clock.End ();
+}
+
+void
+TimeArithmeticBenchmarkTestCase::DoRun (void)
+{
+  Time fast;
+  Time generic;
+  int64_t fastMs = Measure (false, fast);
+  int64_t genericMs = Measure (true, generic);
+  NS_TEST_EXPECT_MSG_EQ (fast, generic, "Time scaling fast paths changed the results");
+
+  std::cout << GetParent ()->GetName () << " Benchmark: "
+            << "Time operators: " << fastMs << " ms, "
+            << "int64x64_t arithmetic: " << genericMs << " ms"
+            << std::endl;
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -238,6 +380,8 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeScalingTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeArithmeticBenchmarkTestCase (), TestCase::EXTENSIVE);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
@@ -21,6 +21,7 @@
 #include "ns3/test.h"
 #include "ns3/simulator.h"
 #include "ns3/nstime.h"
+#include <vector>
 
 namespace {
 void bari (int)
@@ -208,6 +209,54 @@ TimerTemplateTestCase::DoTeardown (void)
   Simulator::Destroy ();
 }
 
+class TimerRescheduleTestCase : public TestCase
+{
+public:
+  TimerRescheduleTestCase ();
+  virtual void DoRun (void);
+  void Expire (int value);
+  std::vector<std::pair<Time, int> > m_expired;
+};
+
+TimerRescheduleTestCase::TimerRescheduleTestCase ()
+  : TestCase ("Check that a restarted timer expires once, at the new time")
+{
+}
+void
+TimerRescheduleTestCase::Expire (int value)
+{
+  m_expired.push_back (std::make_pair (Simulator::Now (), value));
+}
+void
+TimerRescheduleTestCase::DoRun (void)
+{
+  Timer timer = Timer (Timer::CANCEL_ON_DESTROY);
+  timer.SetFunction (&TimerRescheduleTestCase::Expire, this);
+  timer.SetArguments (1);
+  timer.SetDelay (Seconds (10.0));
+  timer.Reschedule ();
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::RUNNING, "");
+  timer.Reschedule (Seconds (5.0));
+  NS_TEST_EXPECT_MSG_EQ (timer.GetDelayLeft (), Seconds (5.0), "");
+  // the running event keeps its arguments
+  timer.SetArguments (2);
+  timer.Reschedule (Seconds (20.0));
+  NS_TEST_EXPECT_MSG_EQ (timer.GetDelayLeft (), Seconds (20.0), "");
+  timer.Suspend ();
+  timer.Reschedule (Seconds (30.0));
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::RUNNING, "");
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), 1, "Timer expired more than once");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0].first, Seconds (30.0), "Timer expired at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0].second, 2, "Timer expired with the wrong arguments");
+  NS_TEST_ASSERT_MSG_EQ (timer.GetState (), Timer::EXPIRED, "");
+  timer.Reschedule (Seconds (1.0));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), 2, "Expired timer was not restarted");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1].first, Seconds (31.0), "Timer expired at the wrong time");
+  Simulator::Destroy ();
+}
+
 static class TimerTestSuite : public TestSuite
 {
 public:
@@ -216,5 +265,6 @@ public:
   {
     AddTestCase (new TimerStateTestCase (), TestCase::QUICK);
     AddTestCase (new TimerTemplateTestCase (), TestCase::QUICK);
+    AddTestCase (new TimerRescheduleTestCase (), TestCase::QUICK);
   }
 } g_timerTestSuite;
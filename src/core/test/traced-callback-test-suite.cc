@@ -67,6 +67,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   // these methods do is to set corresponding member variables m_one and m_two.
   //
   TracedCallback<uint8_t, double> trace;
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "New TracedCallback not empty");
 
   //
   // Connect both callbacks to their respective test methods.  If we hit the 
@@ -100,6 +101,7 @@ BasicTracedCallbackTestCase::DoRun (void)
   trace (1, 2);
   NS_TEST_ASSERT_MSG_EQ (m_one, false, "Callback CbOne unexpectedly called");
   NS_TEST_ASSERT_MSG_EQ (m_two, false, "Callback CbTwo unexpectedly called");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), true, "TracedCallback not empty after disconnection");
 
   //
   // If we connect them back up, then both callbacks should be called.
@@ -111,6 +113,173 @@ BasicTracedCallbackTestCase::DoRun (void)
   trace (1, 2);
   NS_TEST_ASSERT_MSG_EQ (m_one, true, "Callback CbOne not called");
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
+  NS_TEST_ASSERT_MSG_EQ (trace.IsEmpty (), false, "TracedCallback empty after connection");
+}
+
+class ConnectFromTracedCallbackTestCase : public TestCase
+{
+public:
+  ConnectFromTracedCallbackTestCase ();
+  virtual ~ConnectFromTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbConnect (uint32_t a);
+  void CbCount (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_count;
+};
+
+ConnectFromTracedCallbackTestCase::ConnectFromTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback connections made by a connected callback")
+{
+}
+
+void
+ConnectFromTracedCallbackTestCase::CbConnect (uint32_t a)
+{
+  // Grow the chain of callbacks while it is being invoked.
+  for (uint32_t i = 0; i < a; ++i)
+    {
+      m_trace.ConnectWithoutContext (MakeCallback (&ConnectFromTracedCallbackTestCase::CbCount, this));
+    }
+}
+
+void
+ConnectFromTracedCallbackTestCase::CbCount (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_count++;
+}
+
+void
+ConnectFromTracedCallbackTestCase::DoRun (void)
+{
+  m_count = 0;
+  m_trace.ConnectWithoutContext (MakeCallback (&ConnectFromTracedCallbackTestCase::CbConnect, this));
+  m_trace (16);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 16, "Callbacks connected during the invocation not called");
+  m_trace.DisconnectWithoutContext (MakeCallback (&ConnectFromTracedCallbackTestCase::CbConnect, this));
+  m_count = 0;
+  m_trace (16);
+  NS_TEST_ASSERT_MSG_EQ (m_count, 16, "Wrong number of callbacks called");
+}
+
+class DisconnectFromTracedCallbackTestCase : public TestCase
+{
+public:
+  DisconnectFromTracedCallbackTestCase ();
+  virtual ~DisconnectFromTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbFirst (uint32_t a);
+  void CbSelf (uint32_t a);
+  void CbNext (uint32_t a);
+  void CbEarlier (uint32_t a);
+  void CbLast (uint32_t a);
+
+  TracedCallback<uint32_t> m_trace;
+  uint32_t m_first;
+  uint32_t m_self;
+  uint32_t m_next;
+  uint32_t m_earlier;
+  uint32_t m_last;
+};
+
+DisconnectFromTracedCallbackTestCase::DisconnectFromTracedCallbackTestCase ()
+  : TestCase ("Check TracedCallback disconnections made by a connected callback")
+{
+}
+
+void
+DisconnectFromTracedCallbackTestCase::CbFirst (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_first++;
+}
+
+void
+DisconnectFromTracedCallbackTestCase::CbSelf (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_self++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbSelf, this));
+}
+
+void
+DisconnectFromTracedCallbackTestCase::CbNext (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_next++;
+}
+
+void
+DisconnectFromTracedCallbackTestCase::CbEarlier (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_earlier++;
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbFirst, this));
+}
+
+void
+DisconnectFromTracedCallbackTestCase::CbLast (uint32_t a)
+{
+  NS_UNUSED (a);
+  m_last++;
+}
+
+void
+DisconnectFromTracedCallbackTestCase::DoRun (void)
+{
+  m_first = 0;
+  m_self = 0;
+  m_next = 0;
+  m_earlier = 0;
+  m_last = 0;
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbFirst, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbSelf, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbNext, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbEarlier, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbLast, this));
+
+  //
+  // The sinks following one which disconnects itself or an earlier sink
+  // must still be called by the same invocation.
+  //
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_first, 1, "Callback CbFirst not called");
+  NS_TEST_ASSERT_MSG_EQ (m_self, 1, "Callback CbSelf not called");
+  NS_TEST_ASSERT_MSG_EQ (m_next, 1, "Callback following a self disconnection not called");
+  NS_TEST_ASSERT_MSG_EQ (m_earlier, 1, "Callback CbEarlier not called");
+  NS_TEST_ASSERT_MSG_EQ (m_last, 1, "Callback following an earlier disconnection not called");
+
+  //
+  // The disconnected sinks are gone from the next invocation.
+  //
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_first, 1, "Disconnected callback CbFirst called");
+  NS_TEST_ASSERT_MSG_EQ (m_self, 1, "Disconnected callback CbSelf called");
+  NS_TEST_ASSERT_MSG_EQ (m_next, 2, "Callback CbNext not called");
+  NS_TEST_ASSERT_MSG_EQ (m_earlier, 2, "Callback CbEarlier not called");
+  NS_TEST_ASSERT_MSG_EQ (m_last, 2, "Callback CbLast not called");
+
+  //
+  // A sink disconnected by an earlier one is not called after it.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbNext, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbEarlier, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbLast, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "TracedCallback not empty after disconnection");
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbEarlier, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectFromTracedCallbackTestCase::CbFirst, this));
+  m_trace (1);
+  NS_TEST_ASSERT_MSG_EQ (m_earlier, 3, "Callback CbEarlier not called");
+  NS_TEST_ASSERT_MSG_EQ (m_first, 1, "Callback disconnected during the invocation called");
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "TracedCallback empty with a connected callback");
 }
 
 class TracedCallbackTestSuite : public TestSuite
@@ -123,6 +292,8 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new ConnectFromTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new DisconnectFromTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "ns3/queue.h"
+#include "ns3/net-device-queue-interface.h"
 #include "ns3/simulator.h"
 #include "ns3/ethernet-header.h"
 #include "ns3/ethernet-trailer.h"
@@ -29,6 +30,7 @@
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "ns3/trace-source-accessor.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
@@ -943,6 +945,62 @@ CsmaNetDevice::Send (Ptr<Packet> packet,const Address& dest, uint16_t protocolNu
   return SendFrom (packet, m_address, dest, protocolNumber);
 }
 
+uint32_t
+CsmaNetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (burst << dest << protocolNumber);
+
+  NS_ASSERT (IsLinkUp ());
+
+  //
+  // Only transmit if send side of net device is enabled
+  //
+  if (IsSendEnabled () == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return 0;
+    }
+
+  Mac48Address destination = Mac48Address::ConvertFrom (dest);
+  Ptr<NetDeviceQueue> txQueue = GetBurstTxQueue ();
+  uint32_t sent = 0;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      if (txQueue != 0 && txQueue->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = *i;
+      AddHeader (packet, m_address, destination, protocolNumber);
+
+      m_macTxTrace (packet);
+
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+      sent++;
+
+      //
+      // As in SendFrom, an idle device starts transmitting right away and
+      // the rest of the burst waits in the queue.
+      //
+      if (m_txMachineState == READY)
+        {
+          m_currentPkt = m_queue->Dequeue ();
+          NS_ASSERT_MSG (m_currentPkt != 0, "CsmaNetDevice::SendBurst(): IsEmpty false but no Packet on queue?");
+          m_promiscSnifferTrace (m_currentPkt);
+          m_snifferTrace (m_currentPkt);
+          TransmitStart ();
+        }
+    }
+  return sent;
+}
+
 bool
 CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address& dest, uint16_t protocolNumber)
 {
@@ -284,6 +284,20 @@ public:
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, 
                          uint16_t protocolNumber);
 
+  /**
+   * Start sending a burst of packets down the channel.
+   *
+   * The send side state is checked and the addresses are converted once
+   * for the whole burst.
+   *
+   * \param burst packets to send
+   * \param dest layer 2 destination address
+   * \param protocolNumber protocol number
+   * \return the number of packets accepted by the device
+   */
+  virtual uint32_t SendBurst (Ptr<PacketBurst> burst, const Address& dest,
+                              uint16_t protocolNumber);
+
   /**
    * Get the node to which this device is attached.
    *
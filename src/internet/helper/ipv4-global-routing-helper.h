@@ -82,6 +82,10 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routes of the nodes whose shortest paths may have changed
+   * since the previous call are recomputed; the other routing tables are
+   * left untouched.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -49,24 +49,26 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
-  typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  typedef CandidateQueue::CandidateHeap_t Heap_t;
+  typedef Heap_t::const_iterator CIter_t;
+  Heap_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::CompareCandidate);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -87,6 +89,7 @@ CandidateQueue::Clear (void)
       delete p;
       p = 0;
     }
+  m_order = 0;
 }
 
 void
@@ -94,11 +97,13 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  c.order = m_order++;
+  m_candidates.push_back (c);
+  m_positions[vNew] = m_candidates.size () - 1;
+  m_vertexIds.insert (std::make_pair (vNew->GetVertexId (), vNew));
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +115,27 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  m_positions.erase (v);
+  std::pair<std::multimap<Ipv4Address, SPFVertex*>::iterator,
+            std::multimap<Ipv4Address, SPFVertex*>::iterator> ids =
+    m_vertexIds.equal_range (v->GetVertexId ());
+  for (std::multimap<Ipv4Address, SPFVertex*>::iterator i = ids.first; i != ids.second; i++)
+    {
+      if (i->second == v)
+        {
+          m_vertexIds.erase (i);
+          break;
+        }
+    }
+
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +148,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,18 +169,23 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
+  std::pair<std::multimap<Ipv4Address, SPFVertex*>::const_iterator,
+            std::multimap<Ipv4Address, SPFVertex*>::const_iterator> ids =
+    m_vertexIds.equal_range (addr);
 
-  for (; i != m_candidates.end (); i++)
+  // Vertex IDs are very seldom shared; return the one that would be
+  // popped first
+  const Candidate *found = 0;
+  for (std::multimap<Ipv4Address, SPFVertex*>::const_iterator i = ids.first; i != ids.second; i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      const Candidate &c = m_candidates[m_positions.find (i->second)->second];
+      if (found == 0 || CompareCandidate (c, *found))
         {
-          return v;
+          found = &c;
         }
     }
 
-  return 0;
+  return found == 0 ? 0 : found->vertex;
 }
 
 void
@@ -164,11 +193,87 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Update (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::map<const SPFVertex*, uint32_t>::const_iterator i = m_positions.find (v);
+  NS_ASSERT_MSG (i != m_positions.end (), "Vertex " << v->GetVertexId () << " is not a candidate");
+  uint32_t position = i->second;
+  m_candidates[position].order = m_order++;
+  SiftUp (position);
+  SiftDown (m_positions[v]);
+}
+
+void
+CandidateQueue::Place (uint32_t position, const Candidate &c)
+{
+  m_candidates[position] = c;
+  m_positions[c.vertex] = position;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t position)
+{
+  Candidate c = m_candidates[position];
+  while (position > 0)
+    {
+      uint32_t parent = (position - 1) / 2;
+      if (!CompareCandidate (c, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (position, m_candidates[parent]);
+      position = parent;
+    }
+  Place (position, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t position)
+{
+  Candidate c = m_candidates[position];
+  uint32_t size = m_candidates.size ();
+  while (2 * position + 1 < size)
+    {
+      uint32_t child = 2 * position + 1;
+      if (child + 1 < size && CompareCandidate (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!CompareCandidate (m_candidates[child], c))
+        {
+          break;
+        }
+      Place (position, m_candidates[child]);
+      position = child;
+    }
+  Place (position, c);
+}
+
+bool
+CandidateQueue::CompareCandidate (const Candidate &c1, const Candidate &c2)
+{
+  if (CompareSPFVertex (c1.vertex, c2.vertex))
+    {
+      return true;
+    }
+  if (CompareSPFVertex (c2.vertex, c1.vertex))
+    {
+      return false;
+    }
+  return c1.order < c2.order;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,8 +46,13 @@ class SPFVertex;
  *
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
- * requirement for a Reorder () operation led us to implement this simple 
+ * requirement for an Update () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The vertices are kept in a binary heap, and indexed by vertex and by
+ * vertex ID, so that Push (), Pop (), Find () and Update () take a time
+ * logarithmic in the size of the queue.  Vertices of equal priority are
+ * popped in the order in which they were pushed or last updated.
  */
 class CandidateQueue
 {
@@ -148,12 +154,23 @@ public:
  * increasing distance.
  *
  * This method is provided in case the values of m_distanceFromRoot change
- * during the routing calculations.
+ * during the routing calculations.  When a single vertex has changed,
+ * Update () is cheaper.
  *
  * @see SPFVertex
+ * @see Update ()
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the priority of a Shortest Path First Vertex of the
+ * Candidate Queue after its value of m_distanceFromRoot has changed.
+ * The vertex is then ranked after the vertices it ties with.
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance has changed.
+ */
+  void Update (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +201,49 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /**
+   * \brief A vertex of the heap and its rank among the vertices it ties with
+   */
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< the vertex
+    uint32_t order;     //!< when the vertex was pushed or last updated
+  };
+
+/**
+ * \brief return true if c1 should be popped before c2
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool CompareCandidate (const Candidate &c1, const Candidate &c2);
+
+/**
+ * \brief Store a candidate at a position of the heap
+ * \param position the position in the heap
+ * \param c the candidate
+ */
+  void Place (uint32_t position, const Candidate &c);
+
+/**
+ * \brief Move the candidate at a position up the heap until its parent
+ * should be popped before it
+ * \param position the position in the heap
+ */
+  void SiftUp (uint32_t position);
+
+/**
+ * \brief Move the candidate at a position down the heap until it should
+ * be popped before its children
+ * \param position the position in the heap
+ */
+  void SiftDown (uint32_t position);
+
+  typedef std::vector<Candidate> CandidateHeap_t; //!< binary heap of SPFVertex candidates
+  CandidateHeap_t m_candidates;  //!< SPFVertex candidates
+  std::map<const SPFVertex*, uint32_t> m_positions; //!< heap positions of the candidates
+  std::multimap<Ipv4Address, SPFVertex*> m_vertexIds; //!< candidates by vertex ID
+  uint32_t m_order;  //!< order of the next pushed or updated candidate
 
   /**
    * \brief Stream insertion operator.
@@ -23,9 +23,11 @@
 #define GLOBAL_ROUTE_MANAGER_IMPL_H
 
 #include <stdint.h>
+#include <atomic>
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -38,6 +40,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -588,6 +591,16 @@ public:
  */
   GlobalRouteManagerLSDB ();
 
+/**
+ * @brief Construct a copy of a Global Router Manager Link State Database.
+ *
+ * The Link State Advertisements of the database are copied, so that
+ * the SPF calculation status of the copies can be changed independently.
+ *
+ * @param lsdb object to copy from
+ */
+  GlobalRouteManagerLSDB (const GlobalRouteManagerLSDB& lsdb);
+
 /**
  * @brief Destroy an empty Global Router Manager Link State Database.
  *
@@ -674,6 +687,31 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Find the Link State Advertisements which differ from those of
+   * another database.
+   *
+   * The Router and Network LSAs found in only one of the databases, or whose
+   * contents differ, are reported by their link state ID.  When the External
+   * LSAs of a router differ, the LSA of the router is reported.
+   *
+   * @param lsdb the other database
+   * @param changed [out] the link state IDs of the LSAs which differ
+   */
+  void GetChangedLSAs (const GlobalRouteManagerLSDB& lsdb, std::set<Ipv4Address>& changed) const;
+
+  /**
+   * @brief Add the Link State Advertisements from which the SPF calculation
+   * can reach a set of LSAs.
+   *
+   * An LSA reaches the LSAs its links lead to.  The SPF calculation rooted
+   * at a router may read the LSAs reachable from the LSA of the router, and
+   * no other.
+   *
+   * @param lsas [in,out] the link state IDs of the LSAs to reach, to which
+   * the link state IDs of the LSAs reaching them are added
+   */
+  void AddReachingLSAs (std::set<Ipv4Address>& lsas) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,13 +719,14 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  std::map<Ipv4Address, LSDBMap_t::const_iterator> m_linkDataIndex; //!< first LSA of m_database with a TransitNetwork link record, by link data
 
 /**
- * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
- * need for it and a compiler provided shallow copy would be wrong.
- * @param lsdb object to copy from
+ * @brief Index the TransitNetwork link records of a Link State Advertisement
+ * by link data.
+ * @param i the LSA in the database
  */
-  GlobalRouteManagerLSDB (GlobalRouteManagerLSDB& lsdb);
+  void IndexLinkData (LSDBMap_t::const_iterator i);
 
 /**
  * @brief The SPFVertex copy assignment operator is disallowed.  There's no 
@@ -732,9 +771,24 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF computations of the routers are run by as many threads as the
+ * GlobalRoutingThreads global value requests.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * routers whose SPF computation it changes
+ *
+ * This has the same result as DeleteGlobalRoutes (),
+ * BuildGlobalRoutingDatabase () and InitializeRoutes (), but the
+ * forwarding tables of the routers which cannot reach any changed
+ * Link State Advertisement, before or after the change, are left
+ * untouched.
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -767,8 +821,38 @@ private:
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
   SPFVertex* m_spfroot; //!< the root node
+  Ptr<Node> m_spfrootNode; //!< the node at the root of the SPF tree
+  Ptr<Ipv4GlobalRouting> m_spfrootRouting; //!< the routing protocol of the node at the root of the SPF tree
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
 
+  /**
+   * \brief Delete the routes of a node that has a GlobalRouterInterface
+   * \param node the node
+   */
+  void DeleteRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Calculate the SPF trees rooted at some routers and populate
+   * their forwarding tables
+   *
+   * The GlobalRoutingThreads global value sets the number of threads
+   * sharing the calculations.  Each thread but this one works on a copy of
+   * the LSDB, and only reads and writes the nodes at the roots of its trees.
+   *
+   * \param roots the nodes at the roots of the trees
+   */
+  void SPFCalculate (const std::vector<Ptr<Node> >& roots);
+
+  /**
+   * \brief Calculate the SPF trees rooted at routers shared with other threads
+   * \param roots the nodes at the roots of the trees
+   * \param next the index of the next root to calculate, shared by the threads
+   * \param nNodes the number of nodes of the simulation, read by the
+   * calling thread since the NodeList must not be used by the others
+   */
+  void SPFCalculateShared (const std::vector<Ptr<Node> >* roots, std::atomic<uint32_t>* next,
+                           uint32_t nNodes);
+
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
    *
@@ -789,6 +873,16 @@ private:
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Calculate the shortest path first (SPF) tree
+   *
+   * Equivalent to quagga ospf_spf_calculate
+   * \param root the root node
+   * \param node the node with this router ID, or 0 if there is none
+   * \param nNodes the number of nodes of the simulation
+   */
+  void SPFCalculate (Ipv4Address root, Ptr<Node> node, uint32_t nNodes);
+
   /**
    * \brief Process Stub nodes
    *
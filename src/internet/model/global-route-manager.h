@@ -65,6 +65,17 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and recompute the routes of the
+ * nodes whose shortest paths may have changed
+ *
+ * This is equivalent to calling DeleteGlobalRoutes (),
+ * BuildGlobalRoutingDatabase () and InitializeRoutes () in turn, except
+ * that the forwarding tables of the nodes which cannot reach any changed
+ * Link State Advertisement are left as they are.
+ */
+  static void UpdateRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -43,30 +43,75 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_connections.clear ();
 }
 
-bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+size_t
+Ipv4EndPointDemux::HashConnection (Ipv4Address localAddress, uint16_t localPort,
+                                   Ipv4Address peerAddress, uint16_t peerPort)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  uint64_t addresses = (uint64_t)localAddress.Get () << 32 | peerAddress.Get ();
+  uint64_t ports = (uint64_t)localPort << 16 | peerPort;
+  return std::hash<uint64_t> () (addresses ^ ports * 0x9e3779b97f4a7c15ULL);
+}
+
+void
+Ipv4EndPointDemux::AddEndPoint (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_endPoints.push_back (endPoint);
+  m_ports[endPoint->GetLocalPort ()].push_back (endPoint);
+  AddConnection (endPoint);
+  endPoint->m_demux = this;
+}
+
+void
+Ipv4EndPointDemux::AddConnection (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  size_t hash = HashConnection (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  m_connections.insert (std::make_pair (hash, endPoint));
+}
+
+void
+Ipv4EndPointDemux::RemoveConnection (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  size_t hash = HashConnection (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  std::pair<ConnectionsI, ConnectionsI> range = m_connections.equal_range (hash);
+  for (ConnectionsI i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort  () == port) 
+      if (i->second == endPoint)
         {
-          return true;
+          m_connections.erase (i);
+          return;
         }
     }
-  return false;
+  NS_ASSERT_MSG (false, "End point " << endPoint << " is not indexed");
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, EndPoints>::iterator endPoints = m_ports.find (port);
+  if (endPoints == m_ports.end ())
+    {
+      return false;
+    }
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
+      if ((*i)->GetLocalAddress () == addr &&
           (*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
@@ -86,7 +131,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -102,7 +147,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -125,7 +170,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,13 +181,16 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::pair<ConnectionsI, ConnectionsI> range =
+    m_connections.equal_range (HashConnection (localAddress, localPort, peerAddress, peerPort));
+  for (ConnectionsI i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      Ipv4EndPoint *endP = i->second;
+      if (endP->GetLocalPort () == localPort &&
+          endP->GetLocalAddress () == localAddress &&
+          endP->GetPeerPort () == peerPort &&
+          endP->GetPeerAddress () == peerAddress &&
+          (endP->GetBoundNetDevice () == boundNetDevice || endP->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
           return 0;
@@ -150,7 +198,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -165,6 +213,13 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          RemoveConnection (endPoint);
+          std::unordered_map<uint16_t, EndPoints>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+          port->second.remove (endPoint);
+          if (port->second.empty ())
+            {
+              m_ports.erase (port);
+            }
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -208,7 +263,35 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, EndPoints>::iterator endPoints = m_ports.find (dport);
+  if (endPoints == m_ports.end ())
+    {
+      return retval1;
+    }
+
+  // All 4 match - this is the case of an open TCP connection, for example.
+  // These are the most exact matches, so look them up first.
+  std::pair<ConnectionsI, ConnectionsI> range =
+    m_connections.equal_range (HashConnection (daddr, dport, saddr, sport));
+  for (ConnectionsI i = range.first; i != range.second; i++)
+    {
+      Ipv4EndPoint* endP = i->second;
+      if (endP->GetLocalAddress () == daddr && endP->GetLocalPort () == dport
+          && endP->GetPeerAddress () == saddr && endP->GetPeerPort () == sport
+          && endP->IsRxEnabled ()
+          && (!endP->GetBoundNetDevice () || endP->GetBoundNetDevice () == incomingInterface->GetDevice ()))
+        {
+          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+          retval4.push_back (endP);
+        }
+    }
+  if (!retval4.empty ())
+    {
+      NS_ABORT_MSG_IF (retval4.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+      return retval4;
+    }
+
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
     {
       Ipv4EndPoint* endP = *i;
 
@@ -224,14 +307,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
           continue;
         }
 
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -302,11 +377,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
 
       bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
 
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
-        }
       if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
         { // All but local address - no idea what this case could be.
           NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
@@ -326,8 +396,7 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
 
   // Here we find the most exact match
   EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
+  if (!retval3.empty ()) retval = retval3;
   else if (!retval2.empty ()) retval = retval2;
   else retval = retval1;
 
@@ -343,16 +412,42 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 {
   NS_LOG_FUNCTION (this << daddr << dport << saddr << sport);
 
+  std::unordered_map<uint16_t, EndPoints>::iterator endPoints = m_ports.find (dport);
+  if (endPoints == m_ports.end ())
+    {
+      return 0;
+    }
+
+  // a single exact match is returned without scanning the port
+  Ipv4EndPoint *exact = 0;
+  std::pair<ConnectionsI, ConnectionsI> range =
+    m_connections.equal_range (HashConnection (daddr, dport, saddr, sport));
+  for (ConnectionsI i = range.first; i != range.second; i++)
+    {
+      Ipv4EndPoint *endP = i->second;
+      if (endP->GetLocalAddress () == daddr && endP->GetLocalPort () == dport
+          && endP->GetPeerAddress () == saddr && endP->GetPeerPort () == sport)
+        {
+          if (exact != 0)
+            {
+              // several exact matches, the scan returns the first one allocated
+              exact = 0;
+              break;
+            }
+          exact = endP;
+        }
+    }
+  if (exact != 0)
+    {
+      return exact;
+    }
+
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
       if ((*i)->GetLocalAddress () == daddr &&
           (*i)->GetPeerPort () == sport &&
           (*i)->GetPeerAddress () == saddr) 
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +41,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port and by a hash of their
+ * four-tuple, so that a lookup only considers the endpoints sharing the
+ * destination port of the packet, and finds an open connection without
+ * scanning the listeners and other connections of its port.  The
+ * endpoints notify the demux when their four-tuple changes.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +173,49 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Container of the IPv4 endpoints, by hash of their four-tuple.
+   */
+  typedef std::unordered_multimap<size_t, Ipv4EndPoint *> Connections;
+
+  /**
+   * \brief Iterator to the container of the IPv4 endpoints, by hash of their four-tuple.
+   */
+  typedef Connections::iterator ConnectionsI;
+
+  /**
+   * \brief Hash a four-tuple.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \returns the hash of the four-tuple
+   */
+  static size_t HashConnection (Ipv4Address localAddress, uint16_t localPort,
+                                Ipv4Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add an end point to the indexes.
+   * \param endPoint the end point
+   */
+  void AddEndPoint (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by its four-tuple.
+   * \param endPoint the end point
+   */
+  void AddConnection (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the four-tuple index.
+   *
+   * This must be called before the four-tuple of the end point changes.
+   *
+   * \param endPoint the end point
+   */
+  void RemoveConnection (Ipv4EndPoint *endPoint);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +242,16 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv4 end points of each local port, in allocation order.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_ports;
+
+  /**
+   * \brief The IPv4 end points, by hash of their four-tuple.
+   */
+  Connections m_connections;
 };
 
 } // namespace ns3
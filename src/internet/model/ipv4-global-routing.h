@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -268,10 +270,22 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Compile the routes into the lookup tries.
+   */
+  void BuildLookupTables (void);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  /// All the routes, indexed as in GetRoute, valid with the lookup tries
+  std::vector<Ipv4RoutingTableEntry *> m_routeIndex;
+  Ipv4PrefixTrie m_hostTrie;           //!< Lookup trie of the host routes
+  Ipv4PrefixTrie m_networkTrie;        //!< Lookup trie of the network routes
+  Ipv4PrefixTrie m_ASexternalTrie;     //!< Lookup trie of the external routes
+  bool m_lookupTablesValid;            //!< Whether the lookup tries match the routes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -473,4 +473,21 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Header *
+Ipv4Header::Clone (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return new Ipv4Header (*this);
+}
+
+void
+Ipv4Header::Assign (const Header &header)
+{
+  NS_LOG_FUNCTION (this << &header);
+  // the checksum setting belongs to the receiver, as with Deserialize
+  bool calcChecksum = m_calcChecksum;
+  *this = dynamic_cast<const Ipv4Header &> (header);
+  m_calcChecksum = calcChecksum;
+}
+
 } // namespace ns3
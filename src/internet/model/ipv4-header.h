@@ -235,6 +235,8 @@ public:
   virtual uint32_t GetSerializedSize (void) const;
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual Header *Clone (void) const;
+  virtual void Assign (const Header &header);
 private:
 
   /// flags related to IP fragmentation
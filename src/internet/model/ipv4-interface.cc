@@ -244,16 +244,79 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
           return;
         }
     }
+  Address hardwareDestination;
+  if (LookupHardwareDestination (p, hdr, dest, &hardwareDestination))
+    {
+      NS_LOG_LOGIC ("Address Resolved.  Send.");
+      m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr));
+    }
+}
+
+void
+Ipv4Interface::SendBurst (const std::list<std::pair<Ptr<Packet>, Ipv4Header> > &packets, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << packets.size () << dest);
+  if (!IsUp () || packets.empty ())
+    {
+      return;
+    }
+
+  // The loopback device and the packets aimed at a local interface do not
+  // go through the traffic control layer: send them one at a time
+  bool local = DynamicCast<LoopbackNetDevice> (m_device) != 0;
+  for (Ipv4InterfaceAddressListCI i = m_ifaddrs.begin (); i != m_ifaddrs.end (); ++i)
+    {
+      if (dest == (*i).GetLocal ())
+        {
+          local = true;
+        }
+    }
+  std::list<std::pair<Ptr<Packet>, Ipv4Header> >::const_iterator i = packets.begin ();
+  if (local)
+    {
+      for (; i != packets.end (); ++i)
+        {
+          Send (i->first, i->second, dest);
+        }
+      return;
+    }
+
+  NS_ASSERT (m_tc != 0);
+
+  Address hardwareDestination;
+  if (!LookupHardwareDestination (i->first, i->second, dest, &hardwareDestination))
+    {
+      // the first packet waits for the address resolution, and so do the others
+      for (++i; i != packets.end (); ++i)
+        {
+          Send (i->first, i->second, dest);
+        }
+      return;
+    }
+
+  NS_LOG_LOGIC ("Address Resolved.  Send burst.");
+  std::vector<Ptr<QueueDiscItem> > items;
+  for (; i != packets.end (); ++i)
+    {
+      items.push_back (Create<Ipv4QueueDiscItem> (i->first, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, i->second));
+    }
+  m_tc->SendBurst (m_device, items);
+}
+
+bool
+Ipv4Interface::LookupHardwareDestination (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest,
+                                          Address *hardwareDestination)
+{
+  NS_LOG_FUNCTION (this << p << dest);
   if (m_device->NeedsArp ())
     {
       NS_LOG_LOGIC ("Needs ARP" << " " << dest);
       Ptr<ArpL3Protocol> arp = m_node->GetObject<ArpL3Protocol> ();
-      Address hardwareDestination;
       bool found = false;
       if (dest.IsBroadcast ())
         {
           NS_LOG_LOGIC ("All-network Broadcast");
-          hardwareDestination = m_device->GetBroadcast ();
+          *hardwareDestination = m_device->GetBroadcast ();
           found = true;
         }
       else if (dest.IsMulticast ())
@@ -263,7 +326,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
                          "ArpIpv4Interface::SendTo (): Sending multicast packet over "
                          "non-multicast device");
 
-          hardwareDestination = m_device->GetMulticast (dest);
+          *hardwareDestination = m_device->GetMulticast (dest);
           found = true;
         }
       else
@@ -273,7 +336,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
               if (dest.IsSubnetDirectedBroadcast ((*i).GetMask ()))
                 {
                   NS_LOG_LOGIC ("Subnetwork Broadcast");
-                  hardwareDestination = m_device->GetBroadcast ();
+                  *hardwareDestination = m_device->GetBroadcast ();
                   found = true;
                   break;
                 }
@@ -281,21 +344,16 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
           if (!found)
             {
               NS_LOG_LOGIC ("ARP Lookup");
-              found = arp->Lookup (p, hdr, dest, m_device, m_cache, &hardwareDestination);
+              found = arp->Lookup (p, hdr, dest, m_device, m_cache, hardwareDestination);
             }
         }
 
-      if (found)
-        {
-          NS_LOG_LOGIC ("Address Resolved.  Send.");
-          m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr));
-        }
-    }
-  else
-    {
-      NS_LOG_LOGIC ("Doesn't need ARP");
-      m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, m_device->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER, hdr));
+      return found;
     }
+
+  NS_LOG_LOGIC ("Doesn't need ARP");
+  *hardwareDestination = m_device->GetBroadcast ();
+  return true;
 }
 
 uint32_t
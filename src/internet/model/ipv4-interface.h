@@ -35,6 +35,7 @@ class ArpCache;
 class Ipv4InterfaceAddress;
 class Ipv4Address;
 class Ipv4Header;
+class Address;
 class TrafficControlLayer;
 
 /**
@@ -156,6 +157,17 @@ public:
    */ 
   void Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest);
 
+  /**
+   * \param packets packets to send, with their IPv4 header
+   * \param dest next hop address of the packets.
+   *
+   * Send several packets to the same next hop, for example the fragments
+   * of a datagram.  The next hop is resolved once, and the packets are
+   * handed together to TrafficControlLayer::SendBurst.  If the address of
+   * the next hop is not resolved yet, the packets wait for it as with Send.
+   */
+  void SendBurst (const std::list<std::pair<Ptr<Packet>, Ipv4Header> > &packets, Ipv4Address dest);
+
   /**
    * \param address The Ipv4InterfaceAddress to add to the interface
    * \returns true if succeeded
@@ -213,6 +225,21 @@ private:
    */
   void DoSetup (void);
 
+  /**
+   * \brief Find the hardware address of the next hop of a packet.
+   *
+   * If an ARP request is needed, the packet is queued in the ARP cache
+   * until the reply arrives.
+   *
+   * \param p the packet
+   * \param hdr the IPv4 header of the packet
+   * \param dest next hop address of the packet
+   * \param hardwareDestination the hardware address found
+   * \returns true if the hardware address is known
+   */
+  bool LookupHardwareDestination (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest,
+                                  Address *hardwareDestination);
+
 
   /**
    * \brief Container for the Ipv4InterfaceAddresses.
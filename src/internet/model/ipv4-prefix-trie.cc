@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ipv4-prefix-trie.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4PrefixTrie");
+
+/**
+ * \param length a prefix length
+ * \returns the network mask of this length, in host byte order
+ */
+static uint32_t
+PrefixMask (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+/**
+ * \param a a sort key and a prefix identifier
+ * \param b another sort key and prefix identifier
+ * \returns true if the key of the first pair is smaller
+ */
+static bool
+CompareKeys (const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b)
+{
+  return a.first < b.first;
+}
+
+Ipv4PrefixTrie::Ipv4PrefixTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Clear ();
+}
+
+void
+Ipv4PrefixTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  // identifier 0 is NO_PREFIX
+  m_prefixes.assign (1, Prefix ());
+  m_prefixes[0].network = 0;
+  m_prefixes[0].length = 0;
+  m_prefixes[0].parent = NO_PREFIX;
+  m_prefixIndex.clear ();
+  Build ();
+}
+
+void
+Ipv4PrefixTrie::Add (Ipv4Address network, Ipv4Mask mask, uint32_t value)
+{
+  NS_LOG_FUNCTION (this << network << mask << value);
+  uint8_t length = mask.GetPrefixLength ();
+  NS_ASSERT_MSG (mask.Get () == PrefixMask (length), "Mask " << mask << " is not contiguous");
+  std::pair<uint32_t, uint8_t> key (network.Get () & PrefixMask (length), length);
+  std::map<std::pair<uint32_t, uint8_t>, uint32_t>::iterator it = m_prefixIndex.find (key);
+  if (it == m_prefixIndex.end ())
+    {
+      it = m_prefixIndex.insert (std::make_pair (key, m_prefixes.size ())).first;
+      m_prefixes.push_back (Prefix ());
+      m_prefixes.back ().network = key.first;
+      m_prefixes.back ().length = length;
+      m_prefixes.back ().parent = NO_PREFIX;
+    }
+  m_prefixes[it->second].values.push_back (value);
+}
+
+void
+Ipv4PrefixTrie::Build (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t lengths = 0;
+  for (uint32_t i = 1; i < m_prefixes.size (); i++)
+    {
+      lengths |= (uint64_t)1 << m_prefixes[i].length;
+    }
+
+  // sort the prefixes by length, and link each one to the longest
+  // shorter prefix containing it
+  std::vector<std::pair<uint32_t, uint32_t> > byLength;
+  uint32_t inherited = NO_PREFIX;
+  for (uint32_t i = 1; i < m_prefixes.size (); i++)
+    {
+      Prefix &prefix = m_prefixes[i];
+      prefix.parent = NO_PREFIX;
+      for (int32_t length = prefix.length - 1; length >= 0; length--)
+        {
+          if (lengths & ((uint64_t)1 << length))
+            {
+              std::map<std::pair<uint32_t, uint8_t>, uint32_t>::const_iterator it =
+                m_prefixIndex.find (std::make_pair (prefix.network & PrefixMask (length), (uint8_t)length));
+              if (it != m_prefixIndex.end ())
+                {
+                  prefix.parent = it->second;
+                  break;
+                }
+            }
+        }
+      if (prefix.length == 0)
+        {
+          inherited = i;
+        }
+      else
+        {
+          byLength.push_back (std::make_pair (prefix.length, i));
+        }
+    }
+  std::stable_sort (byLength.begin (), byLength.end (), &CompareKeys);
+  std::vector<uint32_t> prefixes;
+  prefixes.reserve (byLength.size ());
+  for (uint32_t i = 0; i < byLength.size (); i++)
+    {
+      prefixes.push_back (byLength[i].second);
+    }
+
+  m_nodes.clear ();
+  m_leaves.clear ();
+  m_nodes.resize (1);
+  BuildNode (0, 0, prefixes, inherited);
+  NS_LOG_LOGIC ("Built a trie of " << m_nodes.size () << " nodes and " << m_leaves.size ()
+                << " leaves for " << m_prefixes.size () - 1 << " prefixes");
+}
+
+uint32_t
+Ipv4PrefixTrie::GetSlot (uint32_t address, uint32_t depth)
+{
+  // the address is extended to 36 bits, 6 strides of 6 bits
+  return (((uint64_t)address << 4) >> (30 - 6 * depth)) & 63;
+}
+
+void
+Ipv4PrefixTrie::BuildNode (uint32_t node, uint32_t depth, const std::vector<uint32_t> &prefixes,
+                           uint32_t inherited)
+{
+  uint32_t slots[64];
+  std::fill (slots, slots + 64, inherited);
+  uint32_t end = 6 * depth + 6;
+  uint64_t childMap = 0;
+  std::vector<std::pair<uint32_t, uint32_t> > below;
+  for (std::vector<uint32_t>::const_iterator i = prefixes.begin (); i != prefixes.end (); i++)
+    {
+      const Prefix &prefix = m_prefixes[*i];
+      uint32_t slot = GetSlot (prefix.network, depth);
+      if (prefix.length <= end)
+        {
+          // the prefix covers a range of slots; longer prefixes come later
+          uint32_t span = 1 << (end - prefix.length);
+          std::fill (slots + slot, slots + slot + span, *i);
+        }
+      else
+        {
+          below.push_back (std::make_pair (slot, *i));
+          childMap |= (uint64_t)1 << slot;
+        }
+    }
+  // keep the prefixes of each child sorted by length
+  std::stable_sort (below.begin (), below.end (), &CompareKeys);
+
+  uint32_t childBase = m_nodes.size ();
+  m_nodes.resize (childBase + __builtin_popcountll (childMap));
+  uint64_t leafMap = 0;
+  uint32_t leafBase = m_leaves.size ();
+  for (uint32_t i = 0; i < 64; i++)
+    {
+      if (i == 0 || slots[i] != slots[i - 1])
+        {
+          leafMap |= (uint64_t)1 << i;
+          m_leaves.push_back (slots[i]);
+        }
+    }
+  m_nodes[node].childMap = childMap;
+  m_nodes[node].leafMap = leafMap;
+  m_nodes[node].childBase = childBase;
+  m_nodes[node].leafBase = leafBase;
+
+  uint32_t child = childBase;
+  std::vector<uint32_t> childPrefixes;
+  for (uint32_t i = 0; i < below.size (); )
+    {
+      uint32_t slot = below[i].first;
+      childPrefixes.clear ();
+      for (; i < below.size () && below[i].first == slot; i++)
+        {
+          childPrefixes.push_back (below[i].second);
+        }
+      BuildNode (child++, depth + 1, childPrefixes, slots[slot]);
+    }
+}
+
+uint32_t
+Ipv4PrefixTrie::Lookup (Ipv4Address address) const
+{
+  uint32_t host = address.Get ();
+  const Node *node = &m_nodes[0];
+  for (uint32_t depth = 0; ; depth++)
+    {
+      uint64_t bit = (uint64_t)1 << GetSlot (host, depth);
+      if ((node->childMap & bit) == 0)
+        {
+          return m_leaves[node->leafBase + __builtin_popcountll (node->leafMap & ((bit << 1) - 1)) - 1];
+        }
+      node = &m_nodes[node->childBase + __builtin_popcountll (node->childMap & (bit - 1))];
+    }
+}
+
+uint32_t
+Ipv4PrefixTrie::GetParent (uint32_t prefix) const
+{
+  return m_prefixes[prefix].parent;
+}
+
+uint8_t
+Ipv4PrefixTrie::GetPrefixLength (uint32_t prefix) const
+{
+  return m_prefixes[prefix].length;
+}
+
+const std::vector<uint32_t> &
+Ipv4PrefixTrie::GetValues (uint32_t prefix) const
+{
+  return m_prefixes[prefix].values;
+}
+
+void
+Ipv4PrefixTrie::GetMatches (Ipv4Address address, std::vector<uint32_t> &values) const
+{
+  values.clear ();
+  uint32_t prefixes = 0;
+  for (uint32_t prefix = Lookup (address); prefix != NO_PREFIX; prefix = GetParent (prefix))
+    {
+      values.insert (values.end (), m_prefixes[prefix].values.begin (), m_prefixes[prefix].values.end ());
+      prefixes++;
+    }
+  if (prefixes > 1)
+    {
+      std::sort (values.begin (), values.end ());
+    }
+}
+
+} // namespace ns3
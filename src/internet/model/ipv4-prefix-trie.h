@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_PREFIX_TRIE_H
+#define IPV4_PREFIX_TRIE_H
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Longest prefix match table for IPv4 routing protocols.
+ *
+ * Routes are added as (network, mask, value) triples, where the value is
+ * typically the position of the route in the routing table of the
+ * protocol.  Routes sharing a network and mask form a prefix.  Once
+ * Build has been called, Lookup returns the longest prefix matching an
+ * address, and GetParent walks the shorter matching prefixes, so that a
+ * protocol can fall back to them or consider all of them.
+ *
+ * The table is compiled into a multibit trie of 6-bit strides whose nodes
+ * are compressed with bitmaps, as in Poptrie: a lookup reads at most six
+ * nodes, and the size of the trie grows with the number of prefixes
+ * rather than with the address space they cover.
+ *
+ * The masks are expected to be contiguous.
+ */
+class Ipv4PrefixTrie
+{
+public:
+  static const uint32_t NO_PREFIX = 0; //!< Returned when no prefix matches
+
+  Ipv4PrefixTrie ();
+
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Add a route.
+   *
+   * The route is not visible to Lookup until Build is called.
+   *
+   * \param network the destination network
+   * \param mask the network mask
+   * \param value the value associated with the route
+   */
+  void Add (Ipv4Address network, Ipv4Mask mask, uint32_t value);
+
+  /**
+   * \brief Compile the routes added so far into the trie.
+   */
+  void Build (void);
+
+  /**
+   * \param address the address to look up
+   * \returns the longest prefix matching the address, or NO_PREFIX
+   */
+  uint32_t Lookup (Ipv4Address address) const;
+
+  /**
+   * \param prefix a prefix
+   * \returns the longest prefix shorter than this one which matches all
+   * its addresses, or NO_PREFIX
+   */
+  uint32_t GetParent (uint32_t prefix) const;
+
+  /**
+   * \param prefix a prefix
+   * \returns the length of the prefix
+   */
+  uint8_t GetPrefixLength (uint32_t prefix) const;
+
+  /**
+   * \param prefix a prefix
+   * \returns the values of the routes to the prefix, in the order in which
+   * they were added
+   */
+  const std::vector<uint32_t> & GetValues (uint32_t prefix) const;
+
+  /**
+   * \brief Get the values of all the routes matching an address.
+   * \param address the address to look up
+   * \param values [out] the values, in increasing order
+   */
+  void GetMatches (Ipv4Address address, std::vector<uint32_t> &values) const;
+
+private:
+  /**
+   * \brief A prefix and the routes to it
+   */
+  struct Prefix
+  {
+    uint32_t network;               //!< network address
+    uint8_t length;                 //!< prefix length
+    uint32_t parent;                //!< longest shorter matching prefix
+    std::vector<uint32_t> values;   //!< values of the routes
+  };
+
+  /**
+   * \brief A trie node, covering 6 bits of the address
+   *
+   * The children and the leaves of the 64 slots of the node are stored
+   * contiguously in m_nodes and m_leaves.  A child exists for the slots
+   * whose bit is set in childMap.  A leaf is stored for the slots whose
+   * bit is set in leafMap, and is shared with the following slots whose
+   * bit is clear.
+   */
+  struct Node
+  {
+    uint64_t childMap;    //!< slots with a child
+    uint64_t leafMap;     //!< slots starting a new leaf
+    uint32_t childBase;   //!< index of the first child in m_nodes
+    uint32_t leafBase;    //!< index of the first leaf in m_leaves
+  };
+
+  /**
+   * \brief Compile a node of the trie
+   * \param node the index of the node in m_nodes
+   * \param depth the depth of the node
+   * \param prefixes the prefixes below the node which end in it or below,
+   * by increasing length
+   * \param inherited the longest prefix covering the whole node
+   */
+  void BuildNode (uint32_t node, uint32_t depth, const std::vector<uint32_t> &prefixes,
+                  uint32_t inherited);
+
+  /**
+   * \param address an address
+   * \param depth the depth of a node
+   * \returns the slot of the address in a node at this depth
+   */
+  static uint32_t GetSlot (uint32_t address, uint32_t depth);
+
+  std::vector<Prefix> m_prefixes;   //!< prefixes, indexed by their identifier
+  std::map<std::pair<uint32_t, uint8_t>, uint32_t> m_prefixIndex; //!< prefix identifiers by network and length
+  std::vector<Node> m_nodes;        //!< trie nodes, the root first
+  std::vector<uint32_t> m_leaves;   //!< longest matching prefixes of the node slots
+};
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_TRIE_H */
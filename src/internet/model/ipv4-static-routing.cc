@@ -54,7 +54,8 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_lookupTableValid (false),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +74,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_lookupTableValid = false;
 }
 
 void 
@@ -87,6 +89,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_lookupTableValid = false;
 }
 
 void 
@@ -144,6 +147,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_lookupTableValid = false;
 }
 
 uint32_t 
@@ -219,13 +223,26 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::BuildLookupTable (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeIndex.assign (m_networkRoutes.begin (), m_networkRoutes.end ());
+  m_networkTrie.Clear ();
+  for (uint32_t i = 0; i < m_routeIndex.size (); i++)
+    {
+      Ipv4RoutingTableEntry *route = m_routeIndex[i].first;
+      m_networkTrie.Add (route->GetDestNetwork (), route->GetDestNetworkMask (), i);
+    }
+  m_networkTrie.Build ();
+  m_lookupTableValid = true;
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -239,19 +256,26 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
+  if (!m_lookupTableValid)
+    {
+      BuildLookupTable ();
+    }
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // Walk the matching prefixes from the longest one, and stop at the
+  // first one with a route on the requested interface
+  for (uint32_t prefix = m_networkTrie.Lookup (dest);
+       prefix != Ipv4PrefixTrie::NO_PREFIX && rtentry == 0;
+       prefix = m_networkTrie.GetParent (prefix))
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      uint16_t masklen = m_networkTrie.GetPrefixLength (prefix);
+      uint32_t shortest_metric = 0xffffffff;
+      const std::vector<uint32_t> &routes = m_networkTrie.GetValues (prefix);
+      for (std::vector<uint32_t>::const_iterator i = routes.begin ();
+           i != routes.end ();
+           i++)
         {
+          Ipv4RoutingTableEntry *j = m_routeIndex[*i].first;
+          uint32_t metric = m_routeIndex[*i].second;
           NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
           if (oif != 0)
             {
@@ -261,16 +285,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
@@ -449,6 +463,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_lookupTableValid = false;
           return;
         }
       tmp++;
@@ -581,6 +596,9 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (*i);
     }
+  m_routeIndex.clear ();
+  m_networkTrie.Clear ();
+  m_lookupTableValid = false;
   m_ipv4 = 0;
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -615,6 +633,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_lookupTableValid = false;
         }
       else
         {
@@ -662,6 +681,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_lookupTableValid = false;
         }
       else
         {
@@ -24,6 +24,7 @@
 
 #include <list>
 #include <utility>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -31,6 +32,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-prefix-trie.h"
 
 namespace ns3 {
 
@@ -413,11 +415,31 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Compile the network routes into the lookup trie.
+   */
+  void BuildLookupTable (void);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the network routes, in table order, valid with the lookup trie.
+   */
+  std::vector<std::pair <Ipv4RoutingTableEntry *, uint32_t> > m_routeIndex;
+
+  /**
+   * \brief the lookup trie of the network routes.
+   */
+  Ipv4PrefixTrie m_networkTrie;
+
+  /**
+   * \brief whether the lookup trie matches the network routes.
+   */
+  bool m_lookupTableValid;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -43,28 +43,88 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_connections.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+size_t Ipv6EndPointDemux::HashConnection (Ipv6Address localAddress, uint16_t localPort,
+                                          Ipv6Address peerAddress, uint16_t peerPort)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  Ipv6AddressHash hash;
+  size_t addresses = hash (localAddress) * 31 + hash (peerAddress);
+  uint64_t ports = (uint64_t)localPort << 16 | peerPort;
+  return std::hash<uint64_t> () (addresses ^ ports * 0x9e3779b97f4a7c15ULL);
+}
+
+void Ipv6EndPointDemux::AddEndPoint (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_endPoints.push_back (endPoint);
+  AddPort (endPoint);
+  AddConnection (endPoint);
+  endPoint->m_demux = this;
+}
+
+void Ipv6EndPointDemux::AddPort (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  m_ports[endPoint->GetLocalPort ()].push_back (endPoint);
+}
+
+void Ipv6EndPointDemux::RemovePort (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  std::unordered_map<uint16_t, EndPoints>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+  NS_ASSERT_MSG (port != m_ports.end (), "End point " << endPoint << " is not indexed");
+  port->second.remove (endPoint);
+  if (port->second.empty ())
+    {
+      m_ports.erase (port);
+    }
+}
+
+void Ipv6EndPointDemux::AddConnection (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  size_t hash = HashConnection (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  m_connections.insert (std::make_pair (hash, endPoint));
+}
+
+void Ipv6EndPointDemux::RemoveConnection (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  size_t hash = HashConnection (endPoint->GetLocalAddress (), endPoint->GetLocalPort (),
+                                endPoint->GetPeerAddress (), endPoint->GetPeerPort ());
+  std::pair<ConnectionsI, ConnectionsI> range = m_connections.equal_range (hash);
+  for (ConnectionsI i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort  () == port)
+      if (i->second == endPoint)
         {
-          return true;
+          m_connections.erase (i);
+          return;
         }
     }
-  return false;
+  NS_ASSERT_MSG (false, "End point " << endPoint << " is not indexed");
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<uint16_t, EndPoints>::iterator endPoints = m_ports.find (port);
+  if (endPoints == m_ports.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
+      return false;
+    }
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
+    {
+      if ((*i)->GetLocalAddress () == addr &&
           (*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
@@ -83,7 +143,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -98,7 +158,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -119,7 +179,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -129,13 +189,16 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::pair<ConnectionsI, ConnectionsI> range =
+    m_connections.equal_range (HashConnection (localAddress, localPort, peerAddress, peerPort));
+  for (ConnectionsI i = range.first; i != range.second; i++)
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      Ipv6EndPoint *endP = i->second;
+      if (endP->GetLocalPort () == localPort &&
+          endP->GetLocalAddress () == localAddress &&
+          endP->GetPeerPort () == peerPort &&
+          endP->GetPeerAddress () == peerAddress &&
+          (endP->GetBoundNetDevice () == boundNetDevice || endP->GetBoundNetDevice () == 0))
         {
           NS_LOG_WARN ("Duplicated endpoint.");
           return 0;
@@ -143,7 +206,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  AddEndPoint (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -157,6 +220,8 @@ void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          RemoveConnection (endPoint);
+          RemovePort (endPoint);
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -181,7 +246,34 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<uint16_t, EndPoints>::iterator endPoints = m_ports.find (dport);
+  if (endPoints == m_ports.end ())
+    {
+      return retval1;
+    }
+
+  /* All 4 match - these are the most exact matches, so look them up first */
+  std::pair<ConnectionsI, ConnectionsI> range =
+    m_connections.equal_range (HashConnection (daddr, dport, saddr, sport));
+  for (ConnectionsI i = range.first; i != range.second; i++)
+    {
+      Ipv6EndPoint* endP = i->second;
+      if (endP->GetLocalAddress () == daddr && endP->GetLocalPort () == dport
+          && endP->GetPeerAddress () == saddr && endP->GetPeerPort () == sport
+          && endP->IsRxEnabled ()
+          && (!endP->GetBoundNetDevice ()
+              || (incomingInterface && endP->GetBoundNetDevice () == incomingInterface->GetDevice ())))
+        {
+          retval4.push_back (endP);
+        }
+    }
+  if (!retval4.empty ())
+    {
+      NS_ABORT_MSG_IF (retval4.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+      return retval4;
+    }
+
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -197,15 +289,6 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
           continue;
         }
 
-      if (endP->GetLocalPort () != dport)
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
-
       if (endP->GetBoundNetDevice ())
         {
           if (!incomingInterface)
@@ -269,18 +352,11 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
         { /* All but local address */
           retval3.push_back (endP);
         }
-      if (localAddressMatchesExact
-          && remotePeerMatchesExact
-          && remoteAddressMatchesExact)
-        { /* All 4 match */
-          retval4.push_back (endP);
-        }
     }
 
   // Here we find the most exact match
   EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
+  if (!retval3.empty ()) retval = retval3;
   else if (!retval2.empty ()) retval = retval2;
   else retval = retval1;
 
@@ -290,18 +366,43 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+  std::unordered_map<uint16_t, EndPoints>::iterator endPoints = m_ports.find (dport);
+  if (endPoints == m_ports.end ())
+    {
+      return 0;
+    }
+
+  /* a single exact match is returned without scanning the port */
+  Ipv6EndPoint *exact = 0;
+  std::pair<ConnectionsI, ConnectionsI> range =
+    m_connections.equal_range (HashConnection (dst, dport, src, sport));
+  for (ConnectionsI i = range.first; i != range.second; i++)
+    {
+      Ipv6EndPoint *endP = i->second;
+      if (endP->GetLocalAddress () == dst && endP->GetLocalPort () == dport
+          && endP->GetPeerAddress () == src && endP->GetPeerPort () == sport)
+        {
+          if (exact != 0)
+            {
+              /* several exact matches, the scan returns the first one allocated */
+              exact = 0;
+              break;
+            }
+          exact = endP;
+        }
+    }
+  if (exact != 0)
+    {
+      return exact;
+    }
+
   uint32_t genericity = 3;
   Ipv6EndPoint *generic = 0;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointsI i = endPoints->second.begin (); i != endPoints->second.end (); i++)
     {
       uint32_t tmp = 0;
 
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
-
       if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
           && (*i)->GetPeerAddress () == src)
         {
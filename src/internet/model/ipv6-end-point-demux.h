@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The end points are indexed by local port and by a hash of their
+ * four-tuple, so that a lookup only considers the end points sharing the
+ * destination port, and finds an open connection without scanning its
+ * port.  The end points notify the demux when their four-tuple changes.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,62 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Container of the IPv6 endpoints, by hash of their four-tuple.
+   */
+  typedef std::unordered_multimap<size_t, Ipv6EndPoint *> Connections;
+
+  /**
+   * \brief Iterator to the container of the IPv6 endpoints, by hash of their four-tuple.
+   */
+  typedef Connections::iterator ConnectionsI;
+
+  /**
+   * \brief Hash a four-tuple.
+   * \param localAddress local address
+   * \param localPort local port
+   * \param peerAddress peer address
+   * \param peerPort peer port
+   * \return the hash of the four-tuple
+   */
+  static size_t HashConnection (Ipv6Address localAddress, uint16_t localPort,
+                                Ipv6Address peerAddress, uint16_t peerPort);
+
+  /**
+   * \brief Add an end point to the list and the indexes.
+   * \param endPoint the end point
+   */
+  void AddEndPoint (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by its local port.
+   * \param endPoint the end point
+   */
+  void AddPort (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the local port index.
+   * \param endPoint the end point
+   */
+  void RemovePort (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by its four-tuple.
+   * \param endPoint the end point
+   */
+  void AddConnection (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the four-tuple index.
+   *
+   * This must be called before the four-tuple of the end point changes.
+   *
+   * \param endPoint the end point
+   */
+  void RemoveConnection (Ipv6EndPoint *endPoint);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +240,16 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The IPv6 end points of each local port, in allocation order.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_ports;
+
+  /**
+   * \brief The IPv6 end points, by hash of their four-tuple.
+   */
+  Connections m_connections;
 };
 
 } /* namespace ns3 */
@@ -53,6 +53,11 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The received segments are stored as they are, indexed by their first
+ * sequence number, and they do not overlap: Add only looks at the segments
+ * around the incoming one, and Extract hands the buffered segments over to
+ * the application instead of copying them into a new packet.
+ *
  * SACK list
  * ---------
  *
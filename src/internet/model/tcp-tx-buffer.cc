@@ -96,7 +96,7 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n), m_lostMark (n)
 {
 }
 
@@ -169,6 +169,7 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostMark = seq;
 }
 
 bool
@@ -294,7 +295,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  AddToIndex (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,36 +309,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  auto index = m_sentIndex.find (seq);
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -345,8 +343,10 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   if (! item->m_retrans)
     {
+      RemoveFromScoreboard (item);
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      AddToScoreboard (item);
     }
 
   return item;
@@ -398,7 +398,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,6 +434,14 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool indexed = &list == &m_sentList;
+
+  if (indexed)
+    {
+      // Start from the item containing seq instead of walking the list
+      it = FindSentItem (seq);
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
 
   while (it != list.end ())
     {
@@ -466,10 +474,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  RemoveFromIndex (currentItem);
+                }
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  AddToIndex (firstPartIt);
+                  AddToIndex (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -532,10 +549,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  RemoveFromIndex (currentItem);
+                }
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator firstPartIt = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  AddToIndex (firstPartIt);
+                  AddToIndex (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -562,9 +588,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
           // with the packet that follows, and recurse
           TcpTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
+          PacketList::iterator current = std::prev (it);
 
+          if (indexed)
+            {
+              RemoveFromIndex (currentItem);
+              RemoveFromIndex (next);
+            }
           MergeItems (currentItem, next);
           list.erase (it);
+          if (indexed)
+            {
+              AddToIndex (current);
+            }
 
           delete next;
 
@@ -692,6 +728,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           m_firstByteSeq += pktSize;
 
           RemoveFromCounts (item, pktSize);
+          RemoveFromIndex (item);
 
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
@@ -703,9 +740,11 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
           NS_LOG_INFO (*item);
+          RemoveFromIndex (item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          AddToIndex (i);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -723,6 +762,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
     {
       m_firstByteSeq = seq;
     }
+  if (m_lostMark < m_firstByteSeq)
+    {
+      m_lostMark = m_firstByteSeq;
+    }
 
   if (!m_sentList.empty ())
     {
@@ -733,8 +776,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
+          RemoveFromScoreboard (head);
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          AddToScoreboard (head);
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -768,15 +813,21 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Items starting before the block cannot be sacked by it, skip them
+      auto index = m_sentIndex.lower_bound ((*option_it).first);
+      if (index == m_sentIndex.end ())
+        {
+          continue;
+        }
+      PacketList::iterator item_it = index->second;
+      SequenceNumber32 beginOfCurrentPacket = index->first;
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
@@ -798,6 +849,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
                 }
               else
                 {
+                  RemoveFromScoreboard (*item_it);
                   if ((*item_it)->m_lost)
                     {
                       (*item_it)->m_lost = false;
@@ -806,6 +858,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
                   (*item_it)->m_sacked = true;
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
+                  AddToScoreboard (*item_it);
 
                   if (m_highestSack.first == m_sentList.end()
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
@@ -848,6 +901,65 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
   return modified;
 }
 
+void
+TcpTxBuffer::AddToIndex (PacketList::iterator it)
+{
+  m_sentIndex[(*it)->m_startSeq] = it;
+  AddToScoreboard (*it);
+}
+
+void
+TcpTxBuffer::RemoveFromIndex (const TcpTxItem *item)
+{
+  m_sentIndex.erase (item->m_startSeq);
+  RemoveFromScoreboard (item);
+}
+
+void
+TcpTxBuffer::AddToScoreboard (const TcpTxItem *item)
+{
+  if (!item->m_retrans && !item->m_sacked)
+    {
+      m_unsackedIndex.insert (item->m_startSeq);
+      if (item->m_lost)
+        {
+          m_lostIndex.insert (item->m_startSeq);
+        }
+    }
+  if (item->m_lost || item->m_sacked)
+    {
+      m_leftOutIndex.insert (item->m_startSeq);
+    }
+}
+
+void
+TcpTxBuffer::RemoveFromScoreboard (const TcpTxItem *item)
+{
+  m_lostIndex.erase (item->m_startSeq);
+  m_unsackedIndex.erase (item->m_startSeq);
+  m_leftOutIndex.erase (item->m_startSeq);
+}
+
+void
+TcpTxBuffer::RebuildScoreboard ()
+{
+  m_lostIndex.clear ();
+  m_unsackedIndex.clear ();
+  m_leftOutIndex.clear ();
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      AddToScoreboard (*it);
+    }
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq)
+{
+  auto index = m_sentIndex.upper_bound (seq);
+  NS_ASSERT_MSG (index != m_sentIndex.begin (), "Sequence " << seq << " is not in the sent list");
+  return (--index)->second;
+}
+
 void
 TcpTxBuffer::UpdateLostCount ()
 {
@@ -865,9 +977,15 @@ TcpTxBuffer::UpdateLostCount ()
                    ", will start from item " << *(*m_highestSack.first));
     }
 
+  SequenceNumber32 lostMark = m_lostMark;
   for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
     {
       TcpTxItem *item = *it;
+      if (sacked >= m_dupAckThresh && item->m_startSeq < m_lostMark)
+        {
+          // This item and the ones before are already lost or sacked
+          break;
+        }
       if (item->m_sacked)
         {
           sacked++;
@@ -877,8 +995,14 @@ TcpTxBuffer::UpdateLostCount ()
         {
           if (!item->m_sacked && !item->m_lost)
             {
+              RemoveFromScoreboard (item);
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              AddToScoreboard (item);
+            }
+          if (lostMark < item->m_startSeq + item->m_packet->GetSize ())
+            {
+              lostMark = item->m_startSeq + item->m_packet->GetSize ();
             }
         }
       beginOfCurrentPacket -= item->m_packet->GetSize ();
@@ -889,9 +1013,12 @@ TcpTxBuffer::UpdateLostCount ()
       TcpTxItem *item = *m_sentList.begin ();
       if (!item->m_lost)
         {
+          RemoveFromScoreboard (item);
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          AddToScoreboard (item);
         }
+      m_lostMark = lostMark;
     }
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
@@ -902,37 +1029,26 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first lost or sacked item starting from seq decides
+  auto it = m_leftOutIndex.lower_bound (seq);
+  if (it == m_leftOutIndex.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
+      return false;
+    }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+  const TcpTxItem *item = *m_sentIndex.find (*it)->second;
+  if (item->m_lost)
+    {
+      NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+      return true;
     }
 
+  NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
   return false;
 }
 
@@ -954,35 +1070,12 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Condition 1.a , 1.b , and 1.c
+  if (!m_lostIndex.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO("IsLost, returning" << *m_lostIndex.begin ());
+      *seq = *m_lostIndex.begin ();
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,10 +1101,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && !m_unsackedIndex.empty ())
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
+      NS_LOG_INFO ("Rule3 valid. " << *m_unsackedIndex.begin ());
+      *seq = *m_unsackedIndex.begin ();
       return true;
     }
 
@@ -1184,6 +1277,8 @@ TcpTxBuffer::ResetRenoSack ()
     {
       (*it)->m_sacked = false;
     }
+  RebuildScoreboard ();
+  m_lostMark = m_firstByteSeq;
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
 }
@@ -1208,6 +1303,9 @@ TcpTxBuffer::ResetSentList ()
   m_retrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_sentIndex.clear ();
+  RebuildScoreboard ();
+  m_lostMark = m_firstByteSeq;
 }
 
 void
@@ -1218,6 +1316,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      RemoveFromIndex (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1225,6 +1324,10 @@ TcpTxBuffer::ResetLastSegmentSent ()
           m_retrans -= item->m_packet->GetSize ();
         }
       m_appList.insert (m_appList.begin (), item);
+      if (m_lostMark > m_firstByteSeq + m_sentSize)
+        {
+          m_lostMark = m_firstByteSeq + m_sentSize;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1270,6 +1373,8 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
       (*it)->m_retrans = false;
     }
+  RebuildScoreboard ();
+  m_lostMark = m_firstByteSeq + m_sentSize;
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
@@ -1301,8 +1406,10 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
 
   if (m_sentList.front ()->m_retrans)
     {
+      RemoveFromScoreboard (m_sentList.front ());
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1312,6 +1419,8 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      RemoveFromScoreboard (m_sentList.front ());
+
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1332,6 +1441,8 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1356,8 +1467,10 @@ TcpTxBuffer::AddRenoSack (void)
   // Add to the sacked size the size of the first "not sacked" segment
   if (it != m_sentList.end ())
     {
+      RemoveFromScoreboard (*it);
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
+      AddToScoreboard (*it);
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
@@ -1383,9 +1496,40 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t sacked = 0;
   uint32_t lost = 0;
   uint32_t retrans = 0;
+  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
+  uint32_t lostItems = 0;
+  uint32_t unsackedItems = 0;
+  uint32_t leftOutItems = 0;
 
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Sent index out of sync " << *this);
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      const TcpTxItem *item = *it;
+      NS_ASSERT_MSG (item->m_startSeq == beginOfCurrentPacket, "Item " << *item <<
+                     " should start at " << beginOfCurrentPacket);
+      auto index = m_sentIndex.find (item->m_startSeq);
+      NS_ASSERT_MSG (index != m_sentIndex.end () && index->second == it,
+                     "Item " << *item << " is not indexed");
+      NS_ASSERT_MSG (it == m_sentList.begin () || item->m_startSeq >= m_lostMark
+                     || item->m_lost || item->m_sacked,
+                     "Item " << *item << " below " << m_lostMark << " is neither lost nor sacked");
+      if (!item->m_retrans && !item->m_sacked)
+        {
+          NS_ASSERT (m_unsackedIndex.count (item->m_startSeq) == 1);
+          unsackedItems++;
+          if (item->m_lost)
+            {
+              NS_ASSERT (m_lostIndex.count (item->m_startSeq) == 1);
+              lostItems++;
+            }
+        }
+      if (item->m_lost || item->m_sacked)
+        {
+          NS_ASSERT (m_leftOutIndex.count (item->m_startSeq) == 1);
+          leftOutItems++;
+        }
+      beginOfCurrentPacket += item->m_packet->GetSize ();
+
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
@@ -1406,6 +1550,10 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+  NS_ASSERT_MSG (lostItems == m_lostIndex.size ()
+                 && unsackedItems == m_unsackedIndex.size ()
+                 && leftOutItems == m_leftOutIndex.size (),
+                 "Scoreboard indexes out of sync " << *this);
 }
 
 std::ostream &
@@ -22,6 +22,9 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
+#include <set>
+
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -105,6 +108,14 @@ public:
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * To avoid travelling the whole list for each ACK or segment sent, the items
+ * of the SentList are also indexed by their starting sequence number, and
+ * the sequence numbers of the items that NextSeg and IsLost look for are
+ * kept in ordered sets. A SACK block is then mapped to the items it covers
+ * with a logarithmic search, and NextSeg and IsLost do not walk the items
+ * sent before the segment they return. Every change to the SentList or to
+ * the flags of its items has to update these indexes (\see AddToIndex).
+ *
  * Item properties
  * ---------------
  *
@@ -432,6 +443,52 @@ private:
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Index an item of the sent list
+   *
+   * Add the item to m_sentIndex and to the scoreboard indexes.
+   *
+   * \param it the item in m_sentList
+   */
+  void AddToIndex (PacketList::iterator it);
+
+  /**
+   * \brief Remove an item of the sent list from the indexes
+   *
+   * Must be called before the item is removed from the sent list or its
+   * starting sequence number changes.
+   *
+   * \param item the item
+   */
+  void RemoveFromIndex (const TcpTxItem *item);
+
+  /**
+   * \brief Add an item to the scoreboard indexes, according to its flags
+   * \param item the item
+   */
+  void AddToScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Remove an item from the scoreboard indexes
+   *
+   * Must be called before the flags of the item change.
+   *
+   * \param item the item
+   */
+  void RemoveFromScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Rebuild the scoreboard indexes from the flags of the sent list
+   */
+  void RebuildScoreboard ();
+
+  /**
+   * \brief Find the item of the sent list containing a sequence number
+   * \param seq the sequence number, inside the sent list
+   * \return the item
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq);
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -560,7 +617,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -587,8 +644,8 @@ private:
   void SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const;
 
   /**
-   * \brief Check if the values of sacked, lost, retrans, are in sync
-   * with the sent list.
+   * \brief Check if the values of sacked, lost, retrans, and the indexes
+   * are in sync with the sent list.
    */
   void ConsistencyCheck () const;
 
@@ -608,6 +665,12 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  std::map<SequenceNumber32, PacketList::iterator> m_sentIndex; //!< Items of the sent list, by starting sequence
+  std::set<SequenceNumber32> m_lostIndex;     //!< Lost items, neither retransmitted nor sacked (NextSeg rule 1)
+  std::set<SequenceNumber32> m_unsackedIndex; //!< Items neither retransmitted nor sacked (NextSeg rule 3)
+  std::set<SequenceNumber32> m_leftOutIndex;  //!< Lost or sacked items (IsLost)
+  SequenceNumber32 m_lostMark; //!< The items before this sequence, but the head, are all lost or sacked
+
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
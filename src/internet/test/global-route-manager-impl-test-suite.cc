@@ -26,7 +26,10 @@
 #include "ns3/global-route-manager-impl.h"
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
 #include <cstdlib> // for rand()
+#include <algorithm>
+#include <list>
 
 using namespace ns3;
 
@@ -226,6 +229,107 @@ GlobalRouteManagerImplTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief CandidateQueue test: the vertices are popped in the order of the
+ * former sorted list implementation, in which a vertex was inserted after
+ * those of equal priority, also when its distance decreased.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \brief Insert a vertex in a sorted list after those of equal priority
+   * \param list the list
+   * \param v the vertex
+   */
+  static void Insert (std::list<SPFVertex*> &list, SPFVertex *v);
+  /**
+   * \param v1 first vertex
+   * \param v2 second vertex
+   * \returns true if v1 should be popped before v2
+   */
+  static bool Compare (const SPFVertex *v1, const SPFVertex *v2);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("CandidateQueue ordering")
+{
+}
+
+bool
+CandidateQueueTestCase::Compare (const SPFVertex *v1, const SPFVertex *v2)
+{
+  if (v1->GetDistanceFromRoot () != v2->GetDistanceFromRoot ())
+    {
+      return v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ();
+    }
+  return v1->GetVertexType () == SPFVertex::VertexNetwork
+         && v2->GetVertexType () == SPFVertex::VertexRouter;
+}
+
+void
+CandidateQueueTestCase::Insert (std::list<SPFVertex*> &list, SPFVertex *v)
+{
+  list.insert (std::upper_bound (list.begin (), list.end (), v, &CandidateQueueTestCase::Compare), v);
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  CandidateQueue candidate;
+  std::list<SPFVertex*> expected;
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      SPFVertex *v = new SPFVertex;
+      v->SetVertexId (Ipv4Address (i));
+      v->SetVertexType (rand->GetInteger (0, 1) ? SPFVertex::VertexRouter : SPFVertex::VertexNetwork);
+      v->SetDistanceFromRoot (rand->GetInteger (10, 40));
+      candidate.Push (v);
+      Insert (expected, v);
+
+      if (i % 3 == 0)
+        {
+          // lower the distance of a random candidate, as SPFNext does
+          SPFVertex *w = candidate.Find (Ipv4Address (rand->GetInteger (0, i)));
+          if (w != 0 && w->GetDistanceFromRoot () > 0)
+            {
+              expected.remove (w);
+              w->SetDistanceFromRoot (rand->GetInteger (0, w->GetDistanceFromRoot () - 1));
+              candidate.Update (w);
+              Insert (expected, w);
+            }
+        }
+      if (i % 5 == 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (candidate.Top (), expected.front (), "Wrong top candidate");
+          NS_TEST_ASSERT_MSG_EQ (candidate.Find (candidate.Top ()->GetVertexId ()), candidate.Top (),
+                                 "Candidate not found by ID");
+          delete candidate.Pop ();
+          expected.pop_front ();
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (candidate.Size (), expected.size (), "Wrong number of candidates");
+  while (!expected.empty ())
+    {
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ (v, expected.front (), "Wrong candidate order");
+      NS_TEST_EXPECT_MSG_EQ (candidate.Find (v->GetVertexId ()), 0, "Popped candidate still found");
+      expected.pop_front ();
+      delete v;
+    }
+  NS_TEST_EXPECT_MSG_EQ (candidate.Empty (), true, "Candidates left");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -243,6 +347,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
@@ -15,8 +15,11 @@
  */
 
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -1244,6 +1247,139 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting recomputation test
+ *
+ * Check that the routes calculated by several threads, and the routes
+ * recomputed after a link goes down, are those of a full serial
+ * calculation, and that the routes of the nodes which cannot reach the
+ * link are left untouched.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \param node a node
+   * \returns the global routing protocol of the node
+   */
+  static Ptr<Ipv4GlobalRouting> GetRouting (Ptr<Node> node);
+  /**
+   * \param nodes the nodes
+   * \returns the routes of the nodes
+   */
+  static std::string GetRoutes (NodeContainer nodes);
+  /**
+   * \brief Delete the routes and calculate them again from scratch
+   * \param threads the number of threads calculating the routes
+   */
+  static void Recalculate (uint32_t threads);
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Parallel and incremental global routing")
+{
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingRecomputeTestCase::GetRouting (Ptr<Node> node)
+{
+  return node->GetObject<Ipv4> ()->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+}
+
+std::string
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::ostringstream os;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = GetRouting (nodes.Get (i));
+      os << "node " << i << std::endl;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          os << *routing->GetRoute (j) << std::endl;
+        }
+    }
+  return os.str ();
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::Recalculate (uint32_t threads)
+{
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (threads));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (1));
+}
+
+// Two islands:
+//
+//   n4 n5                  n6 --- n7 --- n8
+//    |  | (LAN)
+//    n0 ------ n1
+//      \      /
+//       \    /
+//         n2 ------ n3
+//
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (9);
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.252");
+  uint32_t links[][2] = { {0, 1}, {1, 2}, {2, 0}, {2, 3}, {6, 7}, {7, 8} };
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      ipv4.Assign (p2pHelper.Install (NodeContainer (nodes.Get (links[i][0]), nodes.Get (links[i][1]))));
+      ipv4.NewNetwork ();
+    }
+  SimpleNetDeviceHelper lanHelper;
+  ipv4.SetBase ("10.1.2.0", "255.255.255.0");
+  ipv4.Assign (lanHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (4), nodes.Get (5))));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string serial = GetRoutes (nodes);
+
+  Recalculate (3);
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes), serial, "Routes calculated by several threads differ");
+
+  // nothing changed: the routes are kept
+  Ipv4RoutingTableEntry *route0 = GetRouting (nodes.Get (0))->GetRoute (0);
+  Ipv4RoutingTableEntry *route7 = GetRouting (nodes.Get (7))->GetRoute (0);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes), serial, "Routes changed without topology change");
+  NS_TEST_EXPECT_MSG_EQ (GetRouting (nodes.Get (0))->GetRoute (0), route0, "Routes of n0 recomputed");
+  NS_TEST_EXPECT_MSG_EQ (GetRouting (nodes.Get (7))->GetRoute (0), route7, "Routes of n7 recomputed");
+
+  // the link n1-n2 goes down: only the routes of the first island change
+  nodes.Get (1)->GetObject<Ipv4> ()->SetDown (2);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string incremental = GetRoutes (nodes);
+  NS_TEST_EXPECT_MSG_NE (incremental, serial, "Routes unchanged after link down");
+  NS_TEST_EXPECT_MSG_EQ (GetRouting (nodes.Get (7))->GetRoute (0), route7, "Routes of n7 recomputed");
+
+  Recalculate (1);
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (nodes), incremental, "Recomputed routes differ from a full calculation");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1403,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,194 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/ipv4-prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie test: fixed routes.
+ */
+class Ipv4PrefixTrieTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4PrefixTrieTestCase::Ipv4PrefixTrieTestCase ()
+  : TestCase ("Longest prefix match of a few routes")
+{
+}
+
+void
+Ipv4PrefixTrieTestCase::DoRun (void)
+{
+  Ipv4PrefixTrie trie;
+  NS_TEST_EXPECT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.1.1")), Ipv4PrefixTrie::NO_PREFIX,
+                         "An empty trie should not match");
+
+  trie.Add (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), 0);
+  trie.Add (Ipv4Address ("10.1.1.0"), Ipv4Mask ("/24"), 1);
+  trie.Add (Ipv4Address ("10.1.1.7"), Ipv4Mask ("/32"), 2);
+  trie.Add (Ipv4Address ("0.0.0.0"), Ipv4Mask ("/0"), 3);
+  trie.Add (Ipv4Address ("10.1.1.0"), Ipv4Mask ("/24"), 4);
+  trie.Add (Ipv4Address ("10.1.1.6"), Ipv4Mask ("/31"), 5);
+  trie.Build ();
+
+  uint32_t prefix = trie.Lookup (Ipv4Address ("10.1.1.7"));
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)trie.GetPrefixLength (prefix), 32, "Host route expected");
+  prefix = trie.GetParent (prefix);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)trie.GetPrefixLength (prefix), 31, "/31 route expected");
+  prefix = trie.GetParent (prefix);
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)trie.GetPrefixLength (prefix), 24, "/24 route expected");
+  NS_TEST_ASSERT_MSG_EQ (trie.GetValues (prefix).size (), 2, "Both /24 routes expected");
+  NS_TEST_EXPECT_MSG_EQ (trie.GetValues (prefix)[0], 1, "Routes should keep their order");
+  NS_TEST_EXPECT_MSG_EQ (trie.GetValues (prefix)[1], 4, "Routes should keep their order");
+  prefix = trie.GetParent (trie.GetParent (prefix));
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)trie.GetPrefixLength (prefix), 0, "Default route expected");
+  NS_TEST_EXPECT_MSG_EQ (trie.GetParent (prefix), Ipv4PrefixTrie::NO_PREFIX, "No shorter route expected");
+
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)trie.GetPrefixLength (trie.Lookup (Ipv4Address ("10.1.2.1"))), 16,
+                         "/16 route expected");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)trie.GetPrefixLength (trie.Lookup (Ipv4Address ("10.2.0.1"))), 0,
+                         "Default route expected");
+
+  std::vector<uint32_t> values;
+  trie.GetMatches (Ipv4Address ("10.1.1.9"), values);
+  NS_TEST_ASSERT_MSG_EQ (values.size (), 4, "Four matching routes expected");
+  NS_TEST_EXPECT_MSG_EQ (values[0], 0, "Matches should be sorted");
+  NS_TEST_EXPECT_MSG_EQ (values[3], 4, "Matches should be sorted");
+
+  trie.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.1.7")), Ipv4PrefixTrie::NO_PREFIX,
+                         "A cleared trie should not match");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie test: random routes against a linear search.
+ */
+class Ipv4PrefixTrieRandomTestCase : public TestCase
+{
+public:
+  Ipv4PrefixTrieRandomTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4PrefixTrieRandomTestCase::Ipv4PrefixTrieRandomTestCase ()
+  : TestCase ("Longest prefix match of random routes")
+{
+}
+
+void
+Ipv4PrefixTrieRandomTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  std::vector<Ipv4Address> networks;
+  std::vector<Ipv4Mask> masks;
+  Ipv4PrefixTrie trie;
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      // cluster the routes so that prefixes nest
+      uint32_t network = 0x0a000000 | rand->GetInteger (0, 0xffff) << 8 | rand->GetInteger (0, 255);
+      uint32_t length = rand->GetInteger (0, 32);
+      Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+      networks.push_back (Ipv4Address (network).CombineMask (mask));
+      masks.push_back (mask);
+      trie.Add (Ipv4Address (network), mask, i);
+    }
+  trie.Build ();
+
+  std::vector<uint32_t> values;
+  for (uint32_t k = 0; k < 5000; k++)
+    {
+      Ipv4Address address (0x0a000000 | rand->GetInteger (0, 0xffff) << 8 | rand->GetInteger (0, 255));
+      if (k % 2)
+        {
+          // look up addresses of the routes as well
+          uint32_t i = rand->GetInteger (0, networks.size () - 1);
+          address = Ipv4Address (networks[i].Get () | (address.Get () & ~masks[i].Get ()));
+        }
+      std::vector<uint32_t> expected;
+      std::vector<uint32_t> longest;
+      uint16_t longestLength = 0;
+      for (uint32_t i = 0; i < networks.size (); i++)
+        {
+          if (masks[i].IsMatch (address, networks[i]))
+            {
+              expected.push_back (i);
+              uint16_t length = masks[i].GetPrefixLength ();
+              if (longest.empty () || length > longestLength)
+                {
+                  longest.clear ();
+                  longestLength = length;
+                }
+              if (length == longestLength)
+                {
+                  longest.push_back (i);
+                }
+            }
+        }
+
+      uint32_t prefix = trie.Lookup (address);
+      if (longest.empty ())
+        {
+          NS_TEST_EXPECT_MSG_EQ (prefix, Ipv4PrefixTrie::NO_PREFIX, "No match expected for " << address);
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ ((trie.GetValues (prefix) == longest), true,
+                                 "Wrong longest prefix for " << address);
+        }
+      trie.GetMatches (address, values);
+      NS_TEST_EXPECT_MSG_EQ ((values == expected), true, "Wrong matches for " << address);
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4PrefixTrie TestSuite
+ */
+class Ipv4PrefixTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4PrefixTrieTestSuite ();
+};
+
+Ipv4PrefixTrieTestSuite::Ipv4PrefixTrieTestSuite ()
+  : TestSuite ("ipv4-prefix-trie", UNIT)
+{
+  AddTestCase (new Ipv4PrefixTrieTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4PrefixTrieRandomTestCase, TestCase::QUICK);
+}
+
+static Ipv4PrefixTrieTestSuite g_ipv4PrefixTrieTestSuite; //!< Static variable for test initialization
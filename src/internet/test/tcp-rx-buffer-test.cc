@@ -44,6 +44,11 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+
+  /**
+   * \brief Test the reassembly of overlapping segments received out of order.
+   */
+  void TestReorderedData ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestReorderedData ();
 }
 
 void
@@ -338,6 +344,57 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestReorderedData ()
+{
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  uint32_t size = 3000;
+  uint8_t data[3000];
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      data[i] = i % 251;
+    }
+  Ptr<Packet> p = Create<Packet> (data, size);
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (size);
+
+  // Segments of 150 bytes every 100 bytes, received in a scrambled order,
+  // while the application reads 130 bytes at a time
+  uint8_t received[3000];
+  uint32_t receivedSize = 0;
+  for (uint32_t k = 0; k < 30; ++k)
+    {
+      uint32_t start = (k * 7 % 30) * 100;
+      h.SetSequenceNumber (SequenceNumber32 (1 + start));
+      rxBuf.Add (p->CreateFragment (start, std::min (150u, size - start)), h);
+
+      Ptr<Packet> out = rxBuf.Extract (130);
+      if (out != nullptr)
+        {
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (receivedSize + out->GetSize (), size, "Too much data extracted");
+          out->CopyData (received + receivedSize, out->GetSize ());
+          receivedSize += out->GetSize ();
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1 + size),
+                         "Sequence number differs from expected");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.GetSackListSize (), 0, "SACK list should contain no element");
+  Ptr<Packet> out = rxBuf.Extract (size);
+  NS_TEST_ASSERT_MSG_EQ ((out != nullptr), true, "The remaining data should be available");
+  out->CopyData (received + receivedSize, out->GetSize ());
+  receivedSize += out->GetSize ();
+
+  NS_TEST_ASSERT_MSG_EQ (receivedSize, size, "Data lost in the buffer");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Data left in the buffer");
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) received[i], (uint32_t) data[i], "Wrong byte " << i);
+    }
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
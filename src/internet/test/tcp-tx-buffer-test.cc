@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard of a large window with many holes */
+  void TestManyHoles ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestManyHoles, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -342,6 +346,65 @@ TcpTxBufferTestCase::TestTransmittedBlock ()
 {
 }
 
+void
+TcpTxBufferTestCase::TestManyHoles ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 100;
+  uint32_t segments = 1000;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segmentSize * segments);
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+
+  txBuf.Add (Create<Packet> (segmentSize * segments));
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // SACK the odd segments: every even segment with at least three SACKed
+  // segments after it, that is up to the 994th, is lost
+  for (uint32_t i = 1; i < segments; i += 2)
+    {
+      sack->AddSackBlock (TcpOptionSack::SackBlock (head + (segmentSize * i),
+                                                    head + (segmentSize * (i + 1))));
+      txBuf.Update (sack->GetSackList ());
+      sack->ClearSackList ();
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * 500, "Wrong SACKed bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * 498, "Wrong lost bytes");
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * i)), (i % 2 == 0 && i <= 994),
+                             "Wrong lost state of segment " << i);
+    }
+
+  // Retransmit the lost segments first, then the other holes
+  for (uint32_t i = 0; i <= 998; i += 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true, "No NextSeq with holes");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i), "Wrong hole to retransmit");
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), false, "All the holes were retransmitted");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), segmentSize * 500, "Wrong retransmitted bytes");
+
+  // A partial ACK removes the first half of the scoreboard
+  txBuf.DiscardUpTo (head + (segmentSize * 500));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * 250, "Wrong SACKed bytes after partial ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * 248, "Wrong lost bytes after partial ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 994)), true, "Segment 994 should be lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 996)), false, "Segment 996 should not be lost");
+
+  txBuf.DiscardUpTo (head + (segmentSize * segments));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Data inside the buffer");
+}
+
 void
 TcpTxBufferTestCase::DoTeardown ()
 {
@@ -707,6 +707,112 @@ Udp6SocketImplTest::DoRun (void)
 
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief UDP demultiplexing test
+ *
+ * Check that a packet reaches the most specific socket bound to its
+ * port, and the listener of the port once that socket closes.
+ */
+class UdpSocketDemuxTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param ipv6 true to test IPv6, false to test IPv4
+   */
+  UdpSocketDemuxTest (bool ipv6);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Receive the packets of a socket.
+   * \param name The name of the receiving socket.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkt (std::string name, Ptr<Socket> socket);
+  /**
+   * \param port A port.
+   * \param any true for the wildcard address, false for the loopback address.
+   * \returns the socket address
+   */
+  Address GetAddress (uint16_t port, bool any);
+  /**
+   * \brief Send a packet to the listening port and return the sockets it reached.
+   * \param socket The sending socket.
+   * \returns the names of the receiving sockets
+   */
+  std::string Send (Ptr<Socket> socket);
+
+  bool m_ipv6; //!< true to test IPv6, false to test IPv4
+  std::string m_received; //!< names of the sockets which received the packet
+};
+
+UdpSocketDemuxTest::UdpSocketDemuxTest (bool ipv6)
+  : TestCase (ipv6 ? "UDP6 demultiplexing test" : "UDP demultiplexing test"),
+    m_ipv6 (ipv6)
+{
+}
+
+void
+UdpSocketDemuxTest::ReceivePkt (std::string name, Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received += name;
+    }
+}
+
+Address
+UdpSocketDemuxTest::GetAddress (uint16_t port, bool any)
+{
+  if (m_ipv6)
+    {
+      return Inet6SocketAddress (any ? Ipv6Address::GetAny () : Ipv6Address::GetLoopback (), port);
+    }
+  return InetSocketAddress (any ? Ipv4Address::GetAny () : Ipv4Address::GetLoopback (), port);
+}
+
+std::string
+UdpSocketDemuxTest::Send (Ptr<Socket> socket)
+{
+  m_received = "";
+  socket->SendTo (Create<Packet> (100), 0, GetAddress (80, false));
+  Simulator::Run ();
+  return m_received;
+}
+
+void
+UdpSocketDemuxTest::DoRun ()
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SocketFactory> factory = node->GetObject<UdpSocketFactory> ();
+
+  Ptr<Socket> listener = factory->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (listener->Bind (GetAddress (80, true)), 0, "Bind should succeed");
+  listener->SetRecvCallback (MakeCallback (&UdpSocketDemuxTest::ReceivePkt, this).Bind (std::string ("l")));
+  Ptr<Socket> sender = factory->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (sender->Bind (GetAddress (1000, true)), 0, "Bind should succeed");
+  NS_TEST_EXPECT_MSG_EQ (Send (sender), "l", "The listener should receive");
+
+  Ptr<Socket> bound = factory->CreateSocket ();
+  NS_TEST_EXPECT_MSG_EQ (bound->Bind (GetAddress (80, false)), 0, "Bind should succeed");
+  bound->SetRecvCallback (MakeCallback (&UdpSocketDemuxTest::ReceivePkt, this).Bind (std::string ("b")));
+  NS_TEST_EXPECT_MSG_EQ (Send (sender), "b", "The socket bound to the address should receive");
+
+  bound->Close ();
+  NS_TEST_EXPECT_MSG_EQ (Send (sender), "l", "The listener should receive after the close");
+
+  listener->Close ();
+  NS_TEST_EXPECT_MSG_EQ (Send (sender), "", "No socket should receive after the close");
+
+  Simulator::Destroy ();
+}
+
 
 /**
  * \ingroup internet-test
@@ -723,6 +829,8 @@ public:
     AddTestCase (new UdpSocketLoopbackTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketImplTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketLoopbackTest, TestCase::QUICK);
+    AddTestCase (new UdpSocketDemuxTest (false), TestCase::QUICK);
+    AddTestCase (new UdpSocketDemuxTest (true), TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,349 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "logical-process.h"
+
+#include "ns3/simulator.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::LogicalProcess implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("LogicalProcess");
+
+LogicalProcess::LogicalProcess (uint32_t id)
+  : m_id (id),
+    m_events (0),
+    // uids are allocated from 4, see DefaultSimulatorImpl
+    m_uid (4),
+    m_currentUid (0),
+    m_currentTs (0),
+    m_currentContext (Simulator::NO_CONTEXT),
+    m_eventCount (0),
+    m_unscheduledEvents (0),
+    m_postSequence (0)
+{
+  NS_LOG_FUNCTION (this << id);
+}
+
+LogicalProcess::~LogicalProcess ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LogicalProcess::GetId (void) const
+{
+  return m_id;
+}
+
+void
+LogicalProcess::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+
+  if (m_events != 0)
+    {
+      while (!m_events->IsEmpty ())
+        {
+          Scheduler::Event next = m_events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+    }
+  m_events = scheduler;
+}
+
+void
+LogicalProcess::Dispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  ReceiveEvents ();
+  if (m_events != 0)
+    {
+      while (!m_events->IsEmpty ())
+        {
+          Scheduler::Event next = m_events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      m_events = 0;
+    }
+}
+
+EventId
+LogicalProcess::Schedule (const Time &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (delay.IsPositive (), "LogicalProcess::Schedule(): Negative delay");
+  Time tAbsolute = delay + TimeStep (m_currentTs);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = m_currentContext;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+LogicalProcess::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event)
+{
+  Time tAbsolute = delay + TimeStep (m_currentTs);
+
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = (uint64_t) tAbsolute.GetTimeStep ();
+  ev.key.m_context = context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
+void
+LogicalProcess::InsertEvent (const Scheduler::Event &ev)
+{
+  NS_ASSERT (ev.key.m_ts >= m_currentTs);
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
+void
+LogicalProcess::PostEvent (uint32_t context, uint64_t ts, uint32_t sender, uint64_t seq, EventImpl *event)
+{
+  PostedEvent posted;
+  posted.ev.impl = event;
+  posted.ev.key.m_ts = ts;
+  posted.ev.key.m_context = context;
+  posted.ev.key.m_uid = 0;
+  posted.sender = sender;
+  posted.seq = seq;
+
+  CriticalSection cs (m_mailboxMutex);
+  m_mailbox.push_back (posted);
+}
+
+bool
+LogicalProcess::PostedEventLess (const PostedEvent &a, const PostedEvent &b)
+{
+  if (a.ev.key.m_ts != b.ev.key.m_ts)
+    {
+      return a.ev.key.m_ts < b.ev.key.m_ts;
+    }
+  if (a.sender != b.sender)
+    {
+      return a.sender < b.sender;
+    }
+  return a.seq < b.seq;
+}
+
+void
+LogicalProcess::ReceiveEvents (void)
+{
+  std::vector<PostedEvent> mailbox;
+  {
+    CriticalSection cs (m_mailboxMutex);
+    if (m_mailbox.empty ())
+      {
+        return;
+      }
+    m_mailbox.swap (mailbox);
+  }
+  std::sort (mailbox.begin (), mailbox.end (), &LogicalProcess::PostedEventLess);
+  for (std::vector<PostedEvent>::iterator i = mailbox.begin (); i != mailbox.end (); ++i)
+    {
+      Scheduler::Event ev = i->ev;
+      if (ev.key.m_ts < m_currentTs)
+        {
+          // The other partitions are bound by the lookahead.  The public
+          // logical process may run events behind this one, and the
+          // threads outside of the simulation do not know its time: their
+          // events run as soon as possible rather than out of order.
+          NS_ABORT_MSG_IF (i->sender != 0 && i->sender != std::numeric_limits<uint32_t>::max (),
+                           "Event handed over by logical process " << i->sender << " to " << m_id <<
+                           " is in the past; is the delay smaller than the lookahead?");
+          NS_LOG_WARN ("event for logical process " << m_id << " delayed from " <<
+                       TimeStep (ev.key.m_ts) << " to " << TimeStep (m_currentTs));
+          ev.key.m_ts = m_currentTs;
+        }
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+}
+
+void
+LogicalProcess::ProcessOneEvent (void)
+{
+  Scheduler::Event next = m_events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= m_currentTs);
+  m_unscheduledEvents--;
+  m_eventCount++;
+
+  m_currentTs = next.key.m_ts;
+  m_currentContext = next.key.m_context;
+  m_currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+LogicalProcess::ProcessEventsBefore (uint64_t bound, const std::atomic<bool> &stop)
+{
+  while (!m_events->IsEmpty () && m_events->PeekNext ().key.m_ts < bound
+         && !stop.load (std::memory_order_relaxed))
+    {
+      ProcessOneEvent ();
+    }
+}
+
+void
+LogicalProcess::ProcessEventsAtNextTs (const std::atomic<bool> &stop)
+{
+  if (m_events->IsEmpty ())
+    {
+      return;
+    }
+  uint64_t ts = m_events->PeekNext ().key.m_ts;
+  while (!m_events->IsEmpty () && m_events->PeekNext ().key.m_ts == ts
+         && !stop.load (std::memory_order_relaxed))
+    {
+      ProcessOneEvent ();
+    }
+}
+
+void
+LogicalProcess::Remove (const EventId &id)
+{
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  m_events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  m_unscheduledEvents--;
+}
+
+bool
+LogicalProcess::IsExpired (const EventId &id) const
+{
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < m_currentTs
+      || (id.GetTs () == m_currentTs && id.GetUid () <= m_currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  return false;
+}
+
+bool
+LogicalProcess::IsEmpty (void) const
+{
+  return m_events->IsEmpty ();
+}
+
+uint64_t
+LogicalProcess::GetNextTs (void) const
+{
+  if (m_events->IsEmpty ())
+    {
+      return std::numeric_limits<uint64_t>::max ();
+    }
+  return m_events->PeekNext ().key.m_ts;
+}
+
+uint64_t
+LogicalProcess::GetCurrentTs (void) const
+{
+  return m_currentTs;
+}
+
+void
+LogicalProcess::SetCurrentTs (uint64_t ts)
+{
+  NS_ASSERT (ts >= m_currentTs);
+  m_currentTs = ts;
+}
+
+uint32_t
+LogicalProcess::GetCurrentContext (void) const
+{
+  return m_currentContext;
+}
+
+uint64_t
+LogicalProcess::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
+uint64_t
+LogicalProcess::NextPostSequence (void)
+{
+  return m_postSequence++;
+}
+
+uint32_t
+LogicalProcess::GetNextUid (void) const
+{
+  return m_uid;
+}
+
+void
+LogicalProcess::SetNextUid (uint32_t uid)
+{
+  m_uid = uid;
+}
+
+std::vector<Scheduler::Event>
+LogicalProcess::RemoveAllEvents (void)
+{
+  std::vector<Scheduler::Event> events;
+  while (!m_events->IsEmpty ())
+    {
+      events.push_back (m_events->RemoveNext ());
+      m_unscheduledEvents--;
+    }
+  return events;
+}
+
+} // namespace ns3
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOGICAL_PROCESS_H
+#define NS3_LOGICAL_PROCESS_H
+
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <vector>
+#include <atomic>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::LogicalProcess declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup mtp
+ *
+ * \brief One partition of a multithreaded simulation.
+ *
+ * A logical process owns the event queue of a group of nodes which
+ * can only interact with the rest of the simulation through links
+ * with a non-zero propagation delay.  Events it executes may schedule
+ * new local events directly; events targeting another logical process
+ * are handed over through that process' mailbox, without any copy or
+ * serialization of their arguments, and are merged into its event
+ * queue at the next synchronization point.
+ *
+ * All the methods of this class except PostEvent must be called either
+ * by the thread currently executing this logical process or while no
+ * worker thread is running.
+ */
+class LogicalProcess
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] id The index of this logical process.
+   */
+  LogicalProcess (uint32_t id);
+  /** Destructor. */
+  ~LogicalProcess ();
+
+  /** \return The index of this logical process. */
+  uint32_t GetId (void) const;
+  /**
+   * Replace the event queue of this logical process.
+   *
+   * \param [in] schedulerFactory The factory of the new scheduler.
+   */
+  void SetScheduler (ObjectFactory schedulerFactory);
+  /** Release all the events still pending in this logical process. */
+  void Dispose (void);
+
+  /**
+   * Schedule an event in the current context of this logical process.
+   *
+   * \param [in] delay The delay relative to the current time.
+   * \param [in] event The event to schedule.
+   * \returns The id of the new event.
+   */
+  EventId Schedule (const Time &delay, EventImpl *event);
+  /**
+   * Schedule an event with an explicit context in this logical process.
+   *
+   * \param [in] context The context of the event.
+   * \param [in] delay The delay relative to the current time.
+   * \param [in] event The event to schedule.
+   */
+  void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  /**
+   * Insert an event which already carries its absolute time stamp,
+   * context and unique id.
+   *
+   * \param [in] ev The event to insert.
+   */
+  void InsertEvent (const Scheduler::Event &ev);
+  /**
+   * Hand over an event to this logical process from another thread.
+   *
+   * This method is thread-safe.  The event is inserted in the event
+   * queue by the next call to ReceiveEvents.
+   *
+   * \param [in] context The context of the event.
+   * \param [in] ts The absolute time stamp of the event.
+   * \param [in] sender The index of the sending logical process.
+   * \param [in] seq The sequence number of the event in the sender.
+   * \param [in] event The event to hand over.
+   */
+  void PostEvent (uint32_t context, uint64_t ts, uint32_t sender, uint64_t seq, EventImpl *event);
+  /**
+   * Move the events posted by other logical processes into the
+   * event queue.
+   *
+   * Posted events are sorted by time stamp, sender and sender sequence
+   * number before they get their unique id, so the resulting order is
+   * independent of the thread interleaving.
+   *
+   * The events posted by the public logical process or by a thread
+   * outside of the simulation with a time stamp older than the current
+   * time are delayed to the current time.  The simulation is aborted if
+   * another logical process posts such an event.
+   */
+  void ReceiveEvents (void);
+  /**
+   * Execute all the events whose time stamp is strictly smaller than
+   * a bound, until the simulation is stopped.
+   *
+   * \param [in] bound The time stamp bound, exclusive.
+   * \param [in] stop The flag set by Simulator::Stop.
+   */
+  void ProcessEventsBefore (uint64_t bound, const std::atomic<bool> &stop);
+  /**
+   * Execute all the events scheduled at the time stamp of the
+   * earliest pending event, including the ones they schedule for
+   * the same time stamp, until the simulation is stopped.
+   *
+   * \param [in] stop The flag set by Simulator::Stop.
+   */
+  void ProcessEventsAtNextTs (const std::atomic<bool> &stop);
+  /**
+   * Remove an event from the event queue.
+   *
+   * \param [in] id The event to remove.
+   */
+  void Remove (const EventId &id);
+  /**
+   * \param [in] id The event to check.
+   * \returns \c true if the event has already run or has been cancelled.
+   */
+  bool IsExpired (const EventId &id) const;
+
+  /** \returns \c true if no event is pending in the event queue. */
+  bool IsEmpty (void) const;
+  /**
+   * \returns The time stamp of the next pending event, or the
+   * largest representable time stamp if the queue is empty.
+   */
+  uint64_t GetNextTs (void) const;
+  /** \returns The time stamp of the current event. */
+  uint64_t GetCurrentTs (void) const;
+  /**
+   * Advance the current time of this logical process.
+   *
+   * \param [in] ts The new current time stamp.
+   */
+  void SetCurrentTs (uint64_t ts);
+  /** \returns The context of the current event. */
+  uint32_t GetCurrentContext (void) const;
+  /** \returns The number of events executed by this logical process. */
+  uint64_t GetEventCount (void) const;
+  /** \returns The next sequence number for an event handed to another process. */
+  uint64_t NextPostSequence (void);
+  /** \returns The next unique id this logical process will allocate. */
+  uint32_t GetNextUid (void) const;
+  /**
+   * Set the next unique id this logical process will allocate.
+   *
+   * \param [in] uid The next unique id.
+   */
+  void SetNextUid (uint32_t uid);
+  /**
+   * Remove all the pending events from the event queue.
+   *
+   * \returns The removed events.
+   */
+  std::vector<Scheduler::Event> RemoveAllEvents (void);
+
+private:
+  /** Process the next event. */
+  void ProcessOneEvent (void);
+
+  /** An event handed over by another logical process. */
+  struct PostedEvent
+  {
+    Scheduler::Event ev;  /**< The event, without its unique id. */
+    uint32_t sender;      /**< The sending logical process. */
+    uint64_t seq;         /**< The sequence number in the sender. */
+  };
+  /**
+   * Order posted events deterministically.
+   * \param [in] a The first posted event.
+   * \param [in] b The second posted event.
+   * \returns \c true if \p a must get a smaller unique id than \p b.
+   */
+  static bool PostedEventLess (const PostedEvent &a, const PostedEvent &b);
+
+  /** The index of this logical process. */
+  uint32_t m_id;
+  /** The event priority queue. */
+  Ptr<Scheduler> m_events;
+  /** Next event unique id. */
+  uint32_t m_uid;
+  /** Unique id of the current event. */
+  uint32_t m_currentUid;
+  /** Timestamp of the current event. */
+  uint64_t m_currentTs;
+  /** Execution context of the current event. */
+  uint32_t m_currentContext;
+  /** The event count. */
+  uint64_t m_eventCount;
+  /** Number of events inserted but not yet executed. */
+  int m_unscheduledEvents;
+  /** Sequence number of the events handed to other processes. */
+  uint64_t m_postSequence;
+
+  /** The events posted by other logical processes. */
+  std::vector<PostedEvent> m_mailbox;
+  /** Mutex protecting m_mailbox. */
+  SystemMutex m_mailboxMutex;
+};
+
+} // namespace ns3
+
+#endif /* NS3_LOGICAL_PROCESS_H */
@@ -0,0 +1,656 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/** The logical process executed by the calling thread, if any. */
+thread_local LogicalProcess *g_currentLp = 0;
+
+/**
+ * Find the representative of a node in a union-find forest.
+ *
+ * \param [in,out] parent The union-find forest.
+ * \param [in] i The node index.
+ * \returns The representative of \p i.
+ */
+uint32_t
+FindRoot (std::vector<uint32_t> &parent, uint32_t i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return i;
+}
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mtp")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of threads executing the logical processes, "
+                   "including the main one.  Zero means one per hardware thread.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_stop (false),
+    m_stopTs (std::numeric_limits<uint64_t>::max ()),
+    m_partitioned (false),
+    m_lookAhead (std::numeric_limits<uint64_t>::max ()),
+    m_grantedTs (0),
+    m_threadCount (0),
+    m_task (EXIT),
+    m_taskGeneration (0),
+    m_nextLp (0),
+    m_doneThreads (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_lps.push_back (new LogicalProcess (0));
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      (*i)->Dispose ();
+      delete *i;
+    }
+  m_lps.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      (*i)->SetScheduler (schedulerFactory);
+    }
+}
+
+// System ID for non-distributed simulation is always zero
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+LogicalProcess *
+MultithreadedSimulatorImpl::GetLogicalProcess (uint32_t context) const
+{
+  if (context < m_contextToLp.size ())
+    {
+      return m_lps[m_contextToLp[context]];
+    }
+  return m_lps[0];
+}
+
+LogicalProcess *
+MultithreadedSimulatorImpl::GetCurrentLogicalProcess (void) const
+{
+  if (g_currentLp != 0)
+    {
+      return g_currentLp;
+    }
+  return m_lps[0];
+}
+
+void
+MultithreadedSimulatorImpl::Partition (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> parent (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      parent[i] = i;
+    }
+
+  // Each point-to-point link with a non-zero delay, as in
+  // DistributedSimulatorImpl::CalculateLookAhead, may separate two
+  // partitions; every other kind of channel keeps its nodes together.
+  struct Link
+  {
+    uint32_t a;
+    uint32_t b;
+    uint64_t delay;
+    Ptr<Channel> channel;
+  };
+  std::vector<Link> links;
+  for (NodeList::Iterator iter = NodeList::Begin (); iter != NodeList::End (); ++iter)
+    {
+      Ptr<Node> node = *iter;
+      for (uint32_t i = 0; i < node->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          TimeValue delay;
+          if (localNetDevice->IsPointToPoint ()
+              && channel->GetNDevices () == 2
+              && channel->GetAttributeFailSafe ("Delay", delay)
+              && delay.Get ().IsStrictlyPositive ())
+            {
+              // grab the adjacent node
+              Ptr<Node> remoteNode;
+              if (channel->GetDevice (0) == localNetDevice)
+                {
+                  remoteNode = (channel->GetDevice (1))->GetNode ();
+                }
+              else
+                {
+                  remoteNode = (channel->GetDevice (0))->GetNode ();
+                }
+              Link link;
+              link.a = node->GetId ();
+              link.b = remoteNode->GetId ();
+              link.delay = delay.Get ().GetTimeStep ();
+              link.channel = channel;
+              links.push_back (link);
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              uint32_t a = FindRoot (parent, node->GetId ());
+              uint32_t b = FindRoot (parent, channel->GetDevice (j)->GetNode ()->GetId ());
+              parent[b] = a;
+            }
+        }
+    }
+
+  // Number the partitions in node order, after the public logical process.
+  std::map<uint32_t, uint32_t> rootToLp;
+  m_contextToLp.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      uint32_t root = FindRoot (parent, i);
+      std::map<uint32_t, uint32_t>::iterator it = rootToLp.find (root);
+      if (it == rootToLp.end ())
+        {
+          it = rootToLp.insert (std::make_pair (root, m_lps.size ())).first;
+          LogicalProcess *lp = new LogicalProcess (m_lps.size ());
+          lp->SetScheduler (m_schedulerFactory);
+          m_lps.push_back (lp);
+        }
+      m_contextToLp[i] = it->second;
+    }
+
+  // The packets crossing a partition must not share their buffers
+  // with the packets left in the sender, whose reference counts are
+  // not atomic.
+  m_lookAhead = std::numeric_limits<uint64_t>::max ();
+  for (std::vector<Link>::const_iterator i = links.begin (); i != links.end (); ++i)
+    {
+      if (m_contextToLp[i->a] == m_contextToLp[i->b])
+        {
+          continue;
+        }
+      m_lookAhead = std::min (m_lookAhead, i->delay);
+      if (!i->channel->SetAttributeFailSafe ("UnsharePackets", BooleanValue (true)))
+        {
+          NS_LOG_WARN ("channel " << i->channel->GetId () << " joins two logical processes"
+                       " but cannot unshare the packets it delivers");
+        }
+    }
+
+  // Move the events scheduled so far to the partition of their context,
+  // keeping their unique ids so that the EventIds already handed out
+  // remain valid.
+  LogicalProcess *lp0 = m_lps[0];
+  uint32_t nextUid = lp0->GetNextUid ();
+  uint64_t currentTs = lp0->GetCurrentTs ();
+  for (uint32_t i = 1; i < m_lps.size (); ++i)
+    {
+      m_lps[i]->SetNextUid (nextUid);
+      m_lps[i]->SetCurrentTs (currentTs);
+    }
+  std::vector<Scheduler::Event> events = lp0->RemoveAllEvents ();
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      GetLogicalProcess (i->key.m_context)->InsertEvent (*i);
+    }
+
+  m_partitioned = true;
+  NS_LOG_INFO ("partitioned " << nNodes << " nodes in " << m_lps.size () - 1 <<
+               " logical processes, lookahead " << TimeStep (m_lookAhead));
+}
+
+void
+MultithreadedSimulatorImpl::DoTask (void)
+{
+  uint32_t n = m_lps.size ();
+  uint32_t i;
+  while ((i = m_nextLp++) < n - 1)
+    {
+      LogicalProcess *lp = m_lps[i + 1];
+      if (m_task == RECEIVE)
+        {
+          lp->ReceiveEvents ();
+        }
+      else
+        {
+          g_currentLp = lp;
+          lp->ProcessEventsBefore (m_grantedTs, m_stop);
+          g_currentLp = 0;
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::WorkerLoop (void)
+{
+  uint32_t generation = 0;
+  while (true)
+    {
+      while (m_taskGeneration.load () == generation)
+        {
+          std::this_thread::yield ();
+        }
+      generation = m_taskGeneration.load ();
+      if (m_task == EXIT)
+        {
+          return;
+        }
+      DoTask ();
+      m_doneThreads++;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunTask (enum Task task)
+{
+  m_task = task;
+  m_nextLp = 0;
+  m_doneThreads = 0;
+  m_taskGeneration++;
+  if (task == EXIT)
+    {
+      return;
+    }
+  DoTask ();
+  while (m_doneThreads.load () != m_threads.size ())
+    {
+      std::this_thread::yield ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Set the current threadId as the main threadId
+  m_main = SystemThread::Self ();
+  if (!m_partitioned)
+    {
+      Partition ();
+    }
+#ifndef NS3_MTP
+  NS_LOG_WARN ("ns-3 was not configured with --enable-mtp: reference counts "
+               "shared between logical processes are not thread-safe");
+#endif
+  m_stop = false;
+  m_stopTs = std::numeric_limits<uint64_t>::max ();
+
+  uint32_t threadCount = m_threadCount;
+  if (threadCount == 0)
+    {
+      threadCount = std::max (1u, std::thread::hardware_concurrency ());
+    }
+  threadCount = std::min<uint32_t> (threadCount, m_lps.size () - 1);
+  for (uint32_t i = 1; i < threadCount; ++i)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::WorkerLoop, this));
+      m_threads.push_back (thread);
+      thread->Start ();
+    }
+
+  LogicalProcess *lp0 = m_lps[0];
+  while (!m_stop)
+    {
+      RunTask (RECEIVE);
+      lp0->ReceiveEvents ();
+
+      uint64_t publicTs = lp0->GetNextTs ();
+      uint64_t minTs = std::numeric_limits<uint64_t>::max ();
+      for (uint32_t i = 1; i < m_lps.size (); ++i)
+        {
+          minTs = std::min (minTs, m_lps[i]->GetNextTs ());
+        }
+      if (lp0->IsEmpty () && minTs == std::numeric_limits<uint64_t>::max ())
+        {
+          break;
+        }
+
+      if (!lp0->IsEmpty () && publicTs <= minTs)
+        {
+          // The public events may touch any node: run them alone.
+          g_currentLp = lp0;
+          lp0->ProcessEventsAtNextTs (m_stop);
+          g_currentLp = 0;
+          continue;
+        }
+
+      if (minTs > std::numeric_limits<uint64_t>::max () - m_lookAhead)
+        {
+          m_grantedTs = std::numeric_limits<uint64_t>::max ();
+        }
+      else
+        {
+          m_grantedTs = minTs + m_lookAhead;
+        }
+      m_grantedTs = std::min (m_grantedTs, publicTs);
+      RunTask (PROCESS);
+      // The public logical process is never behind the partitions, nor
+      // behind the event which stopped the simulation.
+      uint64_t ts = minTs;
+      if (m_stop)
+        {
+          ts = std::max (ts, m_stopTs.load ());
+        }
+      lp0->SetCurrentTs (std::max (lp0->GetCurrentTs (), ts));
+    }
+
+  RunTask (EXIT);
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      if (!(*i)->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  // Several logical processes may stop the simulation in the same round.
+  uint64_t ts = GetCurrentLogicalProcess ()->GetCurrentTs ();
+  uint64_t stopTs = m_stopTs.load ();
+  while (ts < stopTs && !m_stopTs.compare_exchange_weak (stopTs, ts))
+    {
+    }
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (g_currentLp != 0 || SystemThread::Equals (m_main),
+                 "Simulator::Schedule Thread-unsafe invocation!");
+  return GetCurrentLogicalProcess ()->Schedule (delay, event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  LogicalProcess *target = GetLogicalProcess (context);
+  LogicalProcess *current = g_currentLp;
+  if (current == target
+      || (current == 0 && SystemThread::Equals (m_main) && m_threads.empty ()))
+    {
+      // Same partition, or no worker thread running.
+      target->ScheduleWithContext (context, delay, event);
+      return;
+    }
+
+  uint64_t ts;
+  uint32_t sender;
+  uint64_t seq;
+  if (current != 0)
+    {
+      NS_ASSERT_MSG (current == m_lps[0] || target == m_lps[0]
+                     || (uint64_t) delay.GetTimeStep () >= m_lookAhead,
+                     "Cross-partition delay " << delay << " smaller than the lookahead " <<
+                     TimeStep (m_lookAhead));
+      ts = current->GetCurrentTs () + delay.GetTimeStep ();
+      sender = current->GetId ();
+      seq = current->NextPostSequence ();
+    }
+  else
+    {
+      // A thread which does not belong to the simulation, such as a
+      // file descriptor reader.
+      ts = m_lps[0]->GetCurrentTs () + delay.GetTimeStep ();
+      sender = std::numeric_limits<uint32_t>::max ();
+      seq = 0;
+    }
+  target->PostEvent (context, ts, sender, seq, event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentLogicalProcess ()->GetCurrentTs (), 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrentLogicalProcess ()->GetCurrentTs ());
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrentLogicalProcess ()->GetCurrentTs ());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  LogicalProcess *lp = GetLogicalProcess (id.GetContext ());
+  NS_ASSERT_MSG (g_currentLp == lp || g_currentLp == m_lps[0] || g_currentLp == 0,
+                 "Cannot remove an event owned by another logical process");
+  lp->Remove (id);
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  return GetLogicalProcess (id.GetContext ())->IsExpired (id);
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentLogicalProcess ()->GetCurrentContext ();
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); ++i)
+    {
+      count += (*i)->GetEventCount ();
+    }
+  return count;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetLogicalProcessCount (void) const
+{
+  return m_lps.size ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+} // namespace ns3
@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "logical-process.h"
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/system-thread.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * ns3::MultithreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mtp
+ *
+ * \brief Conservative parallel simulator implementation for shared
+ * memory machines.
+ *
+ * When Run is called for the first time, the nodes of the global
+ * NodeList are partitioned into logical processes: two nodes end up
+ * in the same logical process unless every path between them goes
+ * through a point-to-point link with a non-zero "Delay" attribute.
+ * The lookahead is the smallest delay of the links joining two
+ * different logical processes, as in
+ * DistributedSimulatorImpl::CalculateLookAhead.
+ *
+ * The simulation then proceeds in rounds.  In each round, the
+ * logical processes are distributed over the worker threads and each
+ * of them executes its events up to the earliest pending time stamp
+ * plus the lookahead.  Events scheduled with ScheduleWithContext for
+ * a node owned by another logical process are handed over in memory
+ * and merged in the target event queue, in a deterministic order, at
+ * the end of the round.
+ *
+ * Events without a context, such as the ones scheduled from the main
+ * program before the simulation starts, belong to a public logical
+ * process which is executed alone, while the worker threads wait.
+ * The partitions may then be ahead of the public events by up to the
+ * lookahead: an event the public logical process schedules in the
+ * past of a partition is delayed to the current time of that
+ * partition.
+ *
+ * The channels joining two logical processes get their "UnsharePackets"
+ * attribute set, so that each packet crossing a
+ * partition is copied with Packet::Unshare and shares no buffer,
+ * metadata or tags with the sender.  Packet uids are allocated
+ * atomically: they are unique, but their order depends on the thread
+ * interleaving.
+ *
+ * All the other models touched by the events of different logical
+ * processes must be thread-safe.  In particular, ns-3 must be
+ * configured with --enable-mtp for the reference counts of the
+ * objects and events shared between logical processes to be updated
+ * atomically.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * \returns The number of logical processes, including the public one.
+   *
+   * Before the first call to Run, only the public logical process exists.
+   */
+  uint32_t GetLogicalProcessCount (void) const;
+  /**
+   * \returns The lookahead computed when the nodes were partitioned.
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /** Partition the nodes and move the pending events to their partition. */
+  void Partition (void);
+  /**
+   * \param [in] context An event context.
+   * \returns The logical process which owns \p context.
+   */
+  LogicalProcess *GetLogicalProcess (uint32_t context) const;
+  /** \returns The logical process executed by the calling thread, if any. */
+  LogicalProcess *GetCurrentLogicalProcess (void) const;
+
+  /** The task the worker threads execute on each logical process. */
+  enum Task
+  {
+    RECEIVE,  //!< Merge the events handed over by other processes.
+    PROCESS,  //!< Execute the events of the current round.
+    EXIT      //!< Terminate the worker threads.
+  };
+  /**
+   * Run a task over all the partitioned logical processes, using all
+   * the threads, and return when it is complete.
+   *
+   * \param [in] task The task to run.
+   */
+  void RunTask (enum Task task);
+  /** Execute the current task until no logical process is left. */
+  void DoTask (void);
+  /** Main loop of the worker threads. */
+  void WorkerLoop (void);
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The earliest time stamp at which Simulator::Stop was called. */
+  std::atomic<uint64_t> m_stopTs;
+
+  /**
+   * The logical processes.  Index 0 is the public logical process,
+   * which owns the events without a node context.
+   */
+  std::vector<LogicalProcess *> m_lps;
+  /** The logical process index of each node id. */
+  std::vector<uint32_t> m_contextToLp;
+  /** Whether the nodes have already been partitioned. */
+  bool m_partitioned;
+  /** The factory of the event queues. */
+  ObjectFactory m_schedulerFactory;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /** The upper bound, exclusive, of the current round. */
+  uint64_t m_grantedTs;
+
+  /** The number of threads, including the main one. */
+  uint32_t m_threadCount;
+  /** The worker threads. */
+  std::vector<Ptr<SystemThread> > m_threads;
+  /** The task of the current round. */
+  enum Task m_task;
+  /** Incremented each time a new task is started. */
+  std::atomic<uint32_t> m_taskGeneration;
+  /** The index of the next logical process to pick for the current task. */
+  std::atomic<uint32_t> m_nextLp;
+  /** The number of worker threads done with the current task. */
+  std::atomic<uint32_t> m_doneThreads;
+
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
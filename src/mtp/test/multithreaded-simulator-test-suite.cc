@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/node.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/multithreaded-simulator-impl.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-test mtp module tests
+ */
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * Connect two nodes with a SimpleChannel.
+ *
+ * \param [in] a The first node.
+ * \param [in] b The second node.
+ * \param [in] delay The channel delay.
+ * \param [in] pointToPoint Whether the devices are in point-to-point mode.
+ * \returns The channel.
+ */
+static Ptr<SimpleChannel>
+Connect (Ptr<Node> a, Ptr<Node> b, Time delay, bool pointToPoint)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (delay));
+  Ptr<Node> nodes[2] = { a, b };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAttribute ("PointToPointMode", BooleanValue (pointToPoint));
+      nodes[i]->AddDevice (device);
+      device->SetChannel (channel);
+    }
+  return channel;
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * Check the partitioning of the nodes and the lookahead.
+ */
+class MultithreadedSimulatorPartitionTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorPartitionTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+MultithreadedSimulatorPartitionTestCase::MultithreadedSimulatorPartitionTestCase ()
+  : TestCase ("Check the partitioning of the nodes in logical processes")
+{
+}
+
+void
+MultithreadedSimulatorPartitionTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  // {0} -- 2ms -- {1, 2} -- 3ms -- {3, 4}
+  std::vector<Ptr<SimpleChannel> > channels;
+  channels.push_back (Connect (nodes[0], nodes[1], MilliSeconds (2), true));
+  channels.push_back (Connect (nodes[1], nodes[2], MilliSeconds (1), false));
+  channels.push_back (Connect (nodes[2], nodes[3], MilliSeconds (3), true));
+  channels.push_back (Connect (nodes[3], nodes[4], Seconds (0), true));
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Wrong simulator implementation");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLogicalProcessCount (), 4, "Wrong number of logical processes");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookAhead (), MilliSeconds (2), "Wrong lookahead");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (1), "Simulation did not stop on time");
+  // Only the channels joining two logical processes unshare their packets.
+  bool unshare[4] = { true, false, true, false };
+  for (uint32_t i = 0; i < channels.size (); ++i)
+    {
+      BooleanValue value;
+      channels[i]->GetAttribute ("UnsharePackets", value);
+      NS_TEST_EXPECT_MSG_EQ (value.Get (), unshare[i], "Wrong UnsharePackets on channel " << i);
+    }
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * Check that events handed over between logical processes run at the
+ * same time and in the same order as with the default simulator.
+ */
+class MultithreadedSimulatorEventsTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorEventsTestCase ();
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Build a chain of nodes, start a few walks along it and run the simulation.
+   *
+   * \param [in] impl The simulator implementation type.
+   * \returns The number of executed events.
+   */
+  uint64_t RunScenario (std::string impl);
+  /**
+   * Record a visit, then move to the next node of the chain.
+   *
+   * \param [in] node The visited node.
+   * \param [in] hops The number of hops left.
+   */
+  void Hop (uint32_t node, uint32_t hops);
+  /**
+   * Record a local event.
+   *
+   * \param [in] node The node.
+   */
+  void Local (uint32_t node);
+
+  /** The number of nodes in the chain. */
+  static const uint32_t N_NODES = 6;
+  /** The events seen by each node, as (time, value) pairs. */
+  std::vector<std::vector<std::pair<Time, uint32_t> > > m_trace;
+};
+
+MultithreadedSimulatorEventsTestCase::MultithreadedSimulatorEventsTestCase ()
+  : TestCase ("Check that the multithreaded simulator reproduces the default event order")
+{
+}
+
+void
+MultithreadedSimulatorEventsTestCase::Hop (uint32_t node, uint32_t hops)
+{
+  NS_ASSERT (Simulator::GetContext () == node);
+  m_trace[node].push_back (std::make_pair (Simulator::Now (), hops));
+  Simulator::Schedule (MicroSeconds (300), &MultithreadedSimulatorEventsTestCase::Local, this, node);
+  if (hops > 0)
+    {
+      uint32_t next = (node + 1) % N_NODES;
+      Simulator::ScheduleWithContext (next, MilliSeconds (1), &MultithreadedSimulatorEventsTestCase::Hop, this, next, hops - 1);
+    }
+}
+
+void
+MultithreadedSimulatorEventsTestCase::Local (uint32_t node)
+{
+  NS_ASSERT (Simulator::GetContext () == node);
+  m_trace[node].push_back (std::make_pair (Simulator::Now (), 1000));
+}
+
+uint64_t
+MultithreadedSimulatorEventsTestCase::RunScenario (std::string impl)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue (impl));
+  m_trace.clear ();
+  m_trace.resize (N_NODES);
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      Connect (nodes[i], nodes[(i + 1) % N_NODES], MilliSeconds (1), true);
+    }
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (10 * i), &MultithreadedSimulatorEventsTestCase::Hop, this, i, 20);
+    }
+  Simulator::Run ();
+  uint64_t count = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return count;
+}
+
+void
+MultithreadedSimulatorEventsTestCase::DoRun (void)
+{
+  uint64_t count = RunScenario ("ns3::DefaultSimulatorImpl");
+  std::vector<std::vector<std::pair<Time, uint32_t> > > reference = m_trace;
+
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (3));
+  NS_TEST_EXPECT_MSG_EQ (RunScenario ("ns3::MultithreadedSimulatorImpl"), count, "Wrong number of events");
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::ThreadCount", UintegerValue (0));
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_trace[i].size (), reference[i].size (), "Wrong number of events on node " << i);
+      for (uint32_t j = 0; j < m_trace[i].size (); ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_trace[i][j].first, reference[i][j].first, "Wrong time on node " << i);
+          NS_TEST_EXPECT_MSG_EQ (m_trace[i][j].second, reference[i][j].second, "Wrong event on node " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * Check that Simulator::Stop called from a partitioned event stops its
+ * logical process before the next event, even within the current round.
+ */
+class MultithreadedSimulatorStopTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorStopTestCase ();
+private:
+  virtual void DoRun (void);
+
+  /** Record an event which must not run after the stop. */
+  void Count (void);
+
+  /** The number of recorded events. */
+  uint32_t m_count;
+};
+
+MultithreadedSimulatorStopTestCase::MultithreadedSimulatorStopTestCase ()
+  : TestCase ("Check that Simulator::Stop stops a logical process within a round")
+{
+}
+
+void
+MultithreadedSimulatorStopTestCase::Count (void)
+{
+  m_count++;
+}
+
+void
+MultithreadedSimulatorStopTestCase::DoRun (void)
+{
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  m_count = 0;
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Connect (a, b, MilliSeconds (10), true);
+
+  // Both events fall in the first round, bounded by the 10ms lookahead.
+  Simulator::ScheduleWithContext (a->GetId (), MilliSeconds (1), static_cast<void (*) (void)> (&Simulator::Stop));
+  Simulator::ScheduleWithContext (a->GetId (), MilliSeconds (5), &MultithreadedSimulatorStopTestCase::Count, this);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_count, 0, "Event run after Simulator::Stop");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (1), "Simulation did not stop on time");
+
+  Simulator::Destroy ();
+  GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mtp-test
+ * \ingroup tests
+ *
+ * The multithreaded simulator test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator", UNIT)
+  {
+    AddTestCase (new MultithreadedSimulatorPartitionTestCase, TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorEventsTestCase, TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorStopTestCase, TestCase::QUICK);
+  }
+};
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< Static variable for test initialization
@@ -18,8 +18,11 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-data-allocator.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/crc32.h"
+#include <algorithm>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -50,95 +53,41 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
- */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+thread_local uint32_t Buffer::g_maxSize = 0;
 
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  /* the size hint never exceeds the largest pooled block, and decays
+   * towards the size actually used by the recycled buffers so that one
+   * large packet does not inflate all the later ones. */
+  uint32_t maxPooled = PacketDataAllocator::GetMaxPooledCapacity () + 1 - sizeof (struct Buffer::Data);
+  uint32_t used = std::min (data->m_dirtyEnd - data->m_dirtyStart, data->m_size);
+  uint32_t size = std::min (used, maxPooled);
+  if (size >= g_maxSize)
     {
-      Buffer::Deallocate (data);
+      g_maxSize = size;
     }
   else
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      g_maxSize -= (g_maxSize - size) / 8;
     }
+  /* the allocator keeps the block in the free list of its thread */
+  Buffer::Deallocate (data);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
-    }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  /* allocate buffers of the size recently recycled in this thread
+   * so that they are rarely resized and all come from the same size
+   * class. */
+  struct Buffer::Data *data = Buffer::Allocate (std::max (dataSize, g_maxSize));
   NS_ASSERT (data->m_count == 1);
   return data;
 }
@@ -169,9 +118,16 @@ Buffer::Allocate (uint32_t reqSize)
     }
   NS_ASSERT (reqSize >= 1);
   uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
+#ifdef BUFFER_FREE_LIST
+  uint32_t capacity;
+  void *b = PacketDataAllocator::Allocate (size, capacity);
+  struct Buffer::Data *data = static_cast<struct Buffer::Data*>(b);
+  data->m_size = capacity + 1 - sizeof (struct Buffer::Data);
+#else /* BUFFER_FREE_LIST */
   uint8_t *b = new uint8_t [size];
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
+#endif /* BUFFER_FREE_LIST */
   data->m_count = 1;
   return data;
 }
@@ -181,8 +137,12 @@ Buffer::Deallocate (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
+#ifdef BUFFER_FREE_LIST
+  PacketDataAllocator::Deallocate (data);
+#else /* BUFFER_FREE_LIST */
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
   delete [] buf;
+#endif /* BUFFER_FREE_LIST */
 }
 
 Buffer::Buffer ()
@@ -370,25 +330,9 @@ Buffer::AddAtEnd (uint32_t end)
     } 
   else
     {
-      uint32_t newSize = GetInternalSize () + end;
-      struct Buffer::Data *newData = Buffer::Create (newSize);
-      memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
-        {
-          Buffer::Recycle (m_data);
-        }
-      m_data = newData;
-
-      int32_t delta = -m_start;
-      m_zeroAreaStart += delta;
-      m_zeroAreaEnd += delta;
-      m_end += delta;
-      m_start += delta;
+      Reallocate (GetInternalSize () + end);
       m_end += end;
-
       // update dirty area
-      m_data->m_dirtyStart = m_start;
       m_data->m_dirtyEnd = m_end;
     } 
   m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
@@ -396,10 +340,73 @@ Buffer::AddAtEnd (uint32_t end)
   NS_ASSERT (CheckInternalState ());
 }
 
+void
+Buffer::Reallocate (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (size >= GetInternalSize ());
+  struct Buffer::Data *newData = Buffer::Create (size);
+  memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
+  m_data->m_count--;
+  if (m_data->m_count == 0) 
+    {
+      Buffer::Recycle (m_data);
+    }
+  m_data = newData;
+
+  int32_t delta = -m_start;
+  m_zeroAreaStart += delta;
+  m_zeroAreaEnd += delta;
+  m_end += delta;
+  m_start += delta;
+
+  // update dirty area
+  m_data->m_dirtyStart = m_start;
+  m_data->m_dirtyEnd = m_end;
+}
+
 void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  if (GetSize () == 0)
+    {
+      /* share the storage of the other buffer.  The dirty area
+       * makes sure that the data is copied before either buffer
+       * overwrites the bytes of the other one. */
+      uint32_t maxZeroAreaStart = m_maxZeroAreaStart;
+      *this = o;
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, maxZeroAreaStart);
+      return;
+    }
+  if (m_data == o.m_data &&
+      GetInternalEnd () == o.m_start &&
+      (m_zeroAreaStart == m_zeroAreaEnd || o.m_zeroAreaStart == o.m_zeroAreaEnd))
+    {
+      /* the other buffer is a fragment which follows this one in
+       * the same storage, as when fragments created with
+       * CreateFragment are reassembled in order: just extend this
+       * buffer over it.  At most one of the two buffers may have a
+       * zero area, which becomes the zero area of the result. */
+      if (m_zeroAreaStart == m_zeroAreaEnd &&
+          o.m_zeroAreaStart != o.m_zeroAreaEnd)
+        {
+          /* without zero area, the offsets of this buffer are the
+           * offsets of its data in the storage, as are the offsets
+           * of the other buffer before its zero area. */
+          m_zeroAreaStart = o.m_zeroAreaStart;
+          m_zeroAreaEnd = o.m_zeroAreaEnd;
+          m_end = o.m_end;
+        }
+      else
+        {
+          m_end += o.GetSize ();
+        }
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+      LOG_INTERNAL_STATE ("join end=" << o.GetSize () << ", ");
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
   if (m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
@@ -426,10 +433,20 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  *this = CreateFullCopy ();
-  AddAtEnd (o.GetSize ());
+  uint32_t size = o.GetSize ();
+  bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+  if (GetInternalEnd () + size > m_data->m_size || isDirty ||
+      m_data == o.m_data)
+    {
+      /* grow the storage geometrically so that aggregating many
+       * buffers one after the other copies each byte a bounded
+       * number of times.  The other buffer is never copied into
+       * the storage it reads from. */
+      Reallocate (std::max (GetInternalSize () + size, 2 * GetInternalSize ()));
+    }
+  AddAtEnd (size);
   Buffer::Iterator destStart = End ();
-  destStart.Prev (o.GetSize ());
+  destStart.Prev (size);
   destStart.Write (o.Begin (), o.End ());
   NS_ASSERT (CheckInternalState ());
 }
@@ -527,6 +544,26 @@ Buffer::CreateFragment (uint32_t start, uint32_t length) const
   return tmp;
 }
 
+void
+Buffer::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  if (m_data->m_count == 1)
+    {
+      return;
+    }
+  uint32_t end = GetInternalEnd ();
+  struct Buffer::Data *newData = Create (m_data->m_size);
+  memcpy (newData->m_data + m_start, m_data->m_data + m_start, end - m_start);
+  newData->m_dirtyStart = m_start;
+  newData->m_dirtyEnd = end;
+  // the count was larger than one, the old data is still referenced.
+  m_data->m_count--;
+  m_data = newData;
+  NS_ASSERT (CheckInternalState ());
+}
+
 Buffer 
 Buffer::CreateFullCopy (void) const
 {
@@ -843,27 +880,37 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  /* the written area does not overlap the zero area of this buffer,
+   * so it is either entirely before or entirely after it. */
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
@@ -1136,24 +1183,126 @@ Buffer::Iterator::CalculateIpChecksum (uint16_t size)
   return CalculateIpChecksum (size, 0);
 }
 
+/**
+ * \brief Sum the 16-bit words of a contiguous span of bytes.
+ *
+ * The words are read in little-endian order, as with
+ * Buffer::Iterator::ReadU16, and a last odd byte is summed as the low
+ * byte of a word.  The bytes are read eight at a time.
+ *
+ * \param data the first byte of the span
+ * \param size the size of the span
+ * \returns the sum, folded to 16 bits
+ */
+static uint32_t
+SumWords (const uint8_t *data, uint32_t size)
+{
+  /* see RFC 1071: the ones' complement sum does not depend on the
+   * byte order used to read the words, provided it is consistent.
+   * 32-bit halves of 64-bit words are accumulated on 64 bits, so
+   * that the carries are folded only once at the end. */
+  uint64_t sum = 0;
+  while (size >= 8)
+    {
+      uint64_t word;
+      std::memcpy (&word, data, 8);
+      sum += (word & 0xffffffff) + (word >> 32);
+      data += 8;
+      size -= 8;
+    }
+  while (size >= 2)
+    {
+      uint16_t word;
+      std::memcpy (&word, data, 2);
+      sum += word;
+      data += 2;
+      size -= 2;
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  const uint16_t one = 1;
+  if (*reinterpret_cast<const uint8_t *> (&one) == 0)
+    {
+      // big-endian host: the words were summed with swapped bytes.
+      sum = ((sum & 0xff) << 8) | (sum >> 8);
+    }
+  if (size == 1)
+    {
+      sum += *data;
+    }
+  return sum;
+}
+
 uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  uint64_t sum = initialChecksum;
+  uint32_t offset = 0;
+  while (size > 0)
+    {
+      uint32_t span;
+      if (m_current < m_zeroStart)
+        {
+          span = std::min<uint32_t> (size, m_zeroStart - m_current);
+          sum += SumWords (&m_data[m_current], span) << (8 * (offset & 1));
+        }
+      else if (m_current < m_zeroEnd)
+        {
+          // the zero area adds nothing to the sum
+          span = std::min<uint32_t> (size, m_zeroEnd - m_current);
+        }
+      else
+        {
+          span = size;
+          sum += SumWords (&m_data[m_current - (m_zeroEnd - m_zeroStart)], span) << (8 * (offset & 1));
+        }
+      m_current += span;
+      offset += span;
+      size -= span;
+    }
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
   return ~sum;
 }
 
+uint32_t
+Buffer::Iterator::CalculateCrc32 (uint32_t size, uint32_t crc)
+{
+  NS_LOG_FUNCTION (this << size << crc);
+  NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  while (size > 0)
+    {
+      uint32_t span;
+      if (m_current < m_zeroStart)
+        {
+          span = std::min<uint32_t> (size, m_zeroStart - m_current);
+          crc = CRC32Update (crc, &m_data[m_current], span);
+        }
+      else if (m_current < m_zeroEnd)
+        {
+          span = std::min<uint32_t> (size, m_zeroEnd - m_current);
+          span = std::min<uint32_t> (span, g_zeroes.size);
+          crc = CRC32Update (crc, reinterpret_cast<const uint8_t *> (g_zeroes.buffer), span);
+        }
+      else
+        {
+          span = size;
+          crc = CRC32Update (crc, &m_data[m_current - (m_zeroEnd - m_zeroStart)], span);
+        }
+      m_current += span;
+      size -= span;
+    }
+  return crc;
+}
+
 uint32_t 
 Buffer::Iterator::GetSize (void) const
 {
@@ -365,12 +365,28 @@ public:
 
     /**
      * \brief Calculate the checksum.
+     *
+     * The bytes are summed span by span, without copying them, and the
+     * iterator is advanced by \p size bytes.
+     *
      * \param size size of the buffer.
      * \param initialChecksum initial value
      * \return checksum
      */
     uint16_t CalculateIpChecksum (uint16_t size, uint32_t initialChecksum);
 
+    /**
+     * \brief Calculate the CRC-32 of the next bytes.
+     *
+     * The bytes are read span by span, without copying them, and the
+     * iterator is advanced by \p size bytes.
+     *
+     * \param size the number of bytes to read.
+     * \param crc the CRC-32 of the preceding bytes, or zero.
+     * \return the CRC-32 of the preceding bytes followed by the bytes read
+     */
+    uint32_t CalculateCrc32 (uint32_t size, uint32_t crc = 0);
+
     /**
      * \returns the size of the underlying buffer we are iterating
      */
@@ -527,6 +543,11 @@ private:
    * Add bytes at the end of the Buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
+   *
+   * No byte is copied when this buffer is empty, or when \p o is
+   * a fragment which directly follows this buffer in the buffer
+   * they were both created from with CreateFragment: the buffers
+   * then share their storage.
    */
   void AddAtEnd (const Buffer &o);
   /**
@@ -555,6 +576,15 @@ private:
    */
   Buffer CreateFragment (uint32_t start, uint32_t length) const;
 
+  /**
+   * Copy the bytes of this buffer to a private data area if the
+   * current one is shared with other buffers.
+   *
+   * The reference count of the data area is not atomic: a buffer
+   * must be unshared before it is handed to another thread.
+   */
+  void Unshare (void);
+
   /**
    * \return an Iterator which points to the
    * start of this Buffer.
@@ -726,6 +756,16 @@ private:
    */
   uint32_t GetInternalEnd (void) const;
 
+  /**
+   * \brief Move the content of the buffer to a new data storage
+   *
+   * The zero area remains virtual, and the new storage is not shared.
+   *
+   * \param size the minimum size of the new storage, at least
+   *        GetInternalSize ()
+   */
+  void Reallocate (uint32_t size);
+
   /**
    * \brief Recycle the buffer memory
    * \param data the buffer data storage
@@ -765,9 +805,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Each thread keeps its own heuristic.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -791,16 +831,7 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  static thread_local uint32_t g_maxSize; //!< Data size hint of this thread, see Recycle
 #endif
 };
 
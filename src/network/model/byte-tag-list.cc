@@ -18,13 +18,14 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-data-allocator.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
 #include <limits>
+#include <algorithm>
 
 #define USE_FREE_LIST 1
-#define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max ())
 
 namespace ns3 {
@@ -48,28 +49,10 @@ struct ByteTagListData {
 #ifdef USE_FREE_LIST
 /**
  * \ingroup packet
- *
- * \brief Container class for struct ByteTagListData
- *
- * Internal use only.
+ * data size hint of this thread (used for allocation), bounded by
+ * the largest pooled block and decaying like the Buffer one
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
-
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
-{
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
+static thread_local uint32_t g_maxSize = 0;
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
@@ -251,6 +234,21 @@ ByteTagList::RemoveAll (void)
   m_used = 0;
 }
 
+void
+ByteTagList::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data == 0 || m_data->count == 1)
+    {
+      return;
+    }
+  struct ByteTagListData *newData = Allocate (m_used);
+  std::memcpy (&newData->data, &m_data->data, m_used);
+  newData->dirty = m_used;
+  Deallocate (m_data);
+  m_data = newData;
+}
+
 ByteTagList::Iterator 
 ByteTagList::BeginAll (void) const
 {
@@ -274,36 +272,68 @@ ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
     }
 }
 
-void 
-ByteTagList::AddAtEnd (int32_t appendOffset)
+void
+ByteTagList::Trim (int32_t lo, int32_t hi)
 {
-  NS_LOG_FUNCTION (this << appendOffset);
-  if (m_maxEnd <= appendOffset - m_adjustment)
+  NS_LOG_FUNCTION (this << lo << hi);
+  if (m_data == 0)
     {
       return;
     }
-  ByteTagList list;
-  ByteTagList::Iterator i = BeginAll ();
-  while (i.HasNext ())
+  if (m_data->count != 1)
     {
-      ByteTagList::Iterator::Item item = i.Next ();
-
-      if (item.start >= appendOffset)
-        {
-          continue;
-        }
-      if (item.end > appendOffset)
-        {
-          item.end = appendOffset;
-        }
-      TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
-      buf.CopyFrom (item.buf);
-      if (item.end > m_maxEnd)
+      struct ByteTagListData *newData = Allocate (m_used);
+      std::memcpy (&newData->data, &m_data->data, m_used);
+      Deallocate (m_data);
+      m_data = newData;
+    }
+  m_minStart = INT32_MAX;
+  m_maxEnd = INT32_MIN;
+  uint8_t *src = m_data->data;
+  uint8_t *dst = m_data->data;
+  uint8_t *end = &m_data->data[m_used];
+  while (src < end)
+    {
+      TagBuffer buf = TagBuffer (src, end);
+      buf.ReadU32 ();
+      uint32_t size = buf.ReadU32 ();
+      int32_t tagStart = buf.ReadU32 () + m_adjustment;
+      int32_t tagEnd = buf.ReadU32 () + m_adjustment;
+      uint32_t recordSize = 4 + 4 + 4 + 4 + size;
+      if (tagEnd > lo && tagStart < hi)
         {
-          m_maxEnd = item.end;
+          tagStart = std::max (tagStart, lo) - m_adjustment;
+          tagEnd = std::min (tagEnd, hi) - m_adjustment;
+          if (dst != src)
+            {
+              std::memmove (dst, src, recordSize);
+            }
+          buf = TagBuffer (dst + 4 + 4, dst + 4 + 4 + 4 + 4);
+          buf.WriteU32 (tagStart);
+          buf.WriteU32 (tagEnd);
+          m_minStart = std::min (m_minStart, tagStart);
+          m_maxEnd = std::max (m_maxEnd, tagEnd);
+          dst += recordSize;
         }
+      src += recordSize;
+    }
+  m_used = dst - m_data->data;
+  m_data->dirty = m_used;
+  if (m_used == 0)
+    {
+      RemoveAll ();
+    }
+}
+
+void 
+ByteTagList::AddAtEnd (int32_t appendOffset)
+{
+  NS_LOG_FUNCTION (this << appendOffset);
+  if (m_maxEnd <= appendOffset - m_adjustment)
+    {
+      return;
     }
-  *this = list;
+  Trim (0, appendOffset);
 }
 
 void 
@@ -314,29 +344,7 @@ ByteTagList::AddAtStart (int32_t prependOffset)
     {
       return;
     }
-  m_minStart = INT32_MAX;
-  ByteTagList list;
-  ByteTagList::Iterator i = BeginAll ();
-  while (i.HasNext ())
-    {
-      ByteTagList::Iterator::Item item = i.Next ();
-
-      if (item.end <= prependOffset)
-        {
-          continue;
-        }
-      if (item.start < prependOffset)
-        {
-          item.start = prependOffset;
-        }
-      TagBuffer buf = list.Add (item.tid, item.size, item.start, item.end);
-      buf.CopyFrom (item.buf);
-      if (item.start < m_minStart)
-        {
-          m_minStart = item.start;
-        }
-    }
-  *this = list;
+  Trim (std::max (prependOffset, 0), OFFSET_MAX);
 }
 
 #ifdef USE_FREE_LIST
@@ -345,24 +353,12 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
-    {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
-      NS_ASSERT (data != 0);
-      if (data->size >= size)
-        {
-          data->count = 1;
-          data->dirty = 0;
-          return data;
-        }
-      uint8_t *buffer = (uint8_t *)data;
-      delete [] buffer;
-    }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
-  struct ByteTagListData *data = (struct ByteTagListData *)buffer;
+  uint32_t capacity;
+  void *buffer = PacketDataAllocator::Allocate (std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4,
+                                                capacity);
+  struct ByteTagListData *data = static_cast<struct ByteTagListData *> (buffer);
   data->count = 1;
-  data->size = size;
+  data->size = capacity - sizeof (struct ByteTagListData) + 4;
   data->dirty = 0;
   return data;
 }
@@ -375,20 +371,21 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  g_maxSize = std::max (g_maxSize, data->size);
+  uint32_t maxPooled = PacketDataAllocator::GetMaxPooledCapacity () - sizeof (struct ByteTagListData) + 4;
+  uint32_t size = std::min (data->dirty, maxPooled);
+  if (size >= g_maxSize)
+    {
+      g_maxSize = size;
+    }
+  else
+    {
+      g_maxSize -= (g_maxSize - size) / 8;
+    }
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
-          data->size < g_maxSize)
-        {
-          uint8_t *buffer = (uint8_t *)data;
-          delete [] buffer;
-        }
-      else
-        {
-          g_freeList.push_back (data);
-        }
+      /* the allocator keeps the block in the free list of its thread */
+      PacketDataAllocator::Deallocate (data);
     }
 }
 
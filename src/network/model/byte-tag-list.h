@@ -194,6 +194,15 @@ private:
    */ 
   void RemoveAll (void);
 
+  /**
+   * Copy the tags to a private data area if the current one is shared
+   * with other lists.
+   *
+   * The reference count of the data area is not atomic: the list must
+   * be unshared before it is handed to another thread.
+   */
+  void Unshare (void);
+
   /**
    * \param offsetStart the offset which uniquely identifies the first data byte 
    *        present in the byte buffer associated to this ByteTagList.
@@ -239,6 +248,17 @@ private:
    */
   ByteTagList::Iterator BeginAll (void) const;
 
+  /**
+   * \brief Cut the byte tags to the bytes between \p lo and \p hi.
+   *
+   * Tags which do not overlap [lo, hi) are removed.  The tags are
+   * modified in place, after a single copy if the data is shared.
+   *
+   * \param lo minimum offset value
+   * \param hi maximum offset value
+   */
+  void Trim (int32_t lo, int32_t hi);
+
   /**
    * \brief Allocate the memory for the ByteTagListData
    * \param size the memory to allocate
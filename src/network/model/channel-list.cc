@@ -19,6 +19,7 @@
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/config.h"
+#include "ns3/replication-runner.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "channel-list.h"
@@ -129,13 +130,16 @@ ChannelListPriv::DoGet (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
   static Ptr<ChannelListPriv> ptr = 0;
-  if (ptr == 0)
+  // Each replication run by a ReplicationRunner has its own list.
+  static thread_local Ptr<ChannelListPriv> replicationPtr = 0;
+  Ptr<ChannelListPriv> *pptr = ReplicationRunner::IsReplicationThread () ? &replicationPtr : &ptr;
+  if (*pptr == 0)
     {
-      ptr = CreateObject<ChannelListPriv> ();
-      Config::RegisterRootNamespaceObject (ptr);
+      *pptr = CreateObject<ChannelListPriv> ();
+      Config::RegisterRootNamespaceObject (*pptr);
       Simulator::ScheduleDestroy (&ChannelListPriv::Delete);
     }
-  return &ptr;
+  return pptr;
 }
 
 void 
@@ -20,6 +20,7 @@
 
 #include "header.h"
 #include "ns3/log.h"
+#include "ns3/fatal-error.h"
 
 namespace ns3 {
 
@@ -42,6 +43,21 @@ Header::GetTypeId (void)
   return tid;
 }
 
+Header *
+Header::Clone (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 0;
+}
+
+void
+Header::Assign (const Header &header)
+{
+  NS_LOG_FUNCTION (this << &header);
+  NS_FATAL_ERROR ("Header " << GetInstanceTypeId ().GetName () <<
+                  " cannot be assigned");
+}
+
 std::ostream & operator << (std::ostream &os, const Header &header)
 {
   header.Print (os);
@@ -101,6 +101,26 @@ public:
    * i.e.: (field1 val1 field2 val2 field3 val3) field4 val4 field5 val5
    */
   virtual void Print (std::ostream &os) const = 0;
+  /**
+   * \returns a copy of this header allocated with new, or zero if
+   *          this header must always be serialized.
+   *
+   * When Packet::EnableLazyHeaders has been called, Packet::AddHeader
+   * keeps the returned copy instead of serializing the header, and
+   * serializes it only when the bytes of the packet are needed.
+   * Headers which override this method must also override Assign.
+   * The default implementation returns zero.
+   */
+  virtual Header *Clone (void) const;
+  /**
+   * \param header a header of the same type as this header.
+   *
+   * Set this header to the value of \p header.  This method is used
+   * by Packet::RemoveHeader and Packet::PeekHeader instead of
+   * Deserialize when the header was not serialized in the packet.
+   * The default implementation aborts.
+   */
+  virtual void Assign (const Header &header);
 };
 
 
@@ -19,6 +19,9 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/packet-burst.h"
+#include "ns3/net-device-queue-interface.h"
 #include "net-device.h"
 
 namespace ns3 {
@@ -41,4 +44,41 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+NetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+  Ptr<NetDeviceQueue> txQueue = GetBurstTxQueue ();
+  uint32_t sent = 0;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      if (txQueue != 0 && txQueue->IsStopped ())
+        {
+          break;
+        }
+      if (Send (*i, dest, protocolNumber))
+        {
+          sent++;
+        }
+    }
+  return sent;
+}
+
+Ptr<NetDeviceQueue>
+NetDevice::GetBurstTxQueue (void) const
+{
+  Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+  if (ndqi == 0 || ndqi->GetNTxQueues () != 1)
+    {
+      return 0;
+    }
+  return ndqi->GetTxQueue (0);
+}
+
+void
+NetDevice::SetReceiveBurstCallback (ReceiveBurstCallback cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+}
+
 } // namespace ns3
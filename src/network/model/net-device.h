@@ -26,6 +26,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "packet.h"
+#include "ns3/packet-burst.h"
 #include "address.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -34,6 +35,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class NetDeviceQueue;
 
 /**
  * \ingroup network
@@ -260,6 +262,28 @@ public:
    * \return whether the Send operation succeeded 
    */
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber) = 0;
+  /**
+   * \param burst packets sent from above down to Network Device
+   * \param dest mac address of the destination (already resolved)
+   * \param protocolNumber identifies the type of payload contained in
+   *        the packets of the burst.
+   *
+   *  Called from higher layer to send several packets to the same
+   *  destination in one call.  The packets are sent in order, through
+   *  the same queue and traces as if Send had been called for each of
+   *  them; devices override this method to perform the per-call checks
+   *  once per burst, and may hand the packets to the channel together.
+   *  The default implementation calls Send for each packet.
+   *
+   *  If the device has a NetDeviceQueueInterface with a single
+   *  transmission queue, the burst ends at the first packet which finds
+   *  that queue stopped: as the traffic control layer checks the queue
+   *  before each Send, the remaining packets are neither sent nor traced
+   *  by the device.
+   *
+   * \return the number of packets accepted by the device
+   */
+  virtual uint32_t SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   /**
    * \returns the node base class which contains this network
    *          interface.
@@ -326,6 +350,29 @@ public:
    */
   virtual void SetReceiveCallback (ReceiveCallback cb) = 0;
 
+  /**
+   * \param device a pointer to the net device which is calling this callback
+   * \param burst the packets received, in order of arrival
+   * \param protocol the 16 bit protocol number associated with the packets.
+   * \param sender the address of the sender
+   * \returns true if the callback could handle the packets successfully, false
+   *          otherwise.
+   */
+  typedef Callback< bool, Ptr<NetDevice>, Ptr<const PacketBurst>, uint16_t, const Address & > ReceiveBurstCallback;
+
+  /**
+   * \param cb callback to invoke whenever several packets with the same
+   *        protocol and sender have been received together and must be
+   *        forwarded to the higher layers.
+   *
+   * Devices which can receive packets in bursts deliver them through this
+   * callback when it is set and promiscuous mode is disabled; otherwise,
+   * and for devices which do not override this method, every packet is
+   * delivered through the ReceiveCallback.  The default implementation
+   * ignores the callback.
+   */
+  virtual void SetReceiveBurstCallback (ReceiveBurstCallback cb);
+
 
   /**
    * \param device a pointer to the net device which is calling this callback
@@ -359,6 +406,14 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+protected:
+  /**
+   * Get the transmission queue whose state ends a burst, see SendBurst.
+   *
+   * eturn the queue of a device with a NetDeviceQueueInterface and a
+   *         single transmission queue, or 0.
+   */
+  Ptr<NetDeviceQueue> GetBurstTxQueue (void) const;
 };
 
 } // namespace ns3
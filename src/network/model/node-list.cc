@@ -22,6 +22,7 @@
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/config.h"
+#include "ns3/replication-runner.h"
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "node-list.h"
@@ -131,13 +132,16 @@ NodeListPriv::DoGet (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
   static Ptr<NodeListPriv> ptr = 0;
-  if (ptr == 0)
+  // Each replication run by a ReplicationRunner has its own list.
+  static thread_local Ptr<NodeListPriv> replicationPtr = 0;
+  Ptr<NodeListPriv> *pptr = ReplicationRunner::IsReplicationThread () ? &replicationPtr : &ptr;
+  if (*pptr == 0)
     {
-      ptr = CreateObject<NodeListPriv> ();
-      Config::RegisterRootNamespaceObject (ptr);
+      *pptr = CreateObject<NodeListPriv> ();
+      Config::RegisterRootNamespaceObject (*pptr);
       Simulator::ScheduleDestroy (&NodeListPriv::Delete);
     }
-  return &ptr;
+  return pptr;
 }
 void 
 NodeListPriv::Delete (void)
@@ -24,6 +24,7 @@
 #include "net-device.h"
 #include "application.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/simulator.h"
 #include "ns3/object-vector.h"
 #include "ns3/uinteger.h"
@@ -133,6 +134,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
+  device->SetReceiveBurstCallback (MakeCallback (&Node::NonPromiscReceiveBurstFromDevice, this));
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
@@ -185,6 +187,7 @@ Node::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_deviceAdditionListeners.clear ();
   m_handlers.clear ();
+  InvalidateProtocolHandlerIndex ();
   for (std::vector<Ptr<NetDevice> >::iterator i = m_devices.begin ();
        i != m_devices.end (); i++)
     {
@@ -255,6 +258,24 @@ Node::RegisterProtocolHandler (ProtocolHandler handler,
     }
 
   m_handlers.push_back (entry);
+  InvalidateProtocolHandlerIndex ();
+}
+
+void
+Node::RegisterProtocolHandler (ProtocolHandler handler,
+                               BurstProtocolHandler burstHandler,
+                               uint16_t protocolType,
+                               Ptr<NetDevice> device)
+{
+  NS_LOG_FUNCTION (this << &handler << &burstHandler << protocolType << device);
+  struct Node::ProtocolHandlerEntry entry;
+  entry.handler = handler;
+  entry.burstHandler = burstHandler;
+  entry.protocol = protocolType;
+  entry.device = device;
+  entry.promiscuous = false;
+  m_handlers.push_back (entry);
+  InvalidateProtocolHandlerIndex ();
 }
 
 void
@@ -267,6 +288,7 @@ Node::UnregisterProtocolHandler (ProtocolHandler handler)
       if (i->handler.IsEqual (handler))
         {
           m_handlers.erase (i);
+          InvalidateProtocolHandlerIndex ();
           break;
         }
     }
@@ -297,6 +319,38 @@ Node::NonPromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> pack
   return ReceiveFromDevice (device, packet, protocol, from, device->GetAddress (), NetDevice::PacketType (0), false);
 }
 
+bool
+Node::NonPromiscReceiveBurstFromDevice (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                        const Address &from)
+{
+  NS_LOG_FUNCTION (this << device << burst << protocol << &from);
+  NS_ASSERT_MSG (Simulator::GetContext () == GetId (), "Received packet with erroneous context ; " <<
+                 "make sure the channels in use are correctly updating events context " <<
+                 "when transferring events from one node to another.");
+  NS_LOG_DEBUG ("Node " << GetId () << " ReceiveBurstFromDevice:  dev "
+                        << device->GetIfIndex () << " (type=" << device->GetInstanceTypeId ().GetName ()
+                        << ") " << burst->GetNPackets () << " packets");
+  Address to = device->GetAddress ();
+  const std::vector<uint32_t> &handlers = LookupProtocolHandlers (device, protocol, false);
+
+  for (std::vector<uint32_t>::const_iterator i = handlers.begin (); i != handlers.end (); i++)
+    {
+      const ProtocolHandlerEntry &entry = m_handlers[*i];
+      if (!entry.burstHandler.IsNull ())
+        {
+          entry.burstHandler (device, burst, protocol, from, to, NetDevice::PacketType (0));
+        }
+      else
+        {
+          for (std::list<Ptr<Packet> >::const_iterator j = burst->Begin (); j != burst->End (); j++)
+            {
+              entry.handler (device, *j, protocol, from, to, NetDevice::PacketType (0));
+            }
+        }
+    }
+  return !handlers.empty ();
+}
+
 bool
 Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
                          const Address &from, const Address &to, NetDevice::PacketType packetType, bool promiscuous)
@@ -308,26 +362,49 @@ Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16
   NS_LOG_DEBUG ("Node " << GetId () << " ReceiveFromDevice:  dev "
                         << device->GetIfIndex () << " (type=" << device->GetInstanceTypeId ().GetName ()
                         << ") Packet UID " << packet->GetUid ());
-  bool found = false;
+  const std::vector<uint32_t> &handlers = LookupProtocolHandlers (device, protocol, promiscuous);
 
-  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
-       i != m_handlers.end (); i++)
+  for (std::vector<uint32_t>::const_iterator i = handlers.begin (); i != handlers.end (); i++)
+    {
+      m_handlers[*i].handler (device, packet, protocol, from, to, packetType);
+    }
+  return !handlers.empty ();
+}
+
+const std::vector<uint32_t> &
+Node::LookupProtocolHandlers (Ptr<NetDevice> device, uint16_t protocol, bool promiscuous)
+{
+  ProtocolHandlerKey key;
+  key.device = PeekPointer (device);
+  key.protocol = protocol;
+  ProtocolHandlerIndex &index = promiscuous ? m_promiscHandlerIndex : m_handlerIndex;
+  ProtocolHandlerIndex::iterator it = index.find (key);
+  if (it != index.end ())
+    {
+      return it->second;
+    }
+
+  NS_LOG_LOGIC ("Indexing the handlers of device " << device << " and protocol " << protocol);
+  std::vector<uint32_t> &handlers = index[key];
+  for (uint32_t i = 0; i < m_handlers.size (); i++)
     {
-      if (i->device == 0 ||
-          (i->device != 0 && i->device == device))
+      const ProtocolHandlerEntry &entry = m_handlers[i];
+      if ((entry.device == 0 || entry.device == device)
+          && (entry.protocol == 0 || entry.protocol == protocol)
+          && entry.promiscuous == promiscuous)
         {
-          if (i->protocol == 0 || 
-              i->protocol == protocol)
-            {
-              if (promiscuous == i->promiscuous)
-                {
-                  i->handler (device, packet, protocol, from, to, packetType);
-                  found = true;
-                }
-            }
+          handlers.push_back (i);
         }
     }
-  return found;
+  return handlers;
+}
+
+void
+Node::InvalidateProtocolHandlerIndex (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_handlerIndex.clear ();
+  m_promiscHandlerIndex.clear ();
 }
 void 
 Node::RegisterDeviceAdditionListener (DeviceAdditionListener listener)
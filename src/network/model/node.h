@@ -22,6 +22,7 @@
 #define NODE_H
 
 #include <vector>
+#include <unordered_map>
 
 #include "ns3/object.h"
 #include "ns3/callback.h"
@@ -174,6 +175,38 @@ public:
                                 uint16_t protocolType,
                                 Ptr<NetDevice> device,
                                 bool promiscuous=false);
+  /**
+   * A protocol handler for bursts of packets
+   *
+   * \param device a pointer to the net device which received the packets
+   * \param burst the packets received, in order of arrival
+   * \param protocol the 16 bit protocol number associated with the packets.
+   * \param sender the address of the sender
+   * \param receiver the address of the receiver, i.e., device->GetAddress()
+   * \param packetType type of packets received; Note: this value is not
+   *                   valid, as for non-promiscuous protocol handlers.
+   */
+  typedef Callback<void,Ptr<NetDevice>, Ptr<const PacketBurst>,uint16_t,const Address &,
+                   const Address &, NetDevice::PacketType> BurstProtocolHandler;
+  /**
+   * \param handler the handler to register
+   * \param burstHandler the handler invoked, instead of \p handler,
+   *        with the bursts of packets received through
+   *        NetDevice::ReceiveBurstCallback
+   * \param protocolType the type of protocol this handler is
+   *        interested in; the value zero is interpreted as matching all
+   *        protocols.
+   * \param device the device attached to this handler. If the
+   *        value is zero, the handler is attached to all
+   *        devices on this node.
+   *
+   * Handlers registered without a burst handler receive the packets of a
+   * burst one at a time.  Burst handlers are never promiscuous.
+   */
+  void RegisterProtocolHandler (ProtocolHandler handler,
+                                BurstProtocolHandler burstHandler,
+                                uint16_t protocolType,
+                                Ptr<NetDevice> device);
   /**
    * \param handler the handler to unregister
    *
@@ -247,6 +280,16 @@ private:
    */
   bool PromiscReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
                                  const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * \brief Receive a burst of packets from a device in non-promiscuous mode.
+   * \param device the device
+   * \param burst the packets
+   * \param protocol the protocol
+   * \param from the sender
+   * \returns true if the packets have been delivered to a protocol handler.
+   */
+  bool NonPromiscReceiveBurstFromDevice (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                         const Address &from);
   /**
    * \brief Receive a packet from a device.
    * \param device the device
@@ -272,6 +315,7 @@ private:
    */
   struct ProtocolHandlerEntry {
     ProtocolHandler handler; //!< the protocol handler
+    BurstProtocolHandler burstHandler; //!< the burst protocol handler, if any
     Ptr<NetDevice> device;   //!< the NetDevice
     uint16_t protocol;       //!< the protocol number
     bool promiscuous;        //!< true if it is a promiscuous handler
@@ -279,6 +323,61 @@ private:
 
   /// Typedef for protocol handlers container
   typedef std::vector<struct Node::ProtocolHandlerEntry> ProtocolHandlerList;
+
+  /**
+   * \brief Key of the protocol handler dispatch index.
+   */
+  struct ProtocolHandlerKey {
+    const NetDevice *device; //!< the receiving NetDevice
+    uint16_t protocol;       //!< the protocol number
+    /**
+     * \param o the other key
+     * \returns true if both keys are equal
+     */
+    bool operator == (const ProtocolHandlerKey &o) const
+    {
+      return device == o.device && protocol == o.protocol;
+    }
+  };
+  /**
+   * \brief Hash function of ProtocolHandlerKey.
+   */
+  struct ProtocolHandlerKeyHash {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    std::size_t operator () (const ProtocolHandlerKey &key) const
+    {
+      return std::hash<const NetDevice *> () (key.device) ^ (static_cast<std::size_t> (key.protocol) * 0x9e3779b1);
+    }
+  };
+  /**
+   * Typedef for the protocol handler dispatch index: the positions in
+   * m_handlers of the handlers matching a device and protocol, in
+   * registration order.
+   */
+  typedef std::unordered_map<ProtocolHandlerKey, std::vector<uint32_t>, ProtocolHandlerKeyHash> ProtocolHandlerIndex;
+
+  /**
+   * \brief Look up the protocol handlers of a received packet.
+   *
+   * The matching handlers of each device and protocol are found by a
+   * scan of m_handlers the first time, and then kept in the dispatch
+   * index until a handler is registered or unregistered.  Handlers must
+   * thus not be registered or unregistered while the returned list is
+   * in use.
+   *
+   * \param device the receiving device
+   * \param protocol the protocol number
+   * \param promiscuous true to look up the promiscuous handlers
+   * \returns the positions in m_handlers of the matching handlers
+   */
+  const std::vector<uint32_t> &LookupProtocolHandlers (Ptr<NetDevice> device, uint16_t protocol, bool promiscuous);
+  /**
+   * \brief Empty the dispatch indexes after a change of m_handlers.
+   */
+  void InvalidateProtocolHandlerIndex (void);
   /// Typedef for NetDevice addition listeners container
   typedef std::vector<DeviceAdditionListener> DeviceAdditionListenerList;
 
@@ -287,6 +386,8 @@ private:
   std::vector<Ptr<NetDevice> > m_devices; //!< Devices associated to this node
   std::vector<Ptr<Application> > m_applications; //!< Applications associated to this node
   ProtocolHandlerList m_handlers; //!< Protocol handlers in the node
+  ProtocolHandlerIndex m_handlerIndex; //!< Non-promiscuous handlers of each device and protocol
+  ProtocolHandlerIndex m_promiscHandlerIndex; //!< Promiscuous handlers of each device and protocol
   DeviceAdditionListenerList m_deviceAdditionListeners; //!< Device addition listeners in the node
 };
 
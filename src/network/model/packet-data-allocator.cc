@@ -0,0 +1,403 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "packet-data-allocator.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketDataAllocator");
+
+namespace {
+
+/** \ingroup packet Log2 of the size of the smallest blocks, header included. */
+const uint32_t PACKET_DATA_MIN_SHIFT = 6;
+/** \ingroup packet Number of size classes, from 64 bytes to 64 KiB. */
+const uint32_t PACKET_DATA_SIZE_CLASSES = 11;
+/** \ingroup packet Maximum number of blocks kept in each free list. */
+const uint32_t PACKET_DATA_FREE_LIST_MAX_SIZE = 1024;
+/** \ingroup packet Maximum number of bytes kept in each free list. */
+const uint32_t PACKET_DATA_FREE_LIST_MAX_BYTES = 4 << 20;
+
+struct ThreadCache;
+
+/**
+ * \ingroup packet
+ * The header which precedes each block.  Its size keeps the blocks
+ * aligned like the memory returned by the system allocator.
+ */
+struct BlockHeader
+{
+  ThreadCache *owner;  //!< The cache of the allocating thread, or 0.
+  uint32_t sizeClass;  //!< The size class, or PACKET_DATA_SIZE_CLASSES.
+  uint32_t padding;    //!< Unused.
+};
+
+/**
+ * \ingroup packet
+ * The first bytes of a released block, after its header.
+ */
+struct FreeBlock
+{
+  BlockHeader *next;  //!< The next released block.
+};
+
+/**
+ * \ingroup packet
+ * The free lists and the return queue of one thread.
+ */
+struct ThreadCache
+{
+  BlockHeader *head[PACKET_DATA_SIZE_CLASSES];  //!< The released blocks of each size class.
+  uint32_t size[PACKET_DATA_SIZE_CLASSES];      //!< The number of blocks of each size class.
+  /**
+   * The blocks released by other threads, or CLOSED once the thread
+   * has exited.
+   */
+  std::atomic<BlockHeader *> remote;
+  PacketDataAllocator::Statistics stats;        //!< The statistics of the thread.
+};
+
+/**
+ * \ingroup packet
+ * Owns the cache of the current thread, and gives it up when the
+ * thread exits.
+ */
+struct ThreadCacheHolder
+{
+  /** Close the cache of the thread. */
+  ~ThreadCacheHolder ();
+  ThreadCache *cache;  //!< The cache of the thread, created on demand.
+};
+
+/** \ingroup packet The cache holder of the current thread. */
+thread_local ThreadCacheHolder g_holder;
+/**
+ * \ingroup packet
+ * Set once the cache of the current thread has been closed, so that
+ * blocks allocated or released later by static destructors bypass it.
+ */
+thread_local bool g_holderDestroyed = false;
+
+/**
+ * \ingroup packet
+ * The marker of the return queue of a closed cache.  The blocks
+ * released to a closed cache are returned to the system allocator.
+ */
+BlockHeader g_closed;
+/** \ingroup packet The value of ThreadCache::remote once closed. */
+BlockHeader * const CLOSED = &g_closed;
+
+/**
+ * \ingroup packet
+ * \returns the mutex protecting the caches of the exited threads.
+ *
+ * It is never destroyed since threads can exit during the static
+ * destruction.
+ */
+std::mutex &
+GetOrphanMutex (void)
+{
+  static std::mutex *mutex = new std::mutex ();
+  return *mutex;
+}
+
+/**
+ * \ingroup packet
+ * \returns the caches of the exited threads, adopted by the new
+ * threads.  The caches are never destroyed since blocks allocated
+ * from them may still be alive.
+ */
+std::vector<ThreadCache *> &
+GetOrphans (void)
+{
+  static std::vector<ThreadCache *> *orphans = new std::vector<ThreadCache *> ();
+  return *orphans;
+}
+
+/**
+ * \ingroup packet
+ * \param [in] sizeClass a size class
+ * \returns the size of the blocks of the size class, header included
+ */
+inline uint32_t
+GetBlockSize (uint32_t sizeClass)
+{
+  return 1U << (sizeClass + PACKET_DATA_MIN_SHIFT);
+}
+
+/**
+ * \ingroup packet
+ * \param [in] sizeClass a size class
+ * \returns the maximum number of blocks kept in the free list of the
+ * size class.
+ */
+inline uint32_t
+GetMaxFreeListSize (uint32_t sizeClass)
+{
+  uint32_t max = PACKET_DATA_FREE_LIST_MAX_BYTES / GetBlockSize (sizeClass);
+  return std::min (PACKET_DATA_FREE_LIST_MAX_SIZE, std::max (16U, max));
+}
+
+/**
+ * \ingroup packet
+ * \param [in] block a block
+ * \returns the link of the released block
+ */
+inline FreeBlock *
+GetFreeBlock (BlockHeader *block)
+{
+  return reinterpret_cast<FreeBlock *> (block + 1);
+}
+
+/**
+ * \ingroup packet
+ * \param [in] cache a cache
+ * \param [in] block a block of the cache to keep in its free list,
+ *             or to return to the system allocator if the list is full.
+ */
+inline void
+PushLocal (ThreadCache *cache, BlockHeader *block)
+{
+  uint32_t sizeClass = block->sizeClass;
+  if (cache->size[sizeClass] >= GetMaxFreeListSize (sizeClass))
+    {
+      ::operator delete (block);
+      return;
+    }
+  GetFreeBlock (block)->next = cache->head[sizeClass];
+  cache->head[sizeClass] = block;
+  cache->size[sizeClass]++;
+}
+
+/**
+ * \ingroup packet
+ * Move the blocks released by other threads to the free lists.
+ * \param [in] cache the cache of the current thread
+ */
+void
+DrainRemote (ThreadCache *cache)
+{
+  BlockHeader *block = cache->remote.exchange (0, std::memory_order_acquire);
+  while (block != 0)
+    {
+      BlockHeader *next = GetFreeBlock (block)->next;
+      PushLocal (cache, block);
+      block = next;
+    }
+}
+
+/**
+ * \ingroup packet
+ * Release a block to the return queue of the thread which owns it.
+ * \param [in] block the block
+ */
+void
+PushRemote (BlockHeader *block)
+{
+  ThreadCache *owner = block->owner;
+  BlockHeader *head = owner->remote.load (std::memory_order_relaxed);
+  do
+    {
+      if (head == CLOSED)
+        {
+          ::operator delete (block);
+          return;
+        }
+      GetFreeBlock (block)->next = head;
+    }
+  while (!owner->remote.compare_exchange_weak (head, block,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+/**
+ * \ingroup packet
+ * \returns the cache of the current thread, or 0 if it was closed.
+ */
+inline ThreadCache *
+GetCache (void)
+{
+  if (g_holderDestroyed)
+    {
+      return 0;
+    }
+  ThreadCache *cache = g_holder.cache;
+  if (cache != 0)
+    {
+      return cache;
+    }
+  {
+    std::lock_guard<std::mutex> lock (GetOrphanMutex ());
+    std::vector<ThreadCache *> &orphans = GetOrphans ();
+    if (!orphans.empty ())
+      {
+        cache = orphans.back ();
+        orphans.pop_back ();
+      }
+  }
+  if (cache == 0)
+    {
+      cache = new ThreadCache ();
+      for (uint32_t i = 0; i < PACKET_DATA_SIZE_CLASSES; ++i)
+        {
+          cache->head[i] = 0;
+          cache->size[i] = 0;
+        }
+    }
+  cache->remote.store (0, std::memory_order_release);
+  cache->stats = PacketDataAllocator::Statistics ();
+  g_holder.cache = cache;
+  return cache;
+}
+
+ThreadCacheHolder::~ThreadCacheHolder ()
+{
+  g_holderDestroyed = true;
+  if (cache == 0)
+    {
+      return;
+    }
+  BlockHeader *block = cache->remote.exchange (CLOSED, std::memory_order_acquire);
+  while (block != 0)
+    {
+      BlockHeader *next = GetFreeBlock (block)->next;
+      ::operator delete (block);
+      block = next;
+    }
+  for (uint32_t i = 0; i < PACKET_DATA_SIZE_CLASSES; ++i)
+    {
+      while (cache->head[i] != 0)
+        {
+          block = cache->head[i];
+          cache->head[i] = GetFreeBlock (block)->next;
+          ::operator delete (block);
+        }
+      cache->size[i] = 0;
+    }
+  std::lock_guard<std::mutex> lock (GetOrphanMutex ());
+  GetOrphans ().push_back (cache);
+  cache = 0;
+}
+
+} // unnamed namespace
+
+void *
+PacketDataAllocator::Allocate (uint32_t size, uint32_t &capacity)
+{
+  NS_LOG_FUNCTION (size);
+  uint64_t total = static_cast<uint64_t> (size) + sizeof (BlockHeader);
+  uint32_t sizeClass = 0;
+  while (sizeClass < PACKET_DATA_SIZE_CLASSES && GetBlockSize (sizeClass) < total)
+    {
+      sizeClass++;
+    }
+  if (sizeClass == PACKET_DATA_SIZE_CLASSES)
+    {
+      BlockHeader *block = static_cast<BlockHeader *> (::operator new (total));
+      block->owner = 0;
+      block->sizeClass = PACKET_DATA_SIZE_CLASSES;
+      capacity = size;
+      return block + 1;
+    }
+  ThreadCache *cache = GetCache ();
+  BlockHeader *block = 0;
+  if (cache != 0)
+    {
+      if (cache->head[sizeClass] == 0
+          && cache->remote.load (std::memory_order_relaxed) != 0)
+        {
+          DrainRemote (cache);
+        }
+      block = cache->head[sizeClass];
+      if (block != 0)
+        {
+          cache->head[sizeClass] = GetFreeBlock (block)->next;
+          cache->size[sizeClass]--;
+          cache->stats.hits++;
+        }
+      else
+        {
+          cache->stats.misses++;
+        }
+    }
+  if (block == 0)
+    {
+      block = static_cast<BlockHeader *> (::operator new (GetBlockSize (sizeClass)));
+      block->owner = cache;
+      block->sizeClass = sizeClass;
+    }
+  NS_ASSERT (block->owner == cache && block->sizeClass == sizeClass);
+  capacity = GetBlockSize (sizeClass) - sizeof (BlockHeader);
+  return block + 1;
+}
+
+void
+PacketDataAllocator::Deallocate (void *p)
+{
+  NS_LOG_FUNCTION (p);
+  BlockHeader *block = static_cast<BlockHeader *> (p) - 1;
+  if (block->owner == 0)
+    {
+      ::operator delete (block);
+      return;
+    }
+  ThreadCache *cache = g_holderDestroyed ? 0 : g_holder.cache;
+  if (block->owner == cache)
+    {
+      PushLocal (cache, block);
+      return;
+    }
+  if (cache != 0)
+    {
+      cache->stats.remoteFrees++;
+    }
+  PushRemote (block);
+}
+
+uint32_t
+PacketDataAllocator::GetMaxPooledCapacity (void)
+{
+  return GetBlockSize (PACKET_DATA_SIZE_CLASSES - 1) - sizeof (BlockHeader);
+}
+
+PacketDataAllocator::Statistics
+PacketDataAllocator::GetStatistics (void)
+{
+  ThreadCache *cache = GetCache ();
+  if (cache == 0)
+    {
+      return Statistics ();
+    }
+  return cache->stats;
+}
+
+void
+PacketDataAllocator::ResetStatistics (void)
+{
+  ThreadCache *cache = GetCache ();
+  if (cache != 0)
+    {
+      cache->stats = Statistics ();
+    }
+}
+
+} // namespace ns3
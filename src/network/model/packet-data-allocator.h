@@ -0,0 +1,89 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_DATA_ALLOCATOR_H
+#define PACKET_DATA_ALLOCATOR_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief per-thread allocator of the memory blocks holding packet data.
+ *
+ * The Packet objects and their Buffer, PacketMetadata, ByteTagList
+ * and PacketTagList data structures are allocated from this
+ * allocator, which keeps the released blocks in free lists private
+ * to each thread, sorted by power-of-two size classes.  Allocations
+ * and releases by the thread which owns a block hence need neither
+ * locks nor atomic operations.
+ *
+ * A block released by another thread, as happens when a packet crosses
+ * threads, is pushed on a lock-free return queue of the thread which
+ * allocated it; that thread moves the content of the queue to its free
+ * lists the next time one of them is empty.  The free lists of a
+ * thread are released when it exits.
+ *
+ * This class is mostly private to the Packet implementation and users
+ * should never have to access it directly.
+ */
+class PacketDataAllocator
+{
+public:
+  /**
+   * The statistics of the allocations of one thread.
+   */
+  struct Statistics
+  {
+    uint64_t hits;        //!< allocations served from a free list
+    uint64_t misses;      //!< allocations served by the system allocator
+    uint64_t remoteFrees; //!< blocks released to the queue of another thread
+  };
+
+  /**
+   * \brief Allocate a block.
+   *
+   * \param size the minimum size of the block, in bytes
+   * \param capacity output parameter set to the usable size of the
+   *        block, which is at least \p size
+   * \returns a pointer to the block, suitably aligned for any type
+   */
+  static void *Allocate (uint32_t size, uint32_t &capacity);
+  /**
+   * \brief Release a block allocated by Allocate, from any thread.
+   *
+   * \param block the block to release
+   */
+  static void Deallocate (void *block);
+  /**
+   * \returns the capacity of the largest blocks kept in the free lists.
+   * Larger blocks come from the system allocator and are never reused.
+   */
+  static uint32_t GetMaxPooledCapacity (void);
+  /**
+   * \returns the statistics of the allocations of the calling thread.
+   */
+  static struct Statistics GetStatistics (void);
+  /**
+   * \brief Reset the statistics of the calling thread.
+   */
+  static void ResetStatistics (void);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_DATA_ALLOCATOR_H */
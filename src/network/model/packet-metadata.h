@@ -154,12 +154,27 @@ private:
 
   /**
    * \brief Enable the packet metadata
+   *
+   * This has no effect if packet metadata was compiled out.
    */
   static void Enable (void);
   /**
    * \brief Enable the packet metadata checking
+   *
+   * This has no effect if packet metadata was compiled out.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Check whether packet metadata is compiled in.
+   *
+   * Non-debug builds configured with --disable-packet-metadata define
+   * NS3_PACKET_METADATA_DISABLED: PacketMetadata objects then own no
+   * storage, Packet skips every metadata update and Packet::Print
+   * prints nothing.
+   *
+   * \returns false if packet metadata was compiled out.
+   */
+  inline static bool IsAvailable (void);
 
   /**
    * \brief Constructor
@@ -218,6 +233,15 @@ private:
    */
   PacketMetadata CreateFragment (uint32_t start, uint32_t end) const;
 
+  /**
+   * \brief Copy the items to a private data area if the current one is
+   * shared with other packets.
+   *
+   * The reference count of the data area is not atomic: the metadata
+   * must be unshared before it is handed to another thread.
+   */
+  void Unshare (void);
+
   /**
    * \brief Add a metadata at the metadata start
    * \param o the metadata to add
@@ -494,16 +518,6 @@ private:
     uint64_t packetUid;
   };
 
-  /**
-   * \brief Class to hold all the metadata
-   */
-  class DataFreeList : public std::vector<struct Data *>
-  {
-public:
-    ~DataFreeList ();
-  };
-
-  friend DataFreeList::~DataFreeList ();
   /// Friend class
   friend class ItemIterator;
 
@@ -661,7 +675,6 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -672,8 +685,8 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size in this thread
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -691,13 +704,28 @@ public:
 
 namespace ns3 {
 
+bool
+PacketMetadata::IsAvailable (void)
+{
+#ifdef NS3_PACKET_METADATA_DISABLED
+  return false;
+#else
+  return true;
+#endif
+}
+
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
+  if (!IsAvailable ())
+    {
+      return;
+    }
+  m_data = PacketMetadata::Create (10);
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
     {
@@ -711,6 +739,10 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
+  if (!IsAvailable ())
+    {
+      return;
+    }
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
   m_data->m_count++;
@@ -739,6 +771,10 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
+  if (!IsAvailable ())
+    {
+      return;
+    }
   NS_ASSERT (m_data != 0);
   m_data->m_count--;
   if (m_data->m_count == 0) 
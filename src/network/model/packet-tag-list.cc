@@ -20,285 +20,224 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a list of Packet tags, including copy-on-write semantics.
 */
 
 #include "packet-tag-list.h"
+#include "packet-data-allocator.h"
 #include "tag-buffer.h"
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <cstddef>
 #include <cstring>
+#include <algorithm>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-PacketTagList::TagData *
-PacketTagList::CreateTagData (size_t dataSize)
+uint32_t
+PacketTagList::GetRecordSize (uint32_t dataSize)
 {
-  NS_ASSERT_MSG (dataSize
-                 < std::numeric_limits<decltype(TagData::size)>::max (),
-                 "Requested TagData size " << dataSize
-                 << " exceeds maximum "
-                 << std::numeric_limits<decltype(TagData::size)>::max () );
+  // keep the records aligned on 8 bytes
+  return (offsetof (TagData, data) + dataSize + 7) & ~7;
+}
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+uint8_t *
+PacketTagList::GetRecords (TagListData *data, uint32_t offset)
+{
+  return reinterpret_cast<uint8_t *> (data) + offsetof (TagListData, data) + offset;
+}
 
-  TagData * tag = new (p) TagData;
-  tag->size = dataSize;
-  return tag;
+uint64_t
+PacketTagList::GetMaskBit (TypeId tid)
+{
+  return static_cast<uint64_t> (1) << (tid.GetUid () % 64);
 }
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+PacketTagList::TagListData *
+PacketTagList::Allocate (uint32_t dataSize)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
+  uint32_t capacity;
+  void *p = PacketDataAllocator::Allocate (offsetof (TagListData, data) + dataSize,
+                                           capacity);
+  // The matching release is in Deallocate
+  TagListData *data = static_cast<TagListData *> (p);
+  data->count = 1;
+  data->size = capacity - offsetof (TagListData, data);
+  data->start = data->size;
+  data->mask = 0;
+  return data;
+}
+
+void
+PacketTagList::Deallocate (TagListData *data)
+{
+  NS_ASSERT (data->count == 0);
+  PacketDataAllocator::Deallocate (data);
+}
 
-  // trivial case when list is empty
-  if (m_next == 0)
+void
+PacketTagList::Unshare (uint32_t space)
+{
+  if ((m_data == 0 && space == 0)
+      || (m_data != 0 && m_data->count == 1 && m_data->start >= space))
     {
-      return false;
+      return;
     }
-
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
-
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+  NS_LOG_FUNCTION (this << space);
+  uint32_t used = m_data != 0 ? m_data->size - m_data->start : 0;
+  // leave room for a few more tags
+  TagListData *data = Allocate (2 * (used + space));
+  if (m_data != 0)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
-        {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
-        }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
+      data->start = data->size - used;
+      data->mask = m_data->mask;
+      std::memcpy (GetRecords (data, data->start), GetRecords (m_data, m_data->start), used);
+      RemoveAll ();
+    }
+  m_data = data;
+}
 
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
+struct PacketTagList::TagData *
+PacketTagList::Find (TypeId tid) const
+{
+  if (m_data == 0 || (m_data->mask & GetMaskBit (tid)) == 0)
     {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      return 0;
     }
-
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+  for (const TagData *cur = Head (); cur != End (); cur = Next (cur))
     {
-      if (it->tid == tid)
+      if (cur->tid == tid)
         {
-          break;
+          return const_cast<TagData *> (cur);
         }
     }
-  if (it == 0)
-    {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
-    }
-
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
-    {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = CreateTagData (cur->size);
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->size = cur->size;
-      memcpy (copy->data, cur->data, copy->size);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
-    }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
-}
-
-bool
-PacketTagList::Remove (Tag & tag)
-{
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  return 0;
 }
 
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
+void
+PacketTagList::Erase (struct TagData *data)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
+  NS_LOG_FUNCTION (this << data);
+  // the records which precede data are moved over it
+  uint32_t offset = reinterpret_cast<uint8_t *> (data) - GetRecords (m_data, m_data->start);
+  uint32_t recordSize = GetRecordSize (data->size);
+  if (m_data->size - m_data->start == recordSize)
     {
-      // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      RemoveAll ();
+      return;
     }
-  else
+  Unshare (0);
+  std::memmove (GetRecords (m_data, m_data->start + recordSize),
+                GetRecords (m_data, m_data->start), offset);
+  m_data->start += recordSize;
+  m_data->mask = 0;
+  for (const TagData *cur = Head (); cur != End (); cur = Next (cur))
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
-        {
-          // there's a next, so make it a merge
-          cur->next->count++;
-        }
+      m_data->mask |= GetMaskBit (cur->tid);
     }
-  return found;
 }
 
 bool
-PacketTagList::Replace (Tag & tag)
+PacketTagList::Remove (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TagData *cur = Find (tag.GetInstanceTypeId ());
+  if (cur == 0)
     {
-      Add (tag);
+      return false;
     }
-  return found;
+  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
+  Erase (cur);
+  return true;
 }
 
-// COWWriter implementing Replace
 bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
+PacketTagList::Replace (Tag & tag)
 {
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
+  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TagData *cur = Find (tag.GetInstanceTypeId ());
+  if (cur == 0)
     {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+      Add (tag);
+      return false;
     }
-  else
+  if (cur->size != tag.GetSerializedSize ())
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
+      Erase (cur);
+      Add (tag);
+      return true;
     }
-  return found;
+  // rewrite the tag in place, in our own copy of the block
+  uint32_t offset = reinterpret_cast<uint8_t *> (cur) - GetRecords (m_data, m_data->start);
+  Unshare (0);
+  cur = reinterpret_cast<TagData *> (GetRecords (m_data, m_data->start + offset));
+  tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
+  return true;
 }
 
 void 
 PacketTagList::Add (const Tag &tag) const
 {
-  NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
-    {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
-    }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
-  head->count = 1;
-  head->next = 0;
-  head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
+  NS_ASSERT_MSG (Find (tid) == 0,
+                 "Error: cannot add the same kind of tag twice.");
+  uint32_t size = tag.GetSerializedSize ();
+  uint32_t recordSize = GetRecordSize (size);
+  PacketTagList *self = const_cast<PacketTagList *> (this);
+  self->Unshare (recordSize);
+  m_data->start -= recordSize;
+  TagData *head = new (GetRecords (m_data, m_data->start)) TagData;
+  head->tid = tid;
+  head->size = size;
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  m_data->mask |= GetMaskBit (tid);
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
-  TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  TagData *cur = Find (tag.GetInstanceTypeId ());
+  if (cur == 0)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  /* found tag */
+  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
+  return true;
 }
 
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
-  return m_next;
+  if (m_data == 0)
+    {
+      return 0;
+    }
+  return reinterpret_cast<const TagData *> (GetRecords (m_data, m_data->start));
+}
+
+const struct PacketTagList::TagData *
+PacketTagList::End (void) const
+{
+  if (m_data == 0)
+    {
+      return 0;
+    }
+  return reinterpret_cast<const TagData *> (GetRecords (m_data, m_data->size));
 }
 
-} /* namespace ns3 */
+const struct PacketTagList::TagData *
+PacketTagList::Next (const struct TagData *data)
+{
+  const uint8_t *next = reinterpret_cast<const uint8_t *> (data) + GetRecordSize (data->size);
+  return reinterpret_cast<const TagData *> (next);
+}
 
+} /* namespace ns3 */
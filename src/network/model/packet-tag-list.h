@@ -22,7 +22,7 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a list of Packet tags, including copy-on-write semantics.
 */
 
 #include <stdint.h>
@@ -43,110 +43,63 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ *   - Tags are stored in serialized form, as TagData records packed
+ *     in a single TagListData block allocated from the
+ *     PacketDataAllocator.  The records fill the end of the block,
+ *     the most recent tag first, and the free space is at its start.
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ *   - #Peek, #Remove and #Replace scan the records linearly, so
+ *     their cost is O(n) in the number of tags of the list.  The
+ *     block keeps a mask of the types of its tags, indexed by the
+ *     TypeId uid modulo 64, but it only filters lookups: a type which
+ *     is not in the list returns without scanning when no other tag of
+ *     the list has the same bit, and is scanned for otherwise.
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
- *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
+ *   - #Add is O(1) when the block is not shared and has enough free
+ *     space, and O(n) when the records have to be copied first.
  *
  * \par <b> Copy-on-write </b> is implemented as follows:
  *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
  *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
+ *     share the block of \c o, incrementing its \c count.
  *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ *   - #Add, #Remove and #Replace modify the block in place when it
+ *     is not shared and, for #Add, when it has enough free space.
+ *     Otherwise they first copy the records in a new block, which
+ *     has room for a few more tags.
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
-   *
-   * See PacketTagList for a discussion of the data structure.
+   * Serialized tag.
    *
    * \internal
    * Unfortunately this has to be public, because
    * PacketTagIterator::Item::GetTag() needs the data and size values.
    * The Item nested class can't be forward declared, so friending isn't
    * possible.
-   *
-   * We use placement new so we can allocate enough room for the Tag
-   * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
    */
   struct TagData
   {
-    struct TagData * next;      /**< Pointer to next in list */
-    uint32_t count;             /**< Number of incoming links */
     TypeId tid;                 /**< Type of the tag serialized into #data */
     uint32_t size;              /**< Size of the \c data buffer */
     uint8_t data[1];            /**< Serialization buffer */
   };  /* struct TagData */
 
+  /**
+   * Block holding the TagData records of one or more PacketTagList.
+   */
+  struct TagListData
+  {
+    uint32_t count;             /**< Number of PacketTagList sharing this block */
+    uint32_t size;              /**< Size of the \c data buffer */
+    uint32_t start;             /**< Offset of the first record in \c data */
+    uint64_t mask;              /**< Bit (uid % 64) set for each tag type */
+    uint8_t data[8];            /**< Records, from \c start to \c size */
+  };  /* struct TagListData */
+
   /**
    * Create a new PacketTagList.
    */
@@ -156,8 +109,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This makes a light-weight copy by sharing the \ref TagListData
+   * of \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -167,18 +120,18 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * sharing the \ref TagListData of \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to the head of this list.
    *
    * \param [in] tag The tag to add
    */
@@ -210,78 +163,84 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * Make sure that the block of this list is not shared and has
+   * \pname{space} bytes of free space, copying it if needed.
+   *
+   * The reference count of the block is not atomic: the list must be
+   * unshared before it is handed to another thread.
+   *
+   * \param [in] space The free space needed.
+   */
+  void Unshare (uint32_t space = 0);
+  /**
+   * \returns pointer to the first tag of the list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \returns pointer past the last tag of the list
+   */
+  const struct PacketTagList::TagData *End (void) const;
+  /**
+   * \param [in] data A tag of the list.
+   * \returns pointer to the tag which follows \pname{data}
+   */
+  static const struct PacketTagList::TagData *Next (const struct TagData *data);
 
 private:
   /**
-   * Allocate and construct a TagData struct, sizing the data area
-   * large enough to serialize dataSize bytes from a Tag.
+   * The \c data array of TagListData is declared with a fixed size but
+   * extends to the end of the block, so the records are addressed from
+   * the start of the block rather than through the array.
    *
-   * \param [in] dataSize The serialized size of the Tag.
-   * \returns The newly constructed TagData object.
+   * \param [in] data A block.
+   * \param [in] offset An offset in the records of the block.
+   * \returns A pointer to this offset.
    */
-  static
-  TagData * CreateTagData (size_t dataSize);
-  
+  static uint8_t *GetRecords (TagListData *data, uint32_t offset);
   /**
-   * Typedef of method function pointer for copy-on-write operations
-   *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] dataSize The serialized size of a Tag.
+   * \returns The size of the TagData record holding it.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  static uint32_t GetRecordSize (uint32_t dataSize);
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * \param [in] tid A tag type.
+   * \returns The bit of \pname{tid} in TagListData::mask.
+   */
+  static uint64_t GetMaskBit (TypeId tid);
+  /**
+   * Allocate a TagListData block large enough to hold
+   * \pname{dataSize} bytes of records.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] dataSize The size of the records.
+   * \returns The newly allocated, empty block.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  static TagListData *Allocate (uint32_t dataSize);
   /**
-   * Copy-on-write implementing Remove.
+   * Release a block no longer used by any PacketTagList.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] data The block.
    */
-  bool RemoveWriter  (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  static void Deallocate (TagListData *data);
   /**
-   * Copy-on-write implementing Replace
+   * Remove a tag from the list, copying the block if it is shared.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] data The tag to remove.
+   */
+  void Erase (struct TagData *data);
+  /**
+   * \param [in] tid A tag type.
+   * \returns The tag of this type in the list, or 0.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  struct TagData *Find (TypeId tid) const;
 
   /**
-   * Pointer to first \ref TagData on the list
+   * The block holding the tags, or 0 if there are none.
    */
-  struct TagData *m_next;
+  struct TagListData *m_data;
 };
 
 } // namespace ns3
@@ -293,16 +252,16 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_data (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_data (o.m_data)
 {
-  if (m_next != 0)
+  if (m_data != 0)
     {
-      m_next->count++;
+      m_data->count++;
     }
 }
 
@@ -310,15 +269,15 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (m_data == o.m_data) 
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_data = o.m_data;
+  if (m_data != 0) 
     {
-      m_next->count++;
+      m_data->count++;
     }
   return *this;
 }
@@ -331,27 +290,15 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  if (m_data != 0)
     {
-      cur->count--;
-      if (cur->count > 0) 
+      m_data->count--;
+      if (m_data->count == 0)
         {
-          break;
+          Deallocate (m_data);
         }
-      if (prev != 0) 
-        {
-          prev->~TagData ();
-          std::free (prev);
-        }
-      prev = cur;
-    }
-  if (prev != 0) 
-    {
-      prev->~TagData ();
-      std::free (prev);
+      m_data = 0;
     }
-  m_next = 0;
 }
 
 } // namespace ns3
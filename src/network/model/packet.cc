@@ -18,9 +18,11 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "packet.h"
+#include "packet-data-allocator.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/replication-runner.h"
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +30,46 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid (0);
+bool Packet::m_enableLazyHeaders = false;
+
+uint32_t
+Packet::AllocateUid (void)
+{
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      // Each replication run by a ReplicationRunner numbers its
+      // packets from zero.
+      static thread_local uint64_t key = 0;
+      static thread_local uint32_t uid = 0;
+      if (key != ReplicationRunner::GetReplicationKey ())
+        {
+          key = ReplicationRunner::GetReplicationKey ();
+          uid = 0;
+        }
+      return uid++;
+    }
+  return m_globalUid.fetch_add (1, std::memory_order_relaxed);
+}
+
+bool &
+Packet::LazyHeaders (void)
+{
+  if (ReplicationRunner::IsReplicationThread ())
+    {
+      // Each replication run by a ReplicationRunner starts from the
+      // setting of the main program.
+      static thread_local uint64_t key = 0;
+      static thread_local bool enable = false;
+      if (key != ReplicationRunner::GetReplicationKey ())
+        {
+          key = ReplicationRunner::GetReplicationKey ();
+          enable = m_enableLazyHeaders;
+        }
+      return enable;
+    }
+  return m_enableLazyHeaders;
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -81,21 +122,23 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head,
+                                      const struct PacketTagList::TagData *end)
+  : m_current (head),
+    m_end (end)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_current != m_end;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
   const struct PacketTagList::TagData *prev = m_current;
-  m_current = m_current->next;
+  m_current = PacketTagList::Next (m_current);
   return PacketTagIterator::Item (prev);
 }
 
@@ -117,6 +160,32 @@ PacketTagIterator::Item::GetTag (Tag &tag) const
 }
 
 
+Packet::PendingHeader::PendingHeader (Header *header, uint32_t size,
+                                      Ptr<const PendingHeader> next)
+  : m_header (header),
+    m_size (size),
+    m_next (next)
+{
+}
+
+Packet::PendingHeader::~PendingHeader ()
+{
+  delete m_header;
+}
+
+void *
+Packet::operator new (size_t size)
+{
+  uint32_t capacity;
+  return PacketDataAllocator::Allocate (size, capacity);
+}
+
+void
+Packet::operator delete (void *p)
+{
+  PacketDataAllocator::Deallocate (p);
+}
+
 Ptr<Packet> 
 Packet::Copy (void) const
 {
@@ -126,6 +195,17 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+void
+Packet::Unshare (void)
+{
+  NS_LOG_FUNCTION (this);
+  SerializeHeaders ();
+  m_buffer.Unshare ();
+  m_byteTagList.Unshare ();
+  m_packetTagList.Unshare ();
+  m_metadata.Unshare ();
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,17 +216,17 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_pendingHeaders (o.m_pendingHeaders)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
@@ -163,6 +243,7 @@ Packet::operator = (const Packet &o)
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
   m_metadata = o.m_metadata;
+  m_pendingHeaders = o.m_pendingHeaders;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
   return *this;
@@ -178,10 +259,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +284,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -227,6 +306,7 @@ Ptr<Packet>
 Packet::CreateFragment (uint32_t start, uint32_t length) const
 {
   NS_LOG_FUNCTION (this << start << length);
+  SerializeHeaders ();
   Buffer buffer = m_buffer.CreateFragment (start, length);
   ByteTagList byteTagList = m_byteTagList;
   byteTagList.Adjust (-start);
@@ -252,20 +332,91 @@ Packet::GetNixVector (void) const
   return m_nixVector;
 } 
 
+void
+Packet::SerializeHeaders (void) const
+{
+  if (m_pendingHeaders == 0)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this);
+  SerializeHeader (PeekPointer (m_pendingHeaders), 0);
+  m_pendingHeaders = 0;
+}
+
+void
+Packet::SerializeHeader (const PendingHeader *header, uint32_t offset) const
+{
+  /* Serialize the inner headers first: a header may read the bytes
+   * which follow it, to compute a checksum for example.  It is given
+   * a buffer which starts with it, as if it had just been added. */
+  if (header->m_next != 0)
+    {
+      SerializeHeader (PeekPointer (header->m_next), offset + header->m_size);
+    }
+  Buffer buffer = m_buffer.CreateFragment (offset, m_buffer.GetSize () - offset);
+  header->m_header->Serialize (buffer.Begin ());
+}
+
+bool
+Packet::MatchPendingHeader (const Header &header, uint32_t size) const
+{
+  if (m_pendingHeaders == 0)
+    {
+      return false;
+    }
+  if (m_pendingHeaders->m_header->GetInstanceTypeId () == header.GetInstanceTypeId ()
+      && (size == 0 || size == m_pendingHeaders->m_size))
+    {
+      return true;
+    }
+  SerializeHeaders ();
+  return false;
+}
+
 void
 Packet::AddHeader (const Header &header)
 {
   uint32_t size = header.GetSerializedSize ();
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+  Header *copy = LazyHeaders () ? header.Clone () : 0;
+  if (copy == 0)
+    {
+      // the header may read the bytes which follow it.
+      SerializeHeaders ();
+    }
   m_buffer.AddAtStart (size);
   m_byteTagList.Adjust (size);
   m_byteTagList.AddAtStart (size);
-  header.Serialize (m_buffer.Begin ());
-  m_metadata.AddHeader (header, size);
+  if (copy != 0)
+    {
+      m_pendingHeaders = Create<const PendingHeader> (copy, size, m_pendingHeaders);
+    }
+  else
+    {
+      header.Serialize (m_buffer.Begin ());
+    }
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.AddHeader (header, size);
+    }
 }
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
 {
+  if (MatchPendingHeader (header, size))
+    {
+      header.Assign (*m_pendingHeaders->m_header);
+      m_pendingHeaders = m_pendingHeaders->m_next;
+      NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+      m_buffer.RemoveAtStart (size);
+      m_byteTagList.Adjust (-size);
+      if (PacketMetadata::IsAvailable ())
+        {
+          m_metadata.RemoveHeader (header, size);
+        }
+      return size;
+    }
   Buffer::Iterator end;
   end = m_buffer.Begin ();
   end.Next (size);
@@ -273,22 +424,47 @@ Packet::RemoveHeader (Header &header, uint32_t size)
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.RemoveHeader (header, deserialized);
+    }
   return deserialized;
 }
 uint32_t
 Packet::RemoveHeader (Header &header)
 {
+  if (MatchPendingHeader (header, 0))
+    {
+      uint32_t size = m_pendingHeaders->m_size;
+      header.Assign (*m_pendingHeaders->m_header);
+      m_pendingHeaders = m_pendingHeaders->m_next;
+      NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << size);
+      m_buffer.RemoveAtStart (size);
+      m_byteTagList.Adjust (-size);
+      if (PacketMetadata::IsAvailable ())
+        {
+          m_metadata.RemoveHeader (header, size);
+        }
+      return size;
+    }
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtStart (deserialized);
   m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.RemoveHeader (header, deserialized);
+    }
   return deserialized;
 }
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
+  if (MatchPendingHeader (header, 0))
+    {
+      header.Assign (*m_pendingHeaders->m_header);
+      return m_pendingHeaders->m_size;
+    }
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
@@ -296,6 +472,11 @@ Packet::PeekHeader (Header &header) const
 uint32_t
 Packet::PeekHeader (Header &header, uint32_t size) const
 {
+  if (MatchPendingHeader (header, size))
+    {
+      header.Assign (*m_pendingHeaders->m_header);
+      return size;
+    }
   Buffer::Iterator end;
   end = m_buffer.Begin ();
   end.Next (size);
@@ -308,24 +489,33 @@ Packet::AddTrailer (const Trailer &trailer)
 {
   uint32_t size = trailer.GetSerializedSize ();
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << size);
+  SerializeHeaders ();
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   Buffer::Iterator end = m_buffer.End ();
   trailer.Serialize (end);
-  m_metadata.AddTrailer (trailer, size);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.AddTrailer (trailer, size);
+    }
 }
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
 {
+  SerializeHeaders ();
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
-  m_metadata.RemoveTrailer (trailer, deserialized);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.RemoveTrailer (trailer, deserialized);
+    }
   return deserialized;
 }
 uint32_t
 Packet::PeekTrailer (Trailer &trailer)
 {
+  SerializeHeaders ();
   uint32_t deserialized = trailer.Deserialize (m_buffer.End ());
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
@@ -335,36 +525,53 @@ void
 Packet::AddAtEnd (Ptr<const Packet> packet)
 {
   NS_LOG_FUNCTION (this << packet << packet->GetSize ());
+  SerializeHeaders ();
+  packet->SerializeHeaders ();
   m_byteTagList.AddAtEnd (GetSize ());
   ByteTagList copy = packet->m_byteTagList;
   copy.AddAtStart (0);
   copy.Adjust (GetSize ());
   m_byteTagList.Add (copy);
   m_buffer.AddAtEnd (packet->m_buffer);
-  m_metadata.AddAtEnd (packet->m_metadata);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.AddAtEnd (packet->m_metadata);
+    }
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  SerializeHeaders ();
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
-  m_metadata.AddPaddingAtEnd (size);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.AddPaddingAtEnd (size);
+    }
 }
 void 
 Packet::RemoveAtEnd (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  SerializeHeaders ();
   m_buffer.RemoveAtEnd (size);
-  m_metadata.RemoveAtEnd (size);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.RemoveAtEnd (size);
+    }
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
+  SerializeHeaders ();
   m_buffer.RemoveAtStart (size);
   m_byteTagList.Adjust (-size);
-  m_metadata.RemoveAtStart (size);
+  if (PacketMetadata::IsAvailable ())
+    {
+      m_metadata.RemoveAtStart (size);
+    }
 }
 
 void 
@@ -377,15 +584,25 @@ Packet::RemoveAllByteTags (void)
 uint32_t 
 Packet::CopyData (uint8_t *buffer, uint32_t size) const
 {
+  SerializeHeaders ();
   return m_buffer.CopyData (buffer, size);
 }
 
 void
 Packet::CopyData (std::ostream *os, uint32_t size) const
 {
+  SerializeHeaders ();
   return m_buffer.CopyData (os, size);
 }
 
+uint32_t
+Packet::CalculateCrc32 (void) const
+{
+  SerializeHeaders ();
+  Buffer::Iterator i = m_buffer.Begin ();
+  return i.CalculateCrc32 (m_buffer.GetSize ());
+}
+
 uint64_t 
 Packet::GetUid (void) const
 {
@@ -433,6 +650,7 @@ Packet::ToString() const
 void 
 Packet::Print (std::ostream &os) const
 {
+  SerializeHeaders ();
   PacketMetadata::ItemIterator i = m_metadata.BeginItem (m_buffer);
   while (i.HasNext ())
     {
@@ -565,6 +783,7 @@ Packet::Print (std::ostream &os) const
 PacketMetadata::ItemIterator 
 Packet::BeginItem (void) const
 {
+  SerializeHeaders ();
   return m_metadata.BeginItem (m_buffer);
 }
 
@@ -582,6 +801,20 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableLazyHeaders (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  LazyHeaders () = true;
+}
+
+void
+Packet::DisableLazyHeaders (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  LazyHeaders () = false;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -627,6 +860,7 @@ uint32_t Packet::GetSerializedSize (void) const
 uint32_t 
 Packet::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
+  SerializeHeaders ();
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -909,7 +1143,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (m_packetTagList.Head (), m_packetTagList.End ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
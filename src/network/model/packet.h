@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -33,6 +34,7 @@
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/deprecated.h"
 
 namespace ns3 {
@@ -174,9 +176,12 @@ private:
   /**
    * Constructor
    * \param head head of the items
+   * \param end end of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const struct PacketTagList::TagData *head,
+                     const struct PacketTagList::TagData *end);
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
+  const struct PacketTagList::TagData *m_end;      //!< end of the set of tags in a packet
 };
 
 /**
@@ -248,6 +253,20 @@ public:
    * \return the copied object
    */
   Packet &operator = (const Packet &o);
+  /**
+   * \brief Allocate the memory of a packet from the free lists of
+   * the PacketDataAllocator.
+   *
+   * \param size the size of the packet object
+   * \returns the memory of the packet
+   */
+  static void *operator new (size_t size);
+  /**
+   * \brief Release the memory of a packet allocated by operator new.
+   *
+   * \param p the memory of the packet
+   */
+  static void operator delete (void *p);
   /**
    * \brief Create a packet with a zero-filled payload.
    *
@@ -310,7 +329,13 @@ public:
    * methods to reserve space in the buffer and request the 
    * header to serialize itself in the packet buffer.
    *
+   * If lazy headers are enabled and the header supports it, the
+   * space is reserved but the header is kept as a copy and
+   * serialized only when the bytes of the packet are needed.
+   *
    * \param header a reference to the header to add to this packet.
+   *
+   * \sa EnableLazyHeaders
    */
   void AddHeader (const Header & header);
   /**
@@ -442,6 +467,17 @@ public:
    */
   void CopyData (std::ostream *os, uint32_t size) const;
 
+  /**
+   * \brief Calculate the CRC-32 of the packet contents.
+   *
+   * The bytes are read in place from the packet buffer, so this is
+   * equivalent to CRC32Calculate over the output of CopyData, without
+   * the copy.
+   *
+   * \returns the CRC-32 of the packet bytes
+   */
+  uint32_t CalculateCrc32 (void) const;
+
   /**
    * \brief performs a COW copy of the packet.
    *
@@ -453,6 +489,22 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief Give this packet its own copy of the datasets it shares
+   * with other packets.
+   *
+   * The pending headers are serialized, and the buffer, metadata, byte
+   * tags and packet tags are copied if they are shared.  The reference
+   * counts of these datasets are not atomic, so a packet must be
+   * unshared before it is handed to another thread, such as another
+   * logical process of ns3::MultithreadedSimulatorImpl:
+   * \code
+   * Ptr<Packet> copy = p->Copy ();
+   * copy->Unshare ();
+   * \endcode
+   */
+  void Unshare (void);
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -517,6 +569,11 @@ public:
    * want to be able the Packet::Print method, 
    * you need to invoke this method at least once during the 
    * simulation setup and before any packet is created.
+   *
+   * This has no effect if packet metadata was compiled out with
+   * --disable-packet-metadata.
+   *
+   * \sa PacketMetadata::IsAvailable
    */
   static void EnablePrinting (void);
   /**
@@ -530,6 +587,37 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable lazy header serialization.
+   *
+   * By default, Packet::AddHeader serializes the header immediately
+   * and Packet::RemoveHeader deserializes it back.  Once this method
+   * has been called, the headers which implement Header::Clone are
+   * kept unserialized at the front of the packet: removing or peeking
+   * a header of the same type then copies it back with
+   * Header::Assign, so that forwarding a packet through many nodes
+   * skips the serialization round trip.  The pending headers are
+   * serialized as soon as the bytes of the packet are read, for
+   * example by CopyData, Print, Serialize or CreateFragment, or
+   * when the end of the packet is modified.
+   *
+   * The received header is a copy of the added header: fields which
+   * are only computed by Header::Serialize, such as checksums, are
+   * not set.  This method should be invoked during the simulation
+   * setup, before any packet is created.
+   *
+   * Each replication run by a ReplicationRunner has its own setting,
+   * initially the one of the main program.
+   */
+  static void EnableLazyHeaders (void);
+  /**
+   * \brief Disable lazy header serialization.
+   *
+   * The headers added from now on are serialized immediately.  The
+   * headers already pending in existing packets are still serialized
+   * when needed.
+   */
+  static void DisableLazyHeaders (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -758,6 +846,61 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief A header added to the packet but not serialized yet.
+   *
+   * The pending headers of a packet form an immutable list, shared
+   * by the copies of the packet, which starts with the first header
+   * of the packet.  Their bytes are reserved at the start of the
+   * packet buffer.
+   */
+  class PendingHeader : public SimpleRefCount<PendingHeader>
+  {
+  public:
+    /**
+     * \param header the header copy, owned by this object
+     * \param size the serialized size of the header
+     * \param next the pending header which follows this header
+     */
+    PendingHeader (Header *header, uint32_t size, Ptr<const PendingHeader> next);
+    ~PendingHeader ();
+
+    Header *m_header;                 //!< the header copy
+    uint32_t m_size;                  //!< the serialized size of the header
+    Ptr<const PendingHeader> m_next;  //!< the following pending header
+  private:
+    /**
+     * \brief Copy constructor - defined and not implemented.
+     */
+    PendingHeader (const PendingHeader &);
+    /**
+     * \brief Copy assignment operator - defined and not implemented.
+     * \returns a reference to this object
+     */
+    PendingHeader &operator = (const PendingHeader &);
+  };
+
+  /**
+   * \brief Serialize the pending headers in the packet buffer.
+   */
+  void SerializeHeaders (void) const;
+  /**
+   * \brief Serialize a pending header and the ones which follow it.
+   * \param header the pending header
+   * \param offset the offset of the header in the packet buffer
+   */
+  void SerializeHeader (const PendingHeader *header, uint32_t offset) const;
+  /**
+   * \param header the header to remove or peek
+   * \param size the expected size of the header, or zero
+   * \returns true if \p header can be copied from the first pending
+   *          header instead of being deserialized.
+   *
+   * If the first bytes of the packet are a pending header of another
+   * type, the pending headers are serialized.
+   */
+  bool MatchPendingHeader (const Header &header, uint32_t size) const;
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -766,7 +909,29 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /// the headers not yet serialized in the packet buffer
+  mutable Ptr<const PendingHeader> m_pendingHeaders;
+  static bool m_enableLazyHeaders; //!< Enable lazy header serialization
+
+  /**
+   * Get the lazy header setting of the calling replication.
+   *
+   * eturns The flag enabling lazy header serialization.
+   */
+  static bool &LazyHeaders (void);
+
+  /**
+   * Allocate the uid of a new packet.
+   *
+   * \returns The uid.
+   */
+  static uint32_t AllocateUid (void);
+
+  /**
+   * Global counter of packets Uid.  It is atomic because packets may be
+   * created by several logical processes of a multithreaded simulation.
+   */
+  static std::atomic<uint32_t> m_globalUid;
 };
 
 /**
@@ -795,11 +960,11 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *   - ns3::Packet::AddHeader
  *   - ns3::Packet::AddTrailer
  *   - both versions of ns3::Packet::AddAtEnd
+ *   - ns3::Packet::AddPacketTag
  *   - ns3::Packet::RemovePacketTag
  *   - ns3::Packet::ReplacePacketTag
  *
  * Non-dirty operations:
- *   - ns3::Packet::AddPacketTag
  *   - ns3::Packet::PeekPacketTag
  *   - ns3::Packet::RemoveAllPacketTags
  *   - ns3::Packet::AddByteTag
@@ -811,12 +976,21 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  *   - ns3::Packet::RemoveAtStart
  *   - ns3::Packet::RemoveAtEnd
  *   - ns3::Packet::CopyData
+ *   - ns3::Packet::CalculateCrc32
  *
  * Dirty operations will always be slower than non-dirty operations,
  * sometimes by several orders of magnitude. However, even the
  * dirty operations have been optimized for common use-cases which
  * means that most of the time, these operations will not trigger
  * data copies and will thus be still very fast.
+ *
+ * The Packet objects themselves, as well as the memory of their byte
+ * buffer, metadata and tags, are allocated from the per-thread free
+ * lists of the ns3::PacketDataAllocator.  A packet created after
+ * another one was destroyed by the same thread hence reuses its memory
+ * without calling the system allocator, and
+ * ns3::PacketDataAllocator::GetStatistics reports how often this
+ * happens.
  */
 
 } // namespace ns3
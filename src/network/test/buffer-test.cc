@@ -19,6 +19,7 @@
  */
 
 #include "ns3/buffer.h"
+#include "ns3/crc32.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
@@ -320,6 +321,10 @@ BufferTest::DoRun (void)
   frag0.AddAtEnd (frag1);
   ENSURE_WRITTEN_BYTES (buffer, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
   ENSURE_WRITTEN_BYTES (frag0, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
+  frag0 = buffer.CreateFragment (0, 6);
+  frag1 = buffer.CreateFragment (6, 1);
+  frag0.AddAtEnd (frag1);
+  ENSURE_WRITTEN_BYTES (frag0, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x66);
 
   buffer = Buffer (5);
   buffer.AddAtStart (2);
@@ -376,6 +381,115 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // fragments reassembled in order share the storage of their buffer
+  buffer = Buffer ();
+  buffer.AddAtStart (1000);
+  i = buffer.Begin ();
+  for (uint32_t j = 0; j < 1000; j++)
+    {
+      i.WriteU8 (j & 0xff);
+    }
+  Buffer joined;
+  joined.AddAtEnd (buffer.CreateFragment (0, 400));
+  joined.AddAtEnd (buffer.CreateFragment (400, 600));
+  NS_TEST_ASSERT_MSG_EQ (joined.GetSize (), 1000, "Bad reassembled size");
+  NS_TEST_ASSERT_MSG_EQ (joined.PeekData (), buffer.PeekData (), "Reassembled fragments copied");
+  joined.AddAtEnd (1);
+  i = joined.End ();
+  i.Prev ();
+  i.WriteU8 (0x55);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev ();
+  i.WriteU8 (0x66);
+  i = joined.End ();
+  i.Prev ();
+  NS_TEST_ASSERT_MSG_EQ (i.ReadU8 (), 0x55, "Shared storage overwritten");
+
+  // many buffers appended one after the other
+  Buffer aggregate;
+  Buffer subframe;
+  subframe.AddAtStart (1500);
+  i = subframe.Begin ();
+  for (uint32_t j = 0; j < 1500; j++)
+    {
+      i.WriteU8 (j & 0xff);
+    }
+  for (uint32_t j = 0; j < 64; j++)
+    {
+      aggregate.AddAtEnd (subframe);
+    }
+  NS_TEST_ASSERT_MSG_EQ (aggregate.GetSize (), 64 * 1500, "Bad aggregate size");
+  bool same = true;
+  i = aggregate.Begin ();
+  for (uint32_t j = 0; j < 64 * 1500; j++)
+    {
+      same = same && i.ReadU8 () == ((j % 1500) & 0xff);
+    }
+  NS_TEST_ASSERT_MSG_EQ (same, true, "Bad aggregate content");
+
+  // checksums over a buffer with a zero area, from odd and even offsets
+  buffer = Buffer (101);
+  buffer.AddAtStart (37);
+  buffer.AddAtEnd (43);
+  i = buffer.Begin ();
+  for (uint32_t j = 0; j < 37; j++)
+    {
+      i.WriteU8 (j * 7 + 1);
+    }
+  i.Next (101);
+  for (uint32_t j = 0; j < 43; j++)
+    {
+      i.WriteU8 (j * 13 + 5);
+    }
+  uint8_t bytes[181];
+  buffer.CopyData (bytes, 181);
+  for (uint32_t start = 0; start < 4; start++)
+    {
+      uint32_t size = 181 - start;
+      uint32_t sum = 0x1234;
+      for (uint32_t j = 0; j + 1 < size; j += 2)
+        {
+          sum += bytes[start + j] | (bytes[start + j + 1] << 8);
+        }
+      if (size & 1)
+        {
+          sum += bytes[start + size - 1];
+        }
+      while (sum >> 16)
+        {
+          sum = (sum & 0xffff) + (sum >> 16);
+        }
+      i = buffer.Begin ();
+      i.Next (start);
+      NS_TEST_EXPECT_MSG_EQ (i.CalculateIpChecksum (size, 0x1234), (uint16_t)~sum, "Bad checksum");
+      NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, "Checksum did not read all bytes");
+      i = buffer.Begin ();
+      i.Next (start);
+      NS_TEST_EXPECT_MSG_EQ (i.CalculateCrc32 (size), CRC32Calculate (bytes + start, size), "Bad CRC-32");
+    }
+  i = buffer.Begin ();
+  uint32_t crc = i.CalculateCrc32 (50);
+  NS_TEST_EXPECT_MSG_EQ (i.CalculateCrc32 (131, crc), CRC32Calculate (bytes, 181), "Bad chained CRC-32");
+  // the CRC-32 check value of "123456789"
+  NS_TEST_EXPECT_MSG_EQ (CRC32Calculate (reinterpret_cast<const uint8_t *> ("123456789"), 9), 0xCBF43926, "Bad CRC-32 check value");
+
+  // Unshare gives a copy its own data, with the same bytes
+  Buffer shared;
+  shared.AddAtStart (6);
+  i = shared.Begin ();
+  i.WriteHtonU16 (0x0102);
+  i.WriteHtonU32 (0x03040506);
+  Buffer unshared = shared;
+  bool sameData = unshared.PeekData () == shared.PeekData ();
+  NS_TEST_EXPECT_MSG_EQ (sameData, true, "Copy did not share the data");
+  unshared.Unshare ();
+  sameData = unshared.PeekData () == shared.PeekData ();
+  NS_TEST_EXPECT_MSG_EQ (sameData, false, "Unshare did not copy the data");
+  ENSURE_WRITTEN_BYTES (unshared, 6, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06);
+  unshared.Begin ().WriteU8 (0xff);
+  ENSURE_WRITTEN_BYTES (shared, 6, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06);
 }
 
 /**
@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/packet.h"
+#include "ns3/packet-burst.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/data-rate.h"
+#include "ns3/queue.h"
+#include "ns3/net-device-queue-interface.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a burst sent by a SimpleNetDevice goes through the device
+ * queue and reaches the protocol handlers of the receiving Node, as one
+ * burst when the handler accepts bursts and one packet at a time otherwise.
+ */
+class NetDeviceBurstTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param dataRate the data rate of the sending device
+   */
+  NetDeviceBurstTestCase (DataRate dataRate);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a burst of three packets
+   * \param device the sending device
+   * \param dest the destination
+   * \param protocol the protocol number
+   */
+  void SendBurst (Ptr<NetDevice> device, Address dest, uint16_t protocol);
+  /**
+   * Protocol handler
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \param to the receiver
+   * \param packetType the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * Burst protocol handler
+   * \param device the receiving device
+   * \param burst the packets
+   * \param protocol the protocol number
+   * \param from the sender
+   * \param to the receiver
+   * \param packetType the packet type
+   */
+  void ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                     const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * Count a packet enqueued in the device queue
+   * \param packet the packet
+   */
+  void Enqueue (Ptr<const Packet> packet);
+  /**
+   * Count a packet dequeued from the device queue
+   * \param packet the packet
+   */
+  void Dequeue (Ptr<const Packet> packet);
+
+  DataRate m_dataRate; //!< data rate of the sending device
+  std::vector<uint32_t> m_received; //!< sizes of the packets received one at a time
+  std::vector<uint32_t> m_bursts; //!< number of packets of each burst received
+  uint32_t m_burstBytes; //!< bytes received in bursts
+  uint32_t m_enqueued; //!< packets enqueued in the device queue
+  uint32_t m_dequeued; //!< packets dequeued from the device queue
+};
+
+NetDeviceBurstTestCase::NetDeviceBurstTestCase (DataRate dataRate)
+  : TestCase ("Burst send and receive with data rate " + std::to_string (dataRate.GetBitRate ())),
+    m_dataRate (dataRate),
+    m_burstBytes (0),
+    m_enqueued (0),
+    m_dequeued (0)
+{
+}
+
+void
+NetDeviceBurstTestCase::SendBurst (Ptr<NetDevice> device, Address dest, uint16_t protocol)
+{
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      burst->AddPacket (Create<Packet> (100 * i));
+    }
+  uint32_t sent = device->SendBurst (burst, dest, protocol);
+  NS_TEST_EXPECT_MSG_EQ (sent, 3, "All the packets of the burst should be accepted");
+}
+
+void
+NetDeviceBurstTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                 const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_received.push_back (packet->GetSize ());
+}
+
+void
+NetDeviceBurstTestCase::ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst, uint16_t protocol,
+                                      const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  m_bursts.push_back (burst->GetNPackets ());
+  m_burstBytes += burst->GetSize ();
+}
+
+void
+NetDeviceBurstTestCase::Enqueue (Ptr<const Packet> packet)
+{
+  m_enqueued++;
+}
+
+void
+NetDeviceBurstTestCase::Dequeue (Ptr<const Packet> packet)
+{
+  m_dequeued++;
+}
+
+void
+NetDeviceBurstTestCase::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> devA = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> devB = CreateObject<SimpleNetDevice> ();
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetChannel (channel);
+  devA->SetAttribute ("DataRate", DataRateValue (m_dataRate));
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetChannel (channel);
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devA->GetQueue ()->TraceConnectWithoutContext ("Enqueue", MakeCallback (&NetDeviceBurstTestCase::Enqueue, this));
+  devA->GetQueue ()->TraceConnectWithoutContext ("Dequeue", MakeCallback (&NetDeviceBurstTestCase::Dequeue, this));
+
+  b->RegisterProtocolHandler (MakeCallback (&NetDeviceBurstTestCase::Receive, this),
+                              MakeCallback (&NetDeviceBurstTestCase::ReceiveBurst, this),
+                              0x0800, devB);
+  b->RegisterProtocolHandler (MakeCallback (&NetDeviceBurstTestCase::Receive, this),
+                              0x0806, devB);
+
+  Simulator::Schedule (Seconds (1.0), &NetDeviceBurstTestCase::SendBurst, this,
+                       devA, devB->GetAddress (), 0x0800);
+  Simulator::Schedule (Seconds (2.0), &NetDeviceBurstTestCase::SendBurst, this,
+                       devA, devB->GetAddress (), 0x0806);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_enqueued, 6, "All the packets should be enqueued in the device queue");
+  NS_TEST_EXPECT_MSG_EQ (m_dequeued, 6, "All the packets should be dequeued from the device queue");
+  if (m_dataRate.GetBitRate () == 0)
+    {
+      // an infinitely fast device transmits the first burst as a whole
+      NS_TEST_ASSERT_MSG_EQ (m_bursts.size (), 1, "The IPv4 packets should arrive as one burst");
+      NS_TEST_EXPECT_MSG_EQ (m_bursts[0], 3, "The burst should hold three packets");
+      NS_TEST_EXPECT_MSG_EQ (m_burstBytes, 600, "The burst should hold 600 bytes");
+      NS_TEST_ASSERT_MSG_EQ (m_received.size (), 3, "The ARP packets should arrive one at a time");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_bursts.size (), 0, "A finite rate device should not deliver bursts");
+      NS_TEST_ASSERT_MSG_EQ (m_received.size (), 6, "All packets should arrive one at a time");
+    }
+  for (uint32_t i = 0; i < m_received.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], 100 * (i % 3 + 1), "Packets should arrive in order");
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a burst ends at the first packet which finds the
+ * transmission queue of the device stopped, instead of overflowing
+ * the device queue.
+ */
+class NetDeviceBurstStopTestCase : public TestCase
+{
+public:
+  NetDeviceBurstStopTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Send a burst of five packets
+   * \param device the sending device
+   * \param dest the destination address
+   */
+  void SendBurst (Ptr<NetDevice> device, Address dest);
+  /**
+   * Count a packet dropped by the device queue
+   * \param packet the packet
+   */
+  void Drop (Ptr<const Packet> packet);
+
+  uint32_t m_sent; //!< packets accepted by the device
+  uint32_t m_dropped; //!< packets dropped by the device queue
+  bool m_stopped; //!< whether the device queue was stopped after the burst
+};
+
+NetDeviceBurstStopTestCase::NetDeviceBurstStopTestCase ()
+  : TestCase ("Burst send ends when the device queue is stopped"),
+    m_sent (0),
+    m_dropped (0),
+    m_stopped (false)
+{
+}
+
+void
+NetDeviceBurstStopTestCase::SendBurst (Ptr<NetDevice> device, Address dest)
+{
+  Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      burst->AddPacket (Create<Packet> (100));
+    }
+  m_sent = device->SendBurst (burst, dest, 0x0800);
+  m_stopped = device->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->IsStopped ();
+}
+
+void
+NetDeviceBurstStopTestCase::Drop (Ptr<const Packet> packet)
+{
+  m_dropped++;
+}
+
+void
+NetDeviceBurstStopTestCase::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> devA = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> devB = CreateObject<SimpleNetDevice> ();
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetChannel (channel);
+  devA->SetAttribute ("DataRate", DataRateValue (DataRate ("1Mbps")));
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetChannel (channel);
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  // flow control as set up by SimpleNetDeviceHelper, with room for two packets
+  devA->GetQueue ()->SetMaxSize (QueueSize ("2p"));
+  devA->GetQueue ()->TraceConnectWithoutContext ("Drop", MakeCallback (&NetDeviceBurstStopTestCase::Drop, this));
+  Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
+  ndqi->GetTxQueue (0)->ConnectQueueTraces (devA->GetQueue ());
+  devA->AggregateObject (ndqi);
+
+  Simulator::Schedule (Seconds (1.0), &NetDeviceBurstStopTestCase::SendBurst, this,
+                       devA, devB->GetAddress ());
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // the first packet is transmitted at once and the next two fill the queue
+  NS_TEST_EXPECT_MSG_EQ (m_sent, 3, "The burst should end when the queue is full");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped, 0, "The device queue should not drop packets");
+  NS_TEST_EXPECT_MSG_EQ (m_stopped, true, "The device queue should be stopped");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief NetDevice burst TestSuite
+ */
+class NetDeviceBurstTestSuite : public TestSuite
+{
+public:
+  NetDeviceBurstTestSuite ();
+};
+
+NetDeviceBurstTestSuite::NetDeviceBurstTestSuite ()
+  : TestSuite ("net-device-burst", UNIT)
+{
+  AddTestCase (new NetDeviceBurstTestCase (DataRate (0)), TestCase::QUICK);
+  AddTestCase (new NetDeviceBurstTestCase (DataRate ("1Mbps")), TestCase::QUICK);
+  AddTestCase (new NetDeviceBurstStopTestCase, TestCase::QUICK);
+}
+
+static NetDeviceBurstTestSuite g_netDeviceBurstTestSuite; //!< Static variable for test initialization
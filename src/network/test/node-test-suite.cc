@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include <string>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that Node dispatches received packets to the protocol handlers
+ * matching their device and protocol, in registration order, and that
+ * registering and unregistering handlers updates the dispatch.
+ */
+class NodeProtocolHandlerTestCase : public TestCase
+{
+public:
+  NodeProtocolHandlerTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Protocol handler recording its name
+   * \param test the test case
+   * \param name the name of the handler
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol number
+   * \param from the sender
+   * \param to the receiver
+   * \param packetType the packet type
+   */
+  static void Receive (NodeProtocolHandlerTestCase *test, std::string name, Ptr<NetDevice> device,
+                       Ptr<const Packet> packet, uint16_t protocol,
+                       const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * Deliver a packet to a device and return the handlers it reached
+   * \param device the receiving device
+   * \param protocol the protocol number
+   * \returns the names of the handlers which received the packet
+   */
+  std::string Deliver (Ptr<SimpleNetDevice> device, uint16_t protocol);
+  /**
+   * Deliver a packet to a device from the node context
+   * \param device the receiving device
+   * \param protocol the protocol number
+   */
+  void DoDeliver (Ptr<SimpleNetDevice> device, uint16_t protocol);
+
+  std::string m_received; //!< names of the handlers which received the packet
+};
+
+NodeProtocolHandlerTestCase::NodeProtocolHandlerTestCase ()
+  : TestCase ("Node protocol handler dispatch")
+{
+}
+
+void
+NodeProtocolHandlerTestCase::Receive (NodeProtocolHandlerTestCase *test, std::string name,
+                                      Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                      uint16_t protocol, const Address &from, const Address &to,
+                                      NetDevice::PacketType packetType)
+{
+  test->m_received += name;
+}
+
+void
+NodeProtocolHandlerTestCase::DoDeliver (Ptr<SimpleNetDevice> device, uint16_t protocol)
+{
+  device->Receive (Create<Packet> (10), protocol, Mac48Address::ConvertFrom (device->GetAddress ()),
+                   Mac48Address::Allocate ());
+}
+
+std::string
+NodeProtocolHandlerTestCase::Deliver (Ptr<SimpleNetDevice> device, uint16_t protocol)
+{
+  m_received = "";
+  Simulator::ScheduleWithContext (device->GetNode ()->GetId (), Seconds (0),
+                                  &NodeProtocolHandlerTestCase::DoDeliver, this, device, protocol);
+  Simulator::Run ();
+  return m_received;
+}
+
+void
+NodeProtocolHandlerTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  Ptr<SimpleNetDevice> dev0 = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> dev1 = CreateObject<SimpleNetDevice> ();
+  dev0->SetAddress (Mac48Address::Allocate ());
+  dev0->SetChannel (channel);
+  dev1->SetAddress (Mac48Address::Allocate ());
+  dev1->SetChannel (channel);
+  node->AddDevice (dev0);
+  node->AddDevice (dev1);
+
+  Node::ProtocolHandler a = MakeBoundCallback (&NodeProtocolHandlerTestCase::Receive, this, std::string ("a"));
+  Node::ProtocolHandler b = MakeBoundCallback (&NodeProtocolHandlerTestCase::Receive, this, std::string ("b"));
+  Node::ProtocolHandler c = MakeBoundCallback (&NodeProtocolHandlerTestCase::Receive, this, std::string ("c"));
+  Node::ProtocolHandler d = MakeBoundCallback (&NodeProtocolHandlerTestCase::Receive, this, std::string ("d"));
+
+  node->RegisterProtocolHandler (a, 0x0800, dev0);
+  node->RegisterProtocolHandler (b, 0, dev0);
+  node->RegisterProtocolHandler (c, 0x0800, 0);
+  node->RegisterProtocolHandler (d, 0x0800, dev0, true);
+
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0800), "abcd", "Unexpected handlers for dev0 and IPv4");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0806), "b", "Unexpected handlers for dev0 and ARP");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0800), "c", "Unexpected handlers for dev1 and IPv4");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0806), "", "Unexpected handlers for dev1 and ARP");
+
+  node->UnregisterProtocolHandler (b);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0800), "acd", "Unregistered handler still reached");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0806), "", "Unregistered handler still reached");
+
+  node->RegisterProtocolHandler (b, 0x0806, 0);
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev1, 0x0806), "b", "Registered handler not reached");
+  NS_TEST_EXPECT_MSG_EQ (Deliver (dev0, 0x0800), "acd", "Unexpected handlers for dev0 and IPv4");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Node TestSuite
+ */
+class NodeTestSuite : public TestSuite
+{
+public:
+  NodeTestSuite ();
+};
+
+NodeTestSuite::NodeTestSuite ()
+  : TestSuite ("node", UNIT)
+{
+  AddTestCase (new NodeProtocolHandlerTestCase, TestCase::QUICK);
+}
+
+static NodeTestSuite g_nodeTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/packet-data-allocator.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the allocations and releases of one thread.
+ */
+class PacketDataAllocatorLocalTestCase : public TestCase
+{
+public:
+  PacketDataAllocatorLocalTestCase ();
+  virtual void DoRun (void);
+};
+
+PacketDataAllocatorLocalTestCase::PacketDataAllocatorLocalTestCase ()
+  : TestCase ("Check that released blocks are reused by their thread")
+{
+}
+
+void
+PacketDataAllocatorLocalTestCase::DoRun (void)
+{
+  uint32_t sizes[] = { 0, 1, 47, 48, 49, 1000, 1500, 65520, 65521, 100000 };
+  for (uint32_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); ++i)
+    {
+      uint32_t capacity;
+      uint8_t *block = static_cast<uint8_t *> (PacketDataAllocator::Allocate (sizes[i], capacity));
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (capacity, sizes[i], "Block too small");
+      NS_TEST_EXPECT_MSG_EQ (reinterpret_cast<uintptr_t> (block) % 16, 0, "Block not aligned");
+      std::memset (block, 0xa5, capacity);
+      PacketDataAllocator::Deallocate (block);
+    }
+
+  PacketDataAllocator::ResetStatistics ();
+  uint32_t capacity;
+  void *first = PacketDataAllocator::Allocate (1000, capacity);
+  PacketDataAllocator::Deallocate (first);
+  void *second = PacketDataAllocator::Allocate (900, capacity);
+  NS_TEST_EXPECT_MSG_EQ (second, first, "Released block not reused");
+  PacketDataAllocator::Deallocate (second);
+  PacketDataAllocator::Statistics stats = PacketDataAllocator::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.hits, 2, "Wrong number of hits");
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 0, "Wrong number of misses");
+  NS_TEST_EXPECT_MSG_EQ (stats.remoteFrees, 0, "Wrong number of remote frees");
+
+  // A packet and its data reuse the memory of a destroyed packet.
+  Ptr<Packet> packet = Create<Packet> (100);
+  Packet *address = PeekPointer (packet);
+  packet = 0;
+  PacketDataAllocator::ResetStatistics ();
+  packet = Create<Packet> (100);
+  stats = PacketDataAllocator::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (PeekPointer (packet), address, "Packet memory not reused");
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 0, "Packet allocated by the system allocator");
+  packet = 0;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a packet larger than the largest pooled block does not
+ * keep the later packets of its thread out of the free lists.
+ */
+class PacketDataAllocatorLargePacketTestCase : public TestCase
+{
+public:
+  PacketDataAllocatorLargePacketTestCase ();
+  virtual void DoRun (void);
+};
+
+PacketDataAllocatorLargePacketTestCase::PacketDataAllocatorLargePacketTestCase ()
+  : TestCase ("Check that small packets are pooled after a large one")
+{
+}
+
+void
+PacketDataAllocatorLargePacketTestCase::DoRun (void)
+{
+  uint8_t small[100];
+  std::memset (small, 0x5a, sizeof (small));
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Create<Packet> (small, sizeof (small));
+    }
+  PacketDataAllocator::ResetStatistics ();
+  Create<Packet> (small, sizeof (small));
+  PacketDataAllocator::Statistics reference = PacketDataAllocator::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (reference.misses, 0, "Small packet allocated by the system allocator");
+
+  std::vector<uint8_t> large (PacketDataAllocator::GetMaxPooledCapacity () * 2, 0xa5);
+  Create<Packet> (&large[0], large.size ());
+
+  // The blocks of the small packets are reused, and become small again.
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Create<Packet> (small, sizeof (small));
+    }
+  PacketDataAllocator::ResetStatistics ();
+  Create<Packet> (small, sizeof (small));
+  PacketDataAllocator::Statistics stats = PacketDataAllocator::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.hits, reference.hits, "Small packet data not served from the free lists");
+  NS_TEST_EXPECT_MSG_EQ (stats.misses, 0, "Small packet allocated by the system allocator");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the release of blocks and packets by other threads.
+ */
+class PacketDataAllocatorRemoteTestCase : public TestCase
+{
+public:
+  PacketDataAllocatorRemoteTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Release blocks.
+   * \param blocks the blocks
+   */
+  static void Release (std::vector<void *> *blocks);
+  /**
+   * Create packets.
+   * \param packets the packets
+   */
+  static void CreatePackets (std::vector<Ptr<Packet> > *packets);
+};
+
+PacketDataAllocatorRemoteTestCase::PacketDataAllocatorRemoteTestCase ()
+  : TestCase ("Check that blocks released by other threads return to their thread")
+{
+}
+
+void
+PacketDataAllocatorRemoteTestCase::Release (std::vector<void *> *blocks)
+{
+  for (std::vector<void *>::iterator i = blocks->begin (); i != blocks->end (); ++i)
+    {
+      PacketDataAllocator::Deallocate (*i);
+    }
+  blocks->clear ();
+}
+
+void
+PacketDataAllocatorRemoteTestCase::CreatePackets (std::vector<Ptr<Packet> > *packets)
+{
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      uint8_t data[200];
+      std::memset (data, i, sizeof (data));
+      packets->push_back (Create<Packet> (data, sizeof (data)));
+    }
+}
+
+void
+PacketDataAllocatorRemoteTestCase::DoRun (void)
+{
+  std::vector<void *> blocks;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      uint32_t capacity;
+      blocks.push_back (PacketDataAllocator::Allocate (500, capacity));
+    }
+  std::thread releaser (&PacketDataAllocatorRemoteTestCase::Release, &blocks);
+  releaser.join ();
+
+  PacketDataAllocator::ResetStatistics ();
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      uint32_t capacity;
+      blocks.push_back (PacketDataAllocator::Allocate (500, capacity));
+    }
+  PacketDataAllocator::Statistics stats = PacketDataAllocator::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.hits, 100, "Blocks released by another thread not reused");
+  Release (&blocks);
+
+  // Packets created by a thread which has exited remain valid.
+  std::vector<Ptr<Packet> > packets;
+  std::thread creator (&PacketDataAllocatorRemoteTestCase::CreatePackets, &packets);
+  creator.join ();
+  NS_TEST_ASSERT_MSG_EQ (packets.size (), 100, "Wrong number of packets");
+  for (uint32_t i = 0; i < packets.size (); ++i)
+    {
+      uint8_t data[200];
+      NS_TEST_EXPECT_MSG_EQ (packets[i]->CopyData (data, sizeof (data)), 200, "Wrong packet size");
+      NS_TEST_EXPECT_MSG_EQ (data[199], i, "Wrong packet content");
+    }
+  packets.clear ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketDataAllocator TestSuite
+ */
+class PacketDataAllocatorTestSuite : public TestSuite
+{
+public:
+  PacketDataAllocatorTestSuite ()
+    : TestSuite ("packet-data-allocator", UNIT)
+  {
+    AddTestCase (new PacketDataAllocatorLocalTestCase, TestCase::QUICK);
+    AddTestCase (new PacketDataAllocatorLargePacketTestCase, TestCase::QUICK);
+    AddTestCase (new PacketDataAllocatorRemoteTestCase, TestCase::QUICK);
+  }
+};
+
+static PacketDataAllocatorTestSuite g_packetDataAllocatorTestSuite; //!< Static variable for test initialization
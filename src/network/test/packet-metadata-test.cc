@@ -918,7 +918,10 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
-  AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  if (PacketMetadata::IsAvailable ())
+    {
+      AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+    }
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
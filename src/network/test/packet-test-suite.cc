@@ -19,13 +19,17 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/byte-tag-list.h"
+#include "ns3/crc32.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
+#include "ns3/replication-runner.h"
 #include <limits>     // std:numeric_limits
 #include <string>
 #include <cstdarg>
 #include <iostream>
 #include <iomanip>
+#include <vector>
 #include <ctime>
 
 using namespace ns3;
@@ -401,6 +405,61 @@ struct Expected
   uint32_t end;   //!< End
 };
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test header which supports lazy serialization
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class ALazyTestHeader : public Header
+{
+public:
+  ALazyTestHeader () : Header (), m_value (0) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::ALazyTestHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<ALazyTestHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    m_serialized++;
+    iter.WriteHtonU32 (m_value);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    m_value = iter.ReadNtohU32 ();
+    return 4;
+  }
+  virtual void Print (std::ostream &os) const {
+    os << m_value;
+  }
+  virtual Header *Clone (void) const {
+    return new ALazyTestHeader (*this);
+  }
+  virtual void Assign (const Header &header) {
+    *this = dynamic_cast<const ALazyTestHeader &> (header);
+  }
+  uint32_t m_value;             //!< Header value
+  static uint32_t m_serialized; //!< Number of calls to Serialize
+};
+
+uint32_t ALazyTestHeader::m_serialized = 0;
+
 }
 
 // tag name, start, end
@@ -737,6 +796,42 @@ PacketTest::DoRun (void)
     ALargeTestTag a;
     tmp->AddPacketTag (a); 
   }
+
+  /* Test the CRC-32 of a packet made of data and zero-filled bytes */
+  {
+    uint8_t data[40];
+    for (uint32_t i = 0; i < sizeof (data); i++)
+      {
+        data[i] = i * 7;
+      }
+    Ptr<Packet> tmp = Create<Packet> (data, sizeof (data));
+    tmp->AddAtEnd (Create<Packet> (1000));
+    tmp->AddHeader (ATestHeader<10> ());
+    uint8_t bytes[1050];
+    tmp->CopyData (bytes, sizeof (bytes));
+    NS_TEST_EXPECT_MSG_EQ (tmp->CalculateCrc32 (), CRC32Calculate (bytes, sizeof (bytes)),
+                           "CRC-32 differs from the CRC-32 of the copied bytes");
+  }
+
+  /* Test that an unshared copy keeps the bytes, tags and uid of the packet */
+  {
+    Ptr<Packet> tmp = Create<Packet> (100);
+    tmp->AddHeader (ATestHeader<10> ());
+    tmp->AddByteTag (ATestTag<25> ());
+    tmp->AddPacketTag (ATestTag<7> ());
+    Ptr<Packet> copy = tmp->Copy ();
+    copy->Unshare ();
+    CHECK (copy, 1, E (25, 0, 110));
+    NS_TEST_EXPECT_MSG_EQ (copy->GetUid (), tmp->GetUid (), "Unshare changed the uid");
+    NS_TEST_EXPECT_MSG_EQ (copy->ToString (), tmp->ToString (), "Unshare changed the metadata");
+    ATestTag<7> tag;
+    NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (tag), true, "Unshare lost the packet tag");
+    ATestHeader<10> header;
+    copy->RemoveHeader (header);
+    copy->AddByteTag (ATestTag<3> ());
+    NS_TEST_EXPECT_MSG_EQ (tmp->GetSize (), 110, "Change to the unshared copy modified the packet");
+    CHECK (tmp, 1, E (25, 0, 110));
+  }
 }
 
 /**
@@ -1035,6 +1130,335 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Lazy header serialization unit tests.
+ */
+class PacketLazyHeaderTest : public TestCase
+{
+public:
+  PacketLazyHeaderTest ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Add headers with the inherited setting, then with lazy headers disabled.
+   * \param replication the replication index
+   */
+  static void Replication (uint32_t replication);
+};
+
+PacketLazyHeaderTest::PacketLazyHeaderTest ()
+  : TestCase ("Lazy header serialization")
+{
+}
+
+void
+PacketLazyHeaderTest::DoTeardown (void)
+{
+  // Do not leak lazy headers into the other test cases
+  Packet::DisableLazyHeaders ();
+}
+
+void
+PacketLazyHeaderTest::Replication (uint32_t replication)
+{
+  NS_UNUSED (replication);
+  uint32_t serialized = ALazyTestHeader::m_serialized;
+  Ptr<Packet> p = Create<Packet> (10);
+  ALazyTestHeader header;
+  p->AddHeader (header);
+  ReplicationRunner::Record ("lazy", ALazyTestHeader::m_serialized == serialized);
+  Packet::DisableLazyHeaders ();
+  // the pending header is serialized before the new one
+  p->AddHeader (header);
+  ReplicationRunner::Record ("disabled", ALazyTestHeader::m_serialized == serialized + 2);
+}
+
+void
+PacketLazyHeaderTest::DoRun (void)
+{
+  Packet::EnableLazyHeaders ();
+  ALazyTestHeader::m_serialized = 0;
+
+  Ptr<Packet> p = Create<Packet> (10);
+  ALazyTestHeader header;
+  header.m_value = 0x01020304;
+  p->AddHeader (header);
+  header.m_value = 0x05060708;
+  p->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 18, "Pending header not counted");
+
+  // a copy shares the pending headers
+  Ptr<Packet> copy = p->Copy ();
+
+  ALazyTestHeader removed;
+  p->RemoveHeader (removed);
+  NS_TEST_EXPECT_MSG_EQ (removed.m_value, 0x05060708, "Bad outer header");
+  p->PeekHeader (removed);
+  NS_TEST_EXPECT_MSG_EQ (removed.m_value, 0x01020304, "Bad inner header");
+  header.m_value = 0x090a0b0c;
+  p->AddHeader (header);
+  p->RemoveHeader (removed);
+  p->RemoveHeader (removed);
+  NS_TEST_EXPECT_MSG_EQ (removed.m_value, 0x01020304, "Bad inner header");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "Bad payload size");
+  NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, 0, "Header serialized");
+
+  // reading the bytes serializes the pending headers
+  uint8_t bytes[18];
+  copy->CopyData (bytes, 18);
+  NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, 2, "Headers not serialized");
+  NS_TEST_EXPECT_MSG_EQ (bytes[0], 0x05, "Bad outer header bytes");
+  NS_TEST_EXPECT_MSG_EQ (bytes[7], 0x04, "Bad inner header bytes");
+  NS_TEST_EXPECT_MSG_EQ (bytes[8], 0x00, "Bad payload bytes");
+  copy->RemoveHeader (removed);
+  NS_TEST_EXPECT_MSG_EQ (removed.m_value, 0x05060708, "Bad deserialized header");
+
+  // a header which does not support lazy serialization reads the
+  // bytes of the pending headers
+  p = Create<Packet> (10);
+  header.m_value = 0x11121314;
+  p->AddHeader (header);
+  ATestHeader<4> other;
+  p->RemoveHeader (other);
+  NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, 3, "Header not serialized");
+  NS_TEST_EXPECT_MSG_EQ (other.m_error, true, "Bad header bytes");
+
+  // each replication has its own setting: disabling lazy headers in
+  // one of them changes neither the next one nor the main program
+  ReplicationRunner runner;
+  runner.SetThreadCount (1);
+  runner.Run (2, MakeCallback (&PacketLazyHeaderTest::Replication));
+  std::vector<double> lazy = runner.GetValues ("lazy");
+  std::vector<double> disabled = runner.GetValues ("disabled");
+  NS_TEST_ASSERT_MSG_EQ (lazy.size (), 2, "Missing replication results");
+  NS_TEST_ASSERT_MSG_EQ (disabled.size (), 2, "Missing replication results");
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (lazy[i], 1, "Replication " << i << " did not inherit the setting");
+      NS_TEST_EXPECT_MSG_EQ (disabled[i], 1, "Replication " << i << " did not disable lazy headers");
+    }
+  p = Create<Packet> (10);
+  p->AddHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (ALazyTestHeader::m_serialized, 7, "Setting of the main program changed");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Copy-on-write and growth of the PacketTagList block.
+ */
+class PacketTagListBlockTest : public TestCase
+{
+public:
+  PacketTagListBlockTest ();
+  virtual void DoRun (void);
+};
+
+PacketTagListBlockTest::PacketTagListBlockTest ()
+  : TestCase ("PacketTagList copy-on-write and block growth")
+{
+}
+
+void
+PacketTagListBlockTest::DoRun (void)
+{
+  PacketTagList a;
+  a.Add (ATestTag<1> (1));
+  a.Add (ATestTag<2> (2));
+
+  // a copy shares the block until one of the lists is modified
+  PacketTagList b (a);
+  bool shared = a.Head () == b.Head ();
+  NS_TEST_EXPECT_MSG_EQ (shared, true, "Copy does not share the block");
+  b.Add (ATestTag<3> (3));
+  shared = a.Head () == b.Head ();
+  NS_TEST_EXPECT_MSG_EQ (shared, false, "Add did not copy a shared block");
+  ATestTag<3> t3;
+  NS_TEST_EXPECT_MSG_EQ (a.Peek (t3), false, "Add changed the original list");
+  NS_TEST_EXPECT_MSG_EQ (b.Peek (t3), true, "Add lost the new tag");
+  NS_TEST_EXPECT_MSG_EQ (t3.GetData (), 3, "Bad tag value");
+
+  PacketTagList c (a);
+  ATestTag<1> t1;
+  NS_TEST_EXPECT_MSG_EQ (c.Remove (t1), true, "Remove did not find the tag");
+  shared = a.Head () == c.Head ();
+  NS_TEST_EXPECT_MSG_EQ (shared, false, "Remove did not copy a shared block");
+  NS_TEST_EXPECT_MSG_EQ (a.Peek (t1), true, "Remove changed the original list");
+  NS_TEST_EXPECT_MSG_EQ (c.Peek (t1), false, "Remove left the tag");
+
+  c = a;
+  ATestTag<2> t2 (20);
+  NS_TEST_EXPECT_MSG_EQ (c.Replace (t2), true, "Replace did not find the tag");
+  shared = a.Head () == c.Head ();
+  NS_TEST_EXPECT_MSG_EQ (shared, false, "Replace did not copy a shared block");
+  NS_TEST_EXPECT_MSG_EQ (a.Peek (t2), true, "Replace removed the original tag");
+  NS_TEST_EXPECT_MSG_EQ (t2.GetData (), 2, "Replace changed the original list");
+  NS_TEST_EXPECT_MSG_EQ (c.Peek (t2), true, "Replace lost the tag");
+  NS_TEST_EXPECT_MSG_EQ (t2.GetData (), 20, "Replace did not change the tag");
+
+  // an unshared block with free space is modified in place
+  const PacketTagList::TagData *head = c.Head ();
+  ATestTag<2> t2b (21);
+  c.Replace (t2b);
+  bool inPlace = c.Head () == head;
+  NS_TEST_EXPECT_MSG_EQ (inPlace, true, "Replace copied an unshared block");
+
+  // the block grows as tags are added, keeping the older ones
+  PacketTagList d;
+  d.Add (ATestTag<1> (1));
+  PacketTagList e (d);
+  d.Add (ATestTag<2> (2));
+  d.Add (ATestTag<3> (3));
+  d.Add (ATestTag<4> (4));
+  d.Add (ALargeTestTag ());
+  d.Add (ATestTag<5> (5));
+  d.Add (ATestTag<6> (6));
+  d.Add (ATestTag<7> (7));
+  d.Add (ATestTag<8> (8));
+  uint32_t n = 0;
+  for (const PacketTagList::TagData *cur = d.Head (); cur != d.End (); cur = PacketTagList::Next (cur))
+    {
+      n++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (n, 9, "Bad number of tags");
+  ATestTag<1> g1;
+  ATestTag<4> g4;
+  ATestTag<8> g8;
+  ALargeTestTag large;
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (g1), true, "Oldest tag lost");
+  NS_TEST_EXPECT_MSG_EQ (g1.GetData (), 1, "Bad oldest tag value");
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (g4), true, "Tag lost");
+  NS_TEST_EXPECT_MSG_EQ (g4.GetData (), 4, "Bad tag value");
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (g8), true, "Newest tag lost");
+  NS_TEST_EXPECT_MSG_EQ (g8.GetData (), 8, "Bad newest tag value");
+  NS_TEST_EXPECT_MSG_EQ (g1.m_error || g4.m_error || g8.m_error, false, "Corrupt tag data");
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (large), true, "Large tag lost");
+  NS_TEST_EXPECT_MSG_EQ (e.Peek (g4), false, "Growth changed a copy");
+  NS_TEST_EXPECT_MSG_EQ (e.Peek (g1), true, "Growth changed a copy");
+  NS_TEST_EXPECT_MSG_EQ (d.Remove (g4), true, "Remove did not find the tag");
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (g4), false, "Remove left the tag");
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (g1), true, "Remove lost an older tag");
+  NS_TEST_EXPECT_MSG_EQ (d.Peek (g8), true, "Remove lost a newer tag");
+  NS_TEST_EXPECT_MSG_EQ (g8.GetData (), 8, "Remove changed a newer tag");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Trimming of the ByteTagList when bytes are added to a packet.
+ */
+class ByteTagListTrimTest : public TestCase
+{
+public:
+  ByteTagListTrimTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Check the tags of a list.
+   * \param list The list.
+   * \param n The number of tags expected.
+   * \param ... For each tag, from the oldest, its data, start and end offsets.
+   */
+  void CheckList (const ByteTagList &list, uint32_t n, ...);
+};
+
+ByteTagListTrimTest::ByteTagListTrimTest ()
+  : TestCase ("ByteTagList trimming")
+{
+}
+
+void
+ByteTagListTrimTest::CheckList (const ByteTagList &list, uint32_t n, ...)
+{
+  va_list ap;
+  va_start (ap, n);
+  ByteTagList::Iterator i = list.Begin (0, 1000);
+  for (uint32_t k = 0; k < n; ++k)
+    {
+      int data = va_arg (ap, int);
+      int start = va_arg (ap, int);
+      int end = va_arg (ap, int);
+      NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Missing tag " << k);
+      ByteTagList::Iterator::Item item = i.Next ();
+      NS_TEST_EXPECT_MSG_EQ ((int)item.buf.ReadU8 (), data, "Bad data of tag " << k);
+      NS_TEST_EXPECT_MSG_EQ (item.start, start, "Bad start of tag " << k);
+      NS_TEST_EXPECT_MSG_EQ (item.end, end, "Bad end of tag " << k);
+    }
+  va_end (ap);
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, "Extra tags");
+}
+
+void
+ByteTagListTrimTest::DoRun (void)
+{
+  TypeId tid = ATestTag<1>::GetTypeId ();
+  ByteTagList list;
+  list.Add (tid, 1, 0, 10).WriteU8 (1);
+  list.Add (tid, 1, 5, 20).WriteU8 (2);
+  list.Add (tid, 1, 20, 30).WriteU8 (3);
+  ByteTagList copy (list);
+
+  // nothing to cut
+  list.AddAtEnd (30);
+  list.AddAtStart (0);
+  CheckList (list, 3, 1, 0, 10, 2, 5, 20, 3, 20, 30);
+
+  // the tags are cut at the end, and removed if they start after it
+  list.AddAtEnd (15);
+  CheckList (list, 2, 1, 0, 10, 2, 5, 15);
+  CheckList (copy, 3, 1, 0, 10, 2, 5, 20, 3, 20, 30);
+
+  // the tags are cut at the start, and removed if they end before it
+  list.AddAtStart (8);
+  CheckList (list, 2, 1, 8, 10, 2, 8, 15);
+  list.AddAtStart (12);
+  CheckList (list, 1, 2, 12, 15);
+  CheckList (copy, 3, 1, 0, 10, 2, 5, 20, 3, 20, 30);
+
+  // the offsets are adjusted before they are compared
+  copy.Adjust (100);
+  copy.AddAtEnd (115);
+  copy.AddAtStart (108);
+  ByteTagList::Iterator i = copy.Begin (100, 200);
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "Missing adjusted tag");
+  ByteTagList::Iterator::Item item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.start, 108, "Bad start of adjusted tag");
+  NS_TEST_EXPECT_MSG_EQ (item.end, 110, "Bad end of adjusted tag");
+  item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.start, 108, "Bad start of adjusted tag");
+  NS_TEST_EXPECT_MSG_EQ (item.end, 115, "Bad end of adjusted tag");
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, "Extra adjusted tags");
+
+  // removing every tag empties the list
+  list.AddAtEnd (12);
+  CheckList (list, 0);
+
+  // through a packet, the bytes added at either end are not tagged
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddByteTag (ATestTag<1> (1));
+  Ptr<Packet> shared = p->Copy ();
+  p->RemoveAtEnd (4);
+  p->AddPaddingAtEnd (4);
+  p->RemoveAtStart (2);
+  p->AddHeader (ATestHeader<2> ());
+  ByteTagIterator j = p->GetByteTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (j.HasNext (), true, "Missing packet tag");
+  ByteTagIterator::Item packetItem = j.Next ();
+  NS_TEST_EXPECT_MSG_EQ (packetItem.GetStart (), 2, "Bad start of packet tag");
+  NS_TEST_EXPECT_MSG_EQ (packetItem.GetEnd (), 6, "Bad end of packet tag");
+  NS_TEST_EXPECT_MSG_EQ (j.HasNext (), false, "Extra packet tags");
+  j = shared->GetByteTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (j.HasNext (), true, "Missing tag of the copy");
+  packetItem = j.Next ();
+  NS_TEST_EXPECT_MSG_EQ (packetItem.GetStart (), 0, "Trim changed a copy");
+  NS_TEST_EXPECT_MSG_EQ (packetItem.GetEnd (), 10, "Trim changed a copy");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1476,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketLazyHeaderTest, TestCase::QUICK);
+  AddTestCase (new PacketTagListBlockTest, TestCase::QUICK);
+  AddTestCase (new ByteTagListTrimTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -21,6 +21,9 @@
 #include <cstdlib>
 #include <sstream>
 #include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include "ns3/log.h"
 #include "ns3/test.h"
@@ -1144,6 +1147,166 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that buffered and background writes
+ * produce the same file as unbuffered writes, including when the process
+ * forks while records are buffered.
+ */
+class BufferedWriteTestCase : public TestCase
+{
+public:
+  BufferedWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write the known packets to a file.
+   * \param bufferSize the size of the write buffer
+   * \param async whether full buffers are written in the background
+   * \param forkHalfway whether to fork after half of the packets, and
+   *        close the file in the child process
+   * \returns the content of the file
+   */
+  std::string WriteKnownPackets (uint32_t bufferSize, bool async, bool forkHalfway = false);
+  /**
+   * Write the known packets many times to a file whose records are not
+   * written through, as in optimized builds, and check that they stay in
+   * the write buffer, which is larger than the buffer of the file stream,
+   * until the file is closed.
+   * \param async whether full buffers are written in the background
+   * \param expected the content of a file holding the known packets once
+   */
+  void CheckBufferedMode (bool async, const std::string &expected);
+  /**
+   * \param filename the name of a file
+   * \returns the size of the file
+   */
+  static std::streamoff GetFileSize (const std::string &filename);
+};
+
+BufferedWriteTestCase::BufferedWriteTestCase ()
+  : TestCase ("Check that buffered writes to a PcapFile produce the same file")
+{
+}
+
+std::string
+BufferedWriteTestCase::WriteKnownPackets (uint32_t bufferSize, bool async, bool forkHalfway)
+{
+  std::string filename = CreateTempDirFilename ("buffered.pcap");
+  PcapFile f;
+  f.SetWriteBufferSize (bufferSize);
+  f.SetAsyncFlush (async);
+  f.Open (filename, std::ios::out);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  // a small snaplen truncates some of the records
+  f.Init (1, 64);
+  for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+    {
+      PacketEntry const & p = knownPackets[i];
+      f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+      if (forkHalfway && i == N_KNOWN_PACKETS / 2)
+        {
+          pid_t pid = fork ();
+          if (pid == 0)
+            {
+              // the records buffered before the fork are the parent's
+              f.Close ();
+              _exit (f.Fail () ? 1 : 0);
+            }
+          int status = 0;
+          NS_TEST_EXPECT_MSG_EQ (waitpid (pid, &status, 0), pid, "Could not wait for the child");
+          NS_TEST_EXPECT_MSG_EQ ((WIFEXITED (status) && WEXITSTATUS (status) == 0), true,
+                                 "The child could not close the file");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+  f.Close ();
+
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  std::stringstream content;
+  content << in.rdbuf ();
+  in.close ();
+  if (remove (filename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << filename);
+    }
+  return content.str ();
+}
+
+std::streamoff
+BufferedWriteTestCase::GetFileSize (const std::string &filename)
+{
+  std::ifstream in (filename.c_str (), std::ios::binary | std::ios::ate);
+  return in.tellg ();
+}
+
+void
+BufferedWriteTestCase::CheckBufferedMode (bool async, const std::string &expected)
+{
+  std::string filename = CreateTempDirFilename ("buffered-mode.pcap");
+  PcapFile f;
+  f.SetWriteBufferSize (1 << 20);
+  f.SetAsyncFlush (async);
+  // debug builds write the records through by default
+  f.SetWriteThrough (false);
+  f.Open (filename, std::ios::out);
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, 64);
+  std::streamoff initial = GetFileSize (filename);
+  std::string records = expected.substr (24);
+  std::string repeated = expected;
+  for (uint32_t n = 0; n < 100; ++n)
+    {
+      for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+        {
+          PacketEntry const & p = knownPackets[i];
+          f.Write (p.tsSec, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+        }
+      if (n > 0)
+        {
+          repeated += records;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (GetFileSize (filename), initial, "Records written before the buffer is full");
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (GetFileSize (filename), (std::streamoff)repeated.size (),
+                         "Records not written by Close");
+
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  std::stringstream content;
+  content << in.rdbuf ();
+  in.close ();
+  NS_TEST_EXPECT_MSG_EQ ((content.str () == repeated), true, "Buffered writes differ");
+  if (remove (filename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << filename);
+    }
+}
+
+void
+BufferedWriteTestCase::DoRun (void)
+{
+  std::string expected = WriteKnownPackets (0, false);
+  NS_TEST_ASSERT_MSG_GT (expected.size (), 24, "No record written");
+  NS_TEST_EXPECT_MSG_EQ ((WriteKnownPackets (0, true) == expected), true,
+                         "Background writes without buffer differ");
+  NS_TEST_EXPECT_MSG_EQ ((WriteKnownPackets (100, false) == expected), true,
+                         "Buffered writes differ");
+  NS_TEST_EXPECT_MSG_EQ ((WriteKnownPackets (100, true) == expected), true,
+                         "Buffered background writes differ");
+  NS_TEST_EXPECT_MSG_EQ ((WriteKnownPackets (1 << 20, true) == expected), true,
+                         "Writes with a large background buffer differ");
+  NS_TEST_EXPECT_MSG_EQ ((WriteKnownPackets (100, true, true) == expected), true,
+                         "Buffered background writes differ across a fork");
+  NS_TEST_EXPECT_MSG_EQ ((WriteKnownPackets (1 << 20, false, true) == expected), true,
+                         "Buffered writes differ across a fork");
+  CheckBufferedMode (false, expected);
+  CheckBufferedMode (true, expected);
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1330,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new BufferedWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
@@ -25,14 +25,14 @@
  * COPYRIGHT (C) 1986 Gary S. Brown.  You may use this program, or
  * code or tables extracted from it, as desired without restriction.
  */
-#include <stdint.h>
+#include "crc32.h"
 
 namespace ns3 {
 
 /**
  * Table of CRC-32 values.
  */
-static uint32_t crc32table[256] = {
+static const uint32_t crc32table[256] = {
 0x00000000,0x77073096,0xEE0E612C,0x990951BA,0x076DC419,0x706AF48F,0xE963A535,0x9E6495A3,
 0x0EDB8832,0x79DCB8A4,0xE0D5E91E,0x97D2D988,0x09B64C2B,0x7EB17CBD,0xE7B82D07,0x90BF1D91,
 0x1DB71064,0x6AB020F2,0xF3B97148,0x84BE41DE,0x1ADAD47D,0x6DDDE4EB,0xF4D4B551,0x83D385C7,
@@ -67,11 +67,48 @@ static uint32_t crc32table[256] = {
 0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D 
 };
 
+/**
+ * Tables of the CRC-32 of a byte followed by 0 to 7 zero bytes, used
+ * to process eight bytes at a time ("slicing-by-8").
+ */
+struct Crc32Tables
+{
+  Crc32Tables ()
+  {
+    for (uint32_t i = 0; i < 256; i++)
+      {
+        table[0][i] = crc32table[i];
+      }
+    for (uint32_t k = 1; k < 8; k++)
+      {
+        for (uint32_t i = 0; i < 256; i++)
+          {
+            uint32_t crc = table[k - 1][i];
+            table[k][i] = (crc >> 8) ^ crc32table[crc & 0xFF];
+          }
+      }
+  }
+  uint32_t table[8][256]; //!< the tables
+};
+
 uint32_t
-CRC32Calculate (const uint8_t *data, int length)
+CRC32Update (uint32_t crc, const uint8_t *data, uint32_t length)
 {
-  uint32_t crc = 0xffffffff;
+  static const Crc32Tables tables;
+  const uint32_t (*t)[256] = tables.table;
 
+  crc = ~crc;
+  while (length >= 8)
+    {
+      uint32_t one = crc ^ (data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t> (data[3]) << 24));
+      uint32_t two = data[4] | (data[5] << 8) | (data[6] << 16) | (static_cast<uint32_t> (data[7]) << 24);
+      crc = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^
+        t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+        t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^
+        t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+      data += 8;
+      length -= 8;
+    }
   while (length--)
     {
       crc = (crc >> 8) ^ crc32table[(crc & 0xFF) ^ *data++];
@@ -79,5 +116,10 @@ CRC32Calculate (const uint8_t *data, int length)
   return ~crc;
 }
 
-} // namespace ns3
+uint32_t
+CRC32Calculate (const uint8_t *data, int length)
+{
+  return CRC32Update (0, data, length);
+}
 
+} // namespace ns3
@@ -33,6 +33,19 @@ namespace ns3 {
  */
 uint32_t CRC32Calculate (const uint8_t *data, int length);
 
+/**
+ * Updates a CRC-32 with more input
+ *
+ * The CRC-32 of the concatenation of two buffers is
+ * CRC32Update (CRC32Calculate (first, firstLength), second, secondLength).
+ *
+ * \param crc the CRC-32 of the preceding bytes, or zero
+ * \param data buffer to calculate the checksum for
+ * \param length the length of the buffer (bytes)
+ * \returns the computed crc-32.
+ */
+uint32_t CRC32Update (uint32_t crc, const uint8_t *data, uint32_t length);
+
 } // namespace ns3
 
 #endif
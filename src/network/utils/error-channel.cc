@@ -21,6 +21,7 @@
 #include "ns3/simple-net-device.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "error-channel.h"
@@ -129,6 +130,18 @@ ErrorChannel::Send (Ptr<Packet> p, uint16_t protocol,
     }
 }
 
+void
+ErrorChannel::SendBurst (Ptr<const PacketBurst> burst, uint16_t protocol,
+                         Mac48Address to, Mac48Address from,
+                         Ptr<SimpleNetDevice> sender)
+{
+  NS_LOG_FUNCTION (burst << protocol << to << from << sender);
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      Send (*i, protocol, to, from, sender);
+    }
+}
+
 void
 ErrorChannel::Add (Ptr<SimpleNetDevice> device)
 {
@@ -49,6 +49,18 @@ public:
   // inherited from ns3::SimpleChannel
   virtual void Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
                      Ptr<SimpleNetDevice> sender);
+  /**
+   * Send the packets of the burst one at a time, so that each of them
+   * can be delayed or duplicated.
+   *
+   * \param burst packets to be sent
+   * \param protocol protocol number
+   * \param to address to send packets to
+   * \param from address the packets are coming from
+   * \param sender netdevice who sent the packets
+   */
+  virtual void SendBurst (Ptr<const PacketBurst> burst, uint16_t protocol, Mac48Address to, Mac48Address from,
+                          Ptr<SimpleNetDevice> sender);
 
   virtual void Add (Ptr<SimpleNetDevice> device);
 
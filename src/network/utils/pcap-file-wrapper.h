@@ -82,6 +82,11 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write all the buffered packets to the underlying pcap file.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -224,6 +229,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_writeBufferSize; //!< size of the write buffer
+  bool     m_asyncFlush; //!< write full buffers in the background
 };
 
 } // namespace ns3
@@ -20,6 +20,12 @@
 
 #include <iostream>
 #include <cstring>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <pthread.h>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -47,19 +53,276 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+const uint32_t MAX_PENDING_WRITES = 64;      /**< Number of buffers queued to the background writer before writers wait */
+
+/**
+ * \brief Writes the full write buffers of all the PcapFile objects.
+ *
+ * A single background thread serves all the files, in the order in which
+ * their buffers were submitted.  The thread is started on first use and
+ * lives until the end of the program.
+ *
+ * The writer also keeps the list of the open files, so that a fork()
+ * first writes all their records: the child process then starts with
+ * empty buffers and its own writer, and no record is written twice.
+ */
+class PcapFileWriter
+{
+public:
+  /**
+   * \returns the background writer
+   */
+  static PcapFileWriter * Get (void);
+  /**
+   * Queue the content of the write buffer of a file.
+   * \param file the file, whose write buffer is left empty
+   */
+  void Submit (PcapFile *file);
+  /**
+   * Wait until all the buffers queued for a file are written.
+   * \param file the file
+   */
+  void Wait (const PcapFile *file);
+  /**
+   * Check, without blocking, that no buffer of a file is queued.
+   * \param file the file
+   * \returns false if a buffer of the file is queued or if the lock of
+   *          the queue is held
+   */
+  bool IsIdle (const PcapFile *file);
+  /**
+   * Add a file to the files written before a fork.
+   * \param file the file
+   */
+  void Register (PcapFile *file);
+  /**
+   * Remove a file from the files written before a fork.
+   * \param file the file
+   */
+  void Unregister (PcapFile *file);
+
+private:
+  /**
+   * Constructor
+   * \param files the files written before a fork
+   */
+  PcapFileWriter (const std::set<PcapFile *> &files);
+  /**
+   * \returns the address of the pointer to the background writer
+   */
+  static PcapFileWriter ** Peek (void);
+  /**
+   * Create the background writer and install the fork handlers.
+   * \returns true
+   */
+  static bool Init (void);
+  /**
+   * Write the records of all the files, and hold the locks until the
+   * fork is done, so that the background thread is idle.
+   */
+  static void PrepareFork (void);
+  /**
+   * Release the locks taken before the fork, in the parent process.
+   */
+  static void ParentFork (void);
+  /**
+   * Replace the background writer of the child process, whose thread
+   * and locks were not duplicated.
+   */
+  static void ChildFork (void);
+  /**
+   * Body of the background thread.
+   */
+  void Run (void);
+
+  /**
+   * \brief A buffer to write to a file
+   */
+  struct Job
+  {
+    PcapFile *file;               //!< the file
+    std::vector<uint8_t> data;    //!< the records to write
+  };
+
+  std::mutex m_mutex;                   //!< guards the queue and the pending counts
+  std::condition_variable m_queued;     //!< signalled when a job is queued
+  std::condition_variable m_written;    //!< signalled when a job is written
+  std::deque<Job> m_jobs;               //!< jobs not yet written
+  bool m_running;                       //!< whether the background thread is started
+  std::mutex m_filesMutex;              //!< guards the open files
+  std::set<PcapFile *> m_files;         //!< the open files
+};
+
+PcapFileWriter **
+PcapFileWriter::Peek (void)
+{
+  static PcapFileWriter *writer = 0;
+  return &writer;
+}
+
+bool
+PcapFileWriter::Init (void)
+{
+  // Never deleted, so that files closed during static destruction can
+  // still wait for their buffers.
+  *Peek () = new PcapFileWriter (std::set<PcapFile *> ());
+  pthread_atfork (&PcapFileWriter::PrepareFork, &PcapFileWriter::ParentFork,
+                  &PcapFileWriter::ChildFork);
+  return true;
+}
+
+PcapFileWriter *
+PcapFileWriter::Get (void)
+{
+  static bool initialized = Init ();
+  (void) initialized;
+  return *Peek ();
+}
+
+PcapFileWriter::PcapFileWriter (const std::set<PcapFile *> &files)
+  : m_running (false),
+    m_files (files)
+{
+}
+
+void
+PcapFileWriter::Register (PcapFile *file)
+{
+  std::unique_lock<std::mutex> lock (m_filesMutex);
+  m_files.insert (file);
+}
+
+void
+PcapFileWriter::Unregister (PcapFile *file)
+{
+  std::unique_lock<std::mutex> lock (m_filesMutex);
+  m_files.erase (file);
+}
+
+void
+PcapFileWriter::PrepareFork (void)
+{
+  PcapFileWriter *writer = Get ();
+  writer->m_filesMutex.lock ();
+  for (std::set<PcapFile *>::const_iterator i = writer->m_files.begin (); i != writer->m_files.end (); ++i)
+    {
+      (*i)->Drain (true);
+    }
+  writer->m_mutex.lock ();
+}
+
+void
+PcapFileWriter::ParentFork (void)
+{
+  PcapFileWriter *writer = Get ();
+  writer->m_mutex.unlock ();
+  writer->m_filesMutex.unlock ();
+}
+
+void
+PcapFileWriter::ChildFork (void)
+{
+  // The jobs were all written before the fork.  The locks of the old
+  // writer are held by the forking thread and its condition variables
+  // may count the waits of the threads which do not exist in the child,
+  // so the old writer is left alone.
+  PcapFileWriter *writer = Get ();
+  *Peek () = new PcapFileWriter (writer->m_files);
+}
+
+void
+PcapFileWriter::Submit (PcapFile *file)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  if (!m_running)
+    {
+      std::thread (&PcapFileWriter::Run, this).detach ();
+      m_running = true;
+    }
+  while (m_jobs.size () >= MAX_PENDING_WRITES)
+    {
+      m_written.wait (lock);
+    }
+  m_jobs.push_back (Job ());
+  m_jobs.back ().file = file;
+  m_jobs.back ().data.swap (file->m_writeBuffer);
+  file->m_pendingWrites++;
+  m_queued.notify_one ();
+}
+
+void
+PcapFileWriter::Wait (const PcapFile *file)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (file->m_pendingWrites > 0)
+    {
+      m_written.wait (lock);
+    }
+}
+
+bool
+PcapFileWriter::IsIdle (const PcapFile *file)
+{
+  std::unique_lock<std::mutex> lock (m_mutex, std::try_to_lock);
+  return lock.owns_lock () && file->m_pendingWrites == 0;
+}
+
+void
+PcapFileWriter::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (m_jobs.empty ())
+        {
+          m_queued.wait (lock);
+        }
+      // the job stays queued while it is written so that Wait sees it pending
+      Job &job = m_jobs.front ();
+      lock.unlock ();
+      job.file->m_file.write ((const char *)job.data.data (), job.data.size ());
+      lock.lock ();
+      job.file->m_pendingWrites--;
+      m_jobs.pop_front ();
+      m_written.notify_all ();
+    }
+}
+
+PcapFile::DrainBuffer::DrainBuffer (PcapFile *file)
+  : m_pcap (file)
+{
+}
+
+int
+PcapFile::DrainBuffer::sync (void)
+{
+  m_pcap->Drain (false);
+  return 0;
+}
+
 PcapFile::PcapFile ()
   : m_file (),
+    m_drainBuffer (this),
+    m_drainStream (&m_drainBuffer),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writeBufferSize (WRITE_BUFFER_DEFAULT),
+    m_asyncFlush (false),
+    m_asyncUsed (false),
+    m_writeThrough (false),
+    m_pendingWrites (0)
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::RegisterStream (&m_file); 
+  NS_BUILD_DEBUG (m_writeThrough = true);
+  FatalImpl::RegisterStream (&m_drainStream); 
+  PcapFileWriter::Get ()->Register (this);
 }
 
 PcapFile::~PcapFile ()
 {
   NS_LOG_FUNCTION (this);
-  FatalImpl::UnregisterStream (&m_file);
+  FatalImpl::UnregisterStream (&m_drainStream);
+  PcapFileWriter::Get ()->Unregister (this);
   Close ();
 }
 
@@ -68,18 +331,21 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  WaitForWrites ();
   return m_file.fail ();
 }
 bool 
 PcapFile::Eof (void) const
 {
   NS_LOG_FUNCTION (this);
+  WaitForWrites ();
   return m_file.eof ();
 }
 void 
 PcapFile::Clear (void)
 {
   NS_LOG_FUNCTION (this);
+  WaitForWrites ();
   m_file.clear ();
 }
 
@@ -88,9 +354,120 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  Flush ();
   m_file.close ();
 }
 
+void
+PcapFile::SetWriteBufferSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  Flush ();
+  m_writeBufferSize = size;
+  m_writeBuffer.reserve (size);
+}
+
+void
+PcapFile::SetAsyncFlush (bool async)
+{
+  NS_LOG_FUNCTION (this << async);
+  Flush ();
+  m_asyncFlush = async;
+}
+
+void
+PcapFile::SetWriteThrough (bool writeThrough)
+{
+  NS_LOG_FUNCTION (this << writeThrough);
+  Flush ();
+  m_writeThrough = writeThrough;
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  FlushWriteBuffer ();
+  WaitForWrites ();
+}
+
+uint8_t *
+PcapFile::Reserve (uint32_t size)
+{
+  std::size_t used = m_writeBuffer.size ();
+  m_writeBuffer.resize (used + size);
+  return m_writeBuffer.data () + used;
+}
+
+void
+PcapFile::EndRecord (void)
+{
+  bool full = m_writeBuffer.size () >= m_writeBufferSize;
+  if (full || (m_writeThrough && !m_asyncFlush))
+    {
+      FlushWriteBuffer ();
+    }
+}
+
+void
+PcapFile::FlushWriteBuffer (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writeBuffer.empty ())
+    {
+      return;
+    }
+  if (m_asyncFlush && m_writeBufferSize > 0)
+    {
+      m_asyncUsed = true;
+      PcapFileWriter::Get ()->Submit (this);
+      m_writeBuffer.reserve (m_writeBufferSize);
+    }
+  else
+    {
+      m_file.write ((const char *)m_writeBuffer.data (), m_writeBuffer.size ());
+      m_writeBuffer.clear ();
+      if (m_writeThrough)
+        {
+          m_file.flush ();
+        }
+    }
+}
+
+void
+PcapFile::WaitForWrites (void) const
+{
+  if (m_asyncUsed)
+    {
+      PcapFileWriter::Get ()->Wait (this);
+    }
+}
+
+void
+PcapFile::Drain (bool wait)
+{
+  if (wait)
+    {
+      WaitForWrites ();
+    }
+  else if (m_asyncUsed && !PcapFileWriter::Get ()->IsIdle (this))
+    {
+      // The lock may be held by the thread which is aborting: give up
+      // rather than block, and rather than write the buffer before the
+      // records which are still queued.
+      return;
+    }
+  if (!m_writeBuffer.empty ())
+    {
+      m_file.write ((const char *)m_writeBuffer.data (), m_writeBuffer.size ());
+      m_writeBuffer.clear ();
+    }
+  if (m_file.is_open ())
+    {
+      m_file.flush ();
+    }
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -206,6 +583,7 @@ PcapFile::WriteFileHeader (void)
   // If we're initializing the file, we need to write the pcap file header
   // at the start of the file.
   //
+  Flush ();
   m_file.seekp (0, std::ios::beg);
  
   //
@@ -326,6 +704,7 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
   NS_ASSERT ((mode & std::ios::app) == 0);
+  Flush ();
   NS_ASSERT (!m_file.fail ());
   //
   // All pcap files are binary files, so we just do this automatically.
@@ -403,7 +782,8 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  // the stream may be in use by the background writer
+  NS_ASSERT (m_asyncUsed || m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,11 +802,11 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  uint8_t *buffer = Reserve (16);
+  std::memcpy (buffer, &header.m_tsSec, sizeof(header.m_tsSec));
+  std::memcpy (buffer + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+  std::memcpy (buffer + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+  std::memcpy (buffer + 12, &header.m_origLen, sizeof(header.m_origLen));
   return inclLen;
 }
 
@@ -435,8 +815,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  std::memcpy (Reserve (inclLen), data, inclLen);
+  EndRecord ();
 }
 
 void 
@@ -444,8 +824,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  p->CopyData (Reserve (inclLen), inclLen);
+  EndRecord ();
 }
 
 void 
@@ -460,9 +840,10 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
+  headerBuffer.CopyData (Reserve (toCopy), toCopy);
   inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  p->CopyData (Reserve (inclLen), inclLen);
+  EndRecord ();
 }
 
 void
@@ -476,6 +857,7 @@ PcapFile::Read (
   uint32_t &readLen)
 {
   NS_LOG_FUNCTION (this << &data <<maxBytes << tsSec << tsUsec << inclLen << origLen << readLen);
+  Flush ();
   NS_ASSERT (m_file.good ());
 
   PcapRecordHeader header;
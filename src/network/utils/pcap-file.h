@@ -23,6 +23,9 @@
 
 #include <string>
 #include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ptr.h"
 
@@ -44,6 +47,7 @@ class PcapFile
 public:
   static const int32_t  ZONE_DEFAULT    = 0;           /**< Time zone offset for current location */
   static const uint32_t SNAPLEN_DEFAULT = 65535;       /**< Default value for maximum octets to save per packet */
+  static const uint32_t WRITE_BUFFER_DEFAULT = 0;      /**< Default size of the write buffer (write-through) */
 
 public:
   PcapFile ();
@@ -85,6 +89,58 @@ public:
    */
   void Close (void);
 
+  /**
+   * \brief Set the size of the write buffer.
+   *
+   * Records written to the file are gathered in a write buffer of about
+   * this size, which is handed to the file stream when full, when the file
+   * is flushed or closed, or before the file is read.  A size of zero
+   * writes each record to the file stream as soon as it is complete.  The
+   * records written are the same whatever the size of the buffer.
+   *
+   * The buffered records are written when the program aborts with
+   * NS_FATAL_ERROR, and before the process forks.  Debug builds write
+   * each record through as soon as it is complete, unless the file
+   * writes in the background (see SetWriteThrough).
+   *
+   * \param size the size of the write buffer in bytes
+   */
+  void SetWriteBufferSize (uint32_t size);
+
+  /**
+   * \brief Set whether full write buffers are written in the background.
+   *
+   * With a non-zero write buffer size, full write buffers are then written
+   * to the file by a background thread shared by all the pcap files, so
+   * that the simulation does not wait for the file system.  The pending
+   * buffers of a file are always written before it is flushed, closed,
+   * read or checked for failure.
+   *
+   * \param async true to write full buffers in the background
+   */
+  void SetAsyncFlush (bool async);
+
+  /**
+   * \brief Set whether each record is written to the file as soon as it
+   * is complete.
+   *
+   * When enabled, and unless the file writes in the background, each
+   * record is handed to the file stream and flushed as soon as it is
+   * complete, whatever the size of the write buffer, so that a crash does
+   * not lose it.  Enabled by default in debug builds only.
+   *
+   * \param writeThrough true to write each record through
+   */
+  void SetWriteThrough (bool writeThrough);
+
+  /**
+   * \brief Write all the buffered records to the file.
+   *
+   * Returns once the records written so far have reached the underlying
+   * file stream.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -361,16 +417,86 @@ private:
    */
   uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
 
+  /**
+   * \brief Reserve room for a record in the write buffer
+   * \param size the number of bytes to reserve
+   * \returns a pointer to the reserved bytes
+   */
+  uint8_t * Reserve (uint32_t size);
+  /**
+   * \brief Complete the record being written to the write buffer
+   *
+   * Flushes the write buffer if it is full.
+   */
+  void EndRecord (void);
+  /**
+   * \brief Hand the content of the write buffer to the file stream or to
+   * the background writer
+   */
+  void FlushWriteBuffer (void);
+  /**
+   * \brief Wait until the background writer has written all the buffers
+   * of this file
+   */
+  void WaitForWrites (void) const;
+  /**
+   * \brief Write the pending buffers and the write buffer to the file
+   * stream, and flush it
+   *
+   * Called when the program aborts and before a fork.  When the program
+   * aborts, possibly from a signal handler, it must not wait for the
+   * background writer: the file is then left alone if the writer is busy
+   * with it or if its lock is held.
+   *
+   * \param wait whether to wait for the background writer
+   */
+  void Drain (bool wait);
+
+  /**
+   * \brief A stream buffer which drains a PcapFile when it is synchronized
+   *
+   * Flushing a stream built on it writes the buffered records of the file,
+   * so that FatalImpl::FlushStreams does not lose them.
+   */
+  class DrainBuffer : public std::streambuf
+  {
+  public:
+    /**
+     * Constructor
+     * \param file the file to drain
+     */
+    DrainBuffer (PcapFile *file);
+
+  private:
+    /**
+     * Drain the file.
+     * \returns 0
+     */
+    virtual int sync (void);
+
+    PcapFile *m_pcap; //!< the file to drain
+  };
+
   /**
    * \brief Read and verify a Pcap file header
    */
   void ReadAndVerifyFileHeader (void);
 
+  friend class PcapFileWriter;
+
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  DrainBuffer    m_drainBuffer; //!< drains the file when synchronized
+  std::ostream   m_drainStream; //!< stream registered with FatalImpl to drain the file
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  std::vector<uint8_t> m_writeBuffer; //!< records not yet handed to the file stream
+  uint32_t m_writeBufferSize;   //!< size of the write buffer
+  bool m_asyncFlush;            //!< write full buffers in the background
+  bool m_asyncUsed;             //!< buffers were handed to the background writer
+  bool m_writeThrough;          //!< write each record through as soon as it is complete
+  uint32_t m_pendingWrites;     //!< buffers queued to the background writer, guarded by its mutex
 };
 
 } // namespace ns3
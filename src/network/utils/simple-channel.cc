@@ -22,7 +22,9 @@
 #include "simple-net-device.h"
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/node.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -42,11 +44,20 @@ SimpleChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&SimpleChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("UnsharePackets",
+                   "Give each received packet its own buffer, metadata and tags. "
+                   "Set by ns3::MultithreadedSimulatorImpl on the channels joining "
+                   "two logical processes, whose reference counts are not shared "
+                   "between threads.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&SimpleChannel::m_unsharePackets),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 SimpleChannel::SimpleChannel ()
+  : m_unsharePackets (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -72,8 +83,48 @@ SimpleChannel::Send (Ptr<Packet> p, uint16_t protocol,
               continue;
             }
         }
+      Ptr<Packet> copy = p->Copy ();
+      if (m_unsharePackets)
+        {
+          // the receiver is run by another thread
+          copy->Unshare ();
+        }
+      Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
+                                      &SimpleNetDevice::Receive, tmp, copy, protocol, to, from);
+    }
+}
+
+void
+SimpleChannel::SendBurst (Ptr<const PacketBurst> burst, uint16_t protocol,
+                          Mac48Address to, Mac48Address from,
+                          Ptr<SimpleNetDevice> sender)
+{
+  NS_LOG_FUNCTION (this << burst << protocol << to << from << sender);
+  for (std::vector<Ptr<SimpleNetDevice> >::const_iterator i = m_devices.begin (); i != m_devices.end (); ++i)
+    {
+      Ptr<SimpleNetDevice> tmp = *i;
+      if (tmp == sender)
+        {
+          continue;
+        }
+      if (m_blackListedDevices.find (tmp) != m_blackListedDevices.end ())
+        {
+          if (find (m_blackListedDevices[tmp].begin (), m_blackListedDevices[tmp].end (), sender) !=
+              m_blackListedDevices[tmp].end () )
+            {
+              continue;
+            }
+        }
+      Ptr<PacketBurst> copy = burst->Copy ();
+      if (m_unsharePackets)
+        {
+          for (std::list<Ptr<Packet> >::const_iterator j = copy->Begin (); j != copy->End (); ++j)
+            {
+              (*j)->Unshare ();
+            }
+        }
       Simulator::ScheduleWithContext (tmp->GetNode ()->GetId (), m_delay,
-                                      &SimpleNetDevice::Receive, tmp, p->Copy (), protocol, to, from);
+                                      &SimpleNetDevice::ReceiveBurst, tmp, copy, protocol, to, from);
     }
 }
 
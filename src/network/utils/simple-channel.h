@@ -30,6 +30,7 @@ namespace ns3 {
 
 class SimpleNetDevice;
 class Packet;
+class PacketBurst;
 
 /**
  * \ingroup channel
@@ -68,6 +69,20 @@ public:
   virtual void Send (Ptr<Packet> p, uint16_t protocol, Mac48Address to, Mac48Address from,
                      Ptr<SimpleNetDevice> sender);
 
+  /**
+   * A burst of packets is sent by a net device.  A single burst receive
+   * event will be scheduled for all net device connected to the channel
+   * other than the net device who sent the packets
+   *
+   * \param burst packets to be sent
+   * \param protocol protocol number
+   * \param to address to send packets to
+   * \param from address the packets are coming from
+   * \param sender netdevice who sent the packets
+   */
+  virtual void SendBurst (Ptr<const PacketBurst> burst, uint16_t protocol, Mac48Address to, Mac48Address from,
+                          Ptr<SimpleNetDevice> sender);
+
   /**
    * Attached a net device to the channel.
    *
@@ -99,6 +114,7 @@ public:
 
 private:
   Time m_delay; //!< The assigned speed-of-light delay of the channel
+  bool m_unsharePackets; //!< Unshare the packets sent to the other devices
   std::vector<Ptr<SimpleNetDevice> > m_devices; //!< devices connected by the channel
   std::map<Ptr<SimpleNetDevice>, std::vector<Ptr<SimpleNetDevice> > > m_blackListedDevices; //!< devices blocked on a device
 };
@@ -21,6 +21,7 @@
 #include "simple-channel.h"
 #include "ns3/node.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
 #include "ns3/error-model.h"
@@ -30,6 +31,7 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/queue.h"
+#include "ns3/net-device-queue-interface.h"
 
 namespace ns3 {
 
@@ -234,7 +236,6 @@ SimpleNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol,
                           Mac48Address to, Mac48Address from)
 {
   NS_LOG_FUNCTION (this << packet << protocol << to << from);
-  NetDevice::PacketType packetType;
 
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
     {
@@ -242,32 +243,73 @@ SimpleNetDevice::Receive (Ptr<Packet> packet, uint16_t protocol,
       return;
     }
 
-  if (to == m_address)
+  NetDevice::PacketType packetType = GetPacketType (to);
+
+  if (packetType != NetDevice::PACKET_OTHERHOST)
     {
-      packetType = NetDevice::PACKET_HOST;
+      m_rxCallback (this, packet, protocol, from);
     }
-  else if (to.IsBroadcast ())
+
+  if (!m_promiscCallback.IsNull ())
     {
-      packetType = NetDevice::PACKET_BROADCAST;
+      m_promiscCallback (this, packet, protocol, from, to, packetType);
     }
-  else if (to.IsGroup ())
+}
+
+void
+SimpleNetDevice::ReceiveBurst (Ptr<PacketBurst> burst, uint16_t protocol,
+                               Mac48Address to, Mac48Address from)
+{
+  NS_LOG_FUNCTION (this << burst << protocol << to << from);
+
+  if (m_rxBurstCallback.IsNull () || !m_promiscCallback.IsNull ())
     {
-      packetType = NetDevice::PACKET_MULTICAST;
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          Receive (*i, protocol, to, from);
+        }
+      return;
     }
-  else 
+
+  if (m_receiveErrorModel)
     {
-      packetType = NetDevice::PACKET_OTHERHOST;
+      Ptr<PacketBurst> received = CreateObject<PacketBurst> ();
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          if (m_receiveErrorModel->IsCorrupt (*i))
+            {
+              m_phyRxDropTrace (*i);
+            }
+          else
+            {
+              received->AddPacket (*i);
+            }
+        }
+      burst = received;
     }
 
-  if (packetType != NetDevice::PACKET_OTHERHOST)
+  if (burst->GetNPackets () > 0 && GetPacketType (to) != NetDevice::PACKET_OTHERHOST)
     {
-      m_rxCallback (this, packet, protocol, from);
+      m_rxBurstCallback (this, burst, protocol, from);
     }
+}
 
-  if (!m_promiscCallback.IsNull ())
+NetDevice::PacketType
+SimpleNetDevice::GetPacketType (Mac48Address to) const
+{
+  if (to == m_address)
     {
-      m_promiscCallback (this, packet, protocol, from, to, packetType);
+      return NetDevice::PACKET_HOST;
+    }
+  else if (to.IsBroadcast ())
+    {
+      return NetDevice::PACKET_BROADCAST;
     }
+  else if (to.IsGroup ())
+    {
+      return NetDevice::PACKET_MULTICAST;
+    }
+  return NetDevice::PACKET_OTHERHOST;
 }
 
 void 
@@ -424,6 +466,61 @@ SimpleNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protoco
   return SendFrom (packet, m_address, dest, protocolNumber);
 }
 
+uint32_t
+SimpleNetDevice::SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  if (m_bps > DataRate (0) || !m_queue->IsEmpty () || TransmitCompleteEvent.IsRunning ())
+    {
+      return NetDevice::SendBurst (burst, dest, protocolNumber);
+    }
+
+  // The device transmits instantly and is idle: every packet goes through
+  // the queue as in SendFrom, but the whole burst leaves in one channel
+  // call, followed by a single TransmitComplete.
+  Mac48Address to = Mac48Address::ConvertFrom (dest);
+  Ptr<NetDeviceQueue> txQueue = GetBurstTxQueue ();
+  Ptr<PacketBurst> sent = CreateObject<PacketBurst> ();
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      if (txQueue != 0 && txQueue->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> p = *i;
+      if (p->GetSize () > GetMtu ())
+        {
+          continue;
+        }
+      Ptr<Packet> packet = p->Copy ();
+
+      SimpleTag tag;
+      tag.SetSrc (m_address);
+      tag.SetDst (to);
+      tag.SetProto (protocolNumber);
+
+      p->AddPacketTag (tag);
+
+      if (m_queue->Enqueue (p))
+        {
+          p = m_queue->Dequeue ();
+          p->RemovePacketTag (tag);
+          sent->AddPacket (p);
+        }
+      else
+        {
+          sent->AddPacket (packet);
+        }
+    }
+  if (sent->GetNPackets () > 0)
+    {
+      m_channel->SendBurst (sent, protocolNumber, to, m_address, this);
+      TransmitCompleteEvent = Simulator::Schedule (Time (0), &SimpleNetDevice::TransmitComplete, this);
+    }
+  return sent->GetNPackets ();
+}
+
 bool
 SimpleNetDevice::SendFrom (Ptr<Packet> p, const Address& source, const Address& dest, uint16_t protocolNumber)
 {
@@ -530,6 +627,13 @@ SimpleNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
   m_rxCallback = cb;
 }
 
+void
+SimpleNetDevice::SetReceiveBurstCallback (NetDevice::ReceiveBurstCallback cb)
+{
+  NS_LOG_FUNCTION (this << &cb);
+  m_rxBurstCallback = cb;
+}
+
 void
 SimpleNetDevice::DoDispose (void)
 {
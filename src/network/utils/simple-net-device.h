@@ -72,6 +72,19 @@ public:
    * \param from address packet was sent from
    */
   void Receive (Ptr<Packet> packet, uint16_t protocol, Mac48Address to, Mac48Address from);
+
+  /**
+   * Receive a burst of packets from a connected SimpleChannel.  The
+   * packets are forwarded together through the rx burst callback when
+   * it is set and the device is not in promiscuous mode, and one at a
+   * time as by Receive otherwise.
+   *
+   * \param burst Packets received on the channel
+   * \param protocol protocol number
+   * \param to address the packets should be sent to
+   * \param from address the packets were sent from
+   */
+  void ReceiveBurst (Ptr<PacketBurst> burst, uint16_t protocol, Mac48Address to, Mac48Address from);
   
   /**
    * Attach a channel to this net device.  This will be the 
@@ -125,10 +138,26 @@ public:
   virtual bool IsBridge (void) const;
   virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
   virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  /**
+   * Send a burst of packets.
+   *
+   * Every packet goes through the device queue as with Send.  If the
+   * device has an infinite data rate and nothing waiting to be
+   * transmitted, the packets are dequeued right away and the whole burst
+   * is handed to the channel at once, to be received as a burst by the
+   * other devices. Otherwise, the packets are sent one at a time.
+   *
+   * \param burst packets to send
+   * \param dest destination address
+   * \param protocolNumber protocol number
+   * \return the number of packets accepted by the device
+   */
+  virtual uint32_t SendBurst (Ptr<PacketBurst> burst, const Address& dest, uint16_t protocolNumber);
   virtual Ptr<Node> GetNode (void) const;
   virtual void SetNode (Ptr<Node> node);
   virtual bool NeedsArp (void) const;
   virtual void SetReceiveCallback (NetDevice::ReceiveCallback cb);
+  virtual void SetReceiveBurstCallback (NetDevice::ReceiveBurstCallback cb);
 
   virtual Address GetMulticast (Ipv6Address addr) const;
 
@@ -141,6 +170,7 @@ protected:
 private:
   Ptr<SimpleChannel> m_channel; //!< the channel the device is connected to
   NetDevice::ReceiveCallback m_rxCallback; //!< Receive callback
+  NetDevice::ReceiveBurstCallback m_rxBurstCallback; //!< Receive burst callback
   NetDevice::PromiscReceiveCallback m_promiscCallback; //!< Promiscuous receive callback
   Ptr<Node> m_node; //!< Node this netDevice is associated to
   uint16_t m_mtu;   //!< MTU
@@ -158,6 +188,12 @@ private:
    */
   TracedCallback<Ptr<const Packet> > m_phyRxDropTrace;
 
+  /**
+   * \param to destination address of a received packet
+   * \return the type of the packet for this device
+   */
+  NetDevice::PacketType GetPacketType (Mac48Address to) const;
+
   /**
    * The TransmitComplete method is used internally to finish the process
    * of sending a packet out on the channel.
@@ -21,6 +21,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -40,6 +41,14 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("UnsharePackets",
+                   "Give each received packet its own buffer, metadata and tags. "
+                   "Set by ns3::MultithreadedSimulatorImpl on the channels joining "
+                   "two logical processes, whose reference counts are not shared "
+                   "between threads.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::m_unsharePackets),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
@@ -57,7 +66,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_unsharePackets (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -97,9 +107,15 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  Ptr<Packet> copy = p->Copy ();
+  if (m_unsharePackets)
+    {
+      // the peer is run by another thread
+      copy->Unshare ();
+    }
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+                                  m_link[wire].m_dst, copy);
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
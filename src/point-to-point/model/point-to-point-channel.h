@@ -151,6 +151,7 @@ private:
 
   Time          m_delay;    //!< Propagation delay
   std::size_t        m_nDevices; //!< Devices of this channel
+  bool          m_unsharePackets; //!< Unshare the packets sent to the peer
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -18,6 +18,7 @@
 
 #include "ns3/log.h"
 #include "ns3/queue.h"
+#include "ns3/net-device-queue-interface.h"
 #include "ns3/simulator.h"
 #include "ns3/mac48-address.h"
 #include "ns3/llc-snap-header.h"
@@ -25,6 +26,7 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/packet-burst.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -556,6 +558,61 @@ PointToPointNetDevice::Send (
   return false;
 }
 
+uint32_t
+PointToPointNetDevice::SendBurst (
+  Ptr<PacketBurst> burst,
+  const Address &dest,
+  uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << burst << dest << protocolNumber);
+
+  //
+  // The link state is checked once for the whole burst.
+  //
+  if (IsLinkUp () == false)
+    {
+      for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+        {
+          m_macTxDropTrace (*i);
+        }
+      return 0;
+    }
+
+  Ptr<NetDeviceQueue> txQueue = GetBurstTxQueue ();
+  uint32_t sent = 0;
+  for (std::list<Ptr<Packet> >::const_iterator i = burst->Begin (); i != burst->End (); i++)
+    {
+      if (txQueue != 0 && txQueue->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = *i;
+      AddHeader (packet, protocolNumber);
+
+      m_macTxTrace (packet);
+
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+          continue;
+        }
+      sent++;
+
+      //
+      // The first packet starts the transmission, the others wait in the
+      // queue exactly as if they had been sent one at a time.
+      //
+      if (m_txMachineState == READY)
+        {
+          packet = m_queue->Dequeue ();
+          m_snifferTrace (packet);
+          m_promiscSnifferTrace (packet);
+          TransmitStart (packet);
+        }
+    }
+  return sent;
+}
+
 bool
 PointToPointNetDevice::SendFrom (Ptr<Packet> packet, 
                                  const Address &source, 
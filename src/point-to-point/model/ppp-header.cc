@@ -92,6 +92,18 @@ PppHeader::Deserialize (Buffer::Iterator start)
   return GetSerializedSize ();
 }
 
+Header *
+PppHeader::Clone (void) const
+{
+  return new PppHeader (*this);
+}
+
+void
+PppHeader::Assign (const Header &header)
+{
+  *this = dynamic_cast<const PppHeader &> (header);
+}
+
 void
 PppHeader::SetProtocol (uint16_t protocol)
 {
@@ -78,6 +78,8 @@ public:
   virtual void Serialize (Buffer::Iterator start) const;
   virtual uint32_t Deserialize (Buffer::Iterator start);
   virtual uint32_t GetSerializedSize (void) const;
+  virtual Header *Clone (void) const;
+  virtual void Assign (const Header &header);
 
   /**
    * \brief Set the protocol type carried by this PPP packet
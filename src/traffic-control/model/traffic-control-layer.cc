@@ -22,6 +22,7 @@
 #include "ns3/log.h"
 #include "ns3/object-map.h"
 #include "ns3/packet.h"
+#include "ns3/packet-burst.h"
 #include "ns3/socket.h"
 #include "ns3/queue-disc.h"
 #include <tuple>
@@ -331,6 +332,36 @@ TrafficControlLayer::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
                            " not found. It isn't forwarded up; it dies here.");
 }
 
+void
+TrafficControlLayer::ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst,
+                                   uint16_t protocol, const Address &from, const Address &to,
+                                   NetDevice::PacketType packetType)
+{
+  NS_LOG_FUNCTION (this << device << burst << protocol << from << to << packetType);
+
+  bool found = false;
+
+  for (ProtocolHandlerList::iterator i = m_handlers.begin ();
+       i != m_handlers.end (); i++)
+    {
+      if ((i->device == 0 || i->device == device)
+          && (i->protocol == 0 || i->protocol == protocol))
+        {
+          NS_LOG_DEBUG ("Found handler for burst " << burst << ", protocol " <<
+                        protocol << " and NetDevice " << device <<
+                        ". Send " << burst->GetNPackets () << " packets up");
+          for (std::list<Ptr<Packet> >::const_iterator j = burst->Begin (); j != burst->End (); j++)
+            {
+              i->handler (device, *j, protocol, from, to, packetType);
+            }
+          found = true;
+        }
+    }
+
+  NS_ABORT_MSG_IF (!found, "Handler for protocol " << protocol << " and device " << device <<
+                           " not found. It isn't forwarded up; it dies here.");
+}
+
 void
 TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
 {
@@ -391,4 +422,56 @@ TrafficControlLayer::Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item)
     }
 }
 
+void
+TrafficControlLayer::SendBurst (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << device << items.size ());
+
+  Ptr<NetDeviceQueueInterface> devQueueIface;
+  std::map<Ptr<NetDevice>, NetDeviceInfo>::iterator ndi = m_netDevices.find (device);
+
+  if (ndi != m_netDevices.end ())
+    {
+      if (ndi->second.m_rootQueueDisc != 0
+          || (ndi->second.m_ndqi && ndi->second.m_ndqi->GetNTxQueues () > 1))
+        {
+          for (std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin (); i != items.end (); i++)
+            {
+              Send (device, *i);
+            }
+          return;
+        }
+      devQueueIface = ndi->second.m_ndqi;
+    }
+
+  // The device has no attached queue disc and a single transmission queue:
+  // add the headers to the packets and send them directly to the device
+  // while its queue is not stopped.  The device ends a burst at the first
+  // packet which finds the queue stopped, so that the remaining packets
+  // are dropped here, as by Send.
+  std::vector<Ptr<QueueDiscItem> >::const_iterator i = items.begin ();
+  while (i != items.end ())
+    {
+      if (devQueueIface && devQueueIface->GetTxQueue (0)->IsStopped ())
+        {
+          return;
+        }
+      Address address = (*i)->GetAddress ();
+      uint16_t protocol = (*i)->GetProtocol ();
+      Ptr<PacketBurst> burst = CreateObject<PacketBurst> ();
+      for (; i != items.end () && (*i)->GetAddress () == address
+             && (*i)->GetProtocol () == protocol; i++)
+        {
+          (*i)->AddHeader ();
+          // a single queue device makes no use of the priority tag
+          SocketPriorityTag priorityTag;
+          (*i)->GetPacket ()->RemovePacketTag (priorityTag);
+          burst->AddPacket ((*i)->GetPacket ());
+        }
+      NS_LOG_DEBUG ("Send burst of " << burst->GetNPackets () << " packets to device " <<
+                    device << " protocol number " << protocol);
+      device->SendBurst (burst, address, protocol);
+    }
+}
+
 } // namespace ns3
@@ -65,8 +65,10 @@ class NetDeviceQueueInterface;
   NS_ASSERT (tc != 0);
 
   m_node->RegisterProtocolHandler (MakeCallback (&TrafficControlLayer::Receive, tc),
+                                   MakeCallback (&TrafficControlLayer::ReceiveBurst, tc),
                                    Ipv4L3Protocol::PROT_NUMBER, device);
   m_node->RegisterProtocolHandler (MakeCallback (&TrafficControlLayer::Receive, tc),
+                                   MakeCallback (&TrafficControlLayer::ReceiveBurst, tc),
                                    ArpL3Protocol::PROT_NUMBER, device);
 
   tc->RegisterProtocolHandler (MakeCallback (&Ipv4L3Protocol::Receive, this),
@@ -80,7 +82,9 @@ class NetDeviceQueueInterface;
  *
  * When the node receives an IPv4 or ARP packet, it calls the Receive method
  * on TrafficControlLayer, that calls the right upper-layer callback once it
- * finishes the operations on the packet received.
+ * finishes the operations on the packet received. Bursts of packets received
+ * by devices which support NetDevice::SetReceiveBurstCallback are handed to
+ * ReceiveBurst, which looks up the upper-layer callback once per burst.
  *
  * Discrimination through callbacks (in other words: what is the right upper-layer
  * callback for this packet?) is done through checks over the device and the
@@ -187,6 +191,23 @@ public:
   virtual void Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
                         uint16_t protocol, const Address &from,
                         const Address &to, NetDevice::PacketType packetType);
+
+  /**
+   * \brief Called by NetDevices, incoming burst of packets
+   *
+   * The protocol handlers are looked up once for the whole burst and
+   * each of them is then handed the packets in order.
+   *
+   * \param device network device
+   * \param burst the packets
+   * \param protocol next header value
+   * \param from address of the correspondent
+   * \param to address of the destination
+   * \param packetType type of the packets
+   */
+  virtual void ReceiveBurst (Ptr<NetDevice> device, Ptr<const PacketBurst> burst,
+                             uint16_t protocol, const Address &from,
+                             const Address &to, NetDevice::PacketType packetType);
   /**
    * \brief Called from upper layer to queue a packet for the transmission.
    *
@@ -194,6 +215,20 @@ public:
    * \param item a queue item including a packet and additional information
    */
   virtual void Send (Ptr<NetDevice> device, Ptr<QueueDiscItem> item);
+  /**
+   * \brief Called from upper layer to queue several packets for the transmission.
+   *
+   * If the device has a queue disc, or several transmission queues, the
+   * items are sent one at a time as with Send.  Otherwise, each run of
+   * consecutive items with the same destination address and protocol is
+   * handed to the device through NetDevice::SendBurst, which ends the
+   * burst when the device queue stops; the items left when the queue is
+   * stopped are dropped, as by Send.
+   *
+   * \param device the device the packets must be sent to
+   * \param items the queue items, in order of transmission
+   */
+  virtual void SendBurst (Ptr<NetDevice> device, const std::vector<Ptr<QueueDiscItem> > &items);
 
 protected:
 
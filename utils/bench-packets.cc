@@ -21,6 +21,10 @@
 // This program can be used to benchmark packet serialization/deserialization
 // operations using Headers and Tags, for various numbers of packets 'n'
 // Sample usage:  ./waf --run 'bench-packets --n=10000'
+//
+// The per-header cost of packet metadata can be measured by comparing a
+// run with --enable-printing, a run without it, and a run of a build
+// configured with --disable-packet-metadata.
 
 #include "ns3/command-line.h"
 #include "ns3/system-wall-clock-ms.h"
@@ -328,6 +332,27 @@ benchByteTags (uint32_t n)
     }
 }
 
+/// Number of headers added and removed per packet by benchHeaders
+static const uint32_t BENCH_HEADERS = 8;
+
+static void
+benchHeaders (uint32_t n)
+{
+  BenchHeader<4> header;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (100);
+    for (uint32_t j = 0; j < BENCH_HEADERS; j++)
+      {
+        p->AddHeader (header);
+      }
+    for (uint32_t j = 0; j < BENCH_HEADERS; j++)
+      {
+        p->RemoveHeader (header);
+      }
+  }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -340,7 +365,8 @@ runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 
 
 static void
-runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
+runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name,
+          uint32_t headersPerPacket = 0)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
   for (uint32_t i = 0; i < minIterations; i++)
@@ -355,6 +381,15 @@ runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char con
             << " (" << minDelay << " ms elapsed)\t"
             << name
             << std::endl;
+  if (headersPerPacket != 0 && minDelay != 0)
+    {
+      // each header is added once and removed once
+      double ns = minDelay;
+      ns *= 1000000;
+      ns /= n;
+      ns /= 2 * headersPerPacket;
+      std::cout << ns << " ns per header operation" << std::endl;
+    }
 }
 
 int main (int argc, char *argv[])
@@ -376,7 +411,16 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (enablePrinting)
+    {
+      Packet::EnablePrinting ();
+    }
+
   std::cout << "Running bench-packets with n=" << n << std::endl;
+  std::cout << "Packet metadata is "
+            << (!PacketMetadata::IsAvailable () ? "compiled out" :
+                enablePrinting ? "enabled" : "disabled")
+            << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
   runBench (&benchA, n, minIterations, "Copy packet, remove headers");
@@ -385,6 +429,7 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchHeaders, n, minIterations, "Add and remove small headers", BENCH_HEADERS);
 
   return 0;
 }